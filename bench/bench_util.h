@@ -0,0 +1,58 @@
+/**
+ * @file bench_util.h
+ * @brief 基准测试公用的计时和分配计数工具
+ */
+#ifndef ROBOT_BENCH_UTIL_H
+#define ROBOT_BENCH_UTIL_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace bench {
+
+/**
+ * @brief 进程启动以来operator new的调用次数（bench_alloc.cpp替换了全局operator new）
+ */
+size_t AllocCount();
+
+/**
+ * @brief 单项测量结果
+ */
+struct Result
+{
+    double us_per_op     = 0.0;    // 每次操作耗时，微秒
+    double allocs_per_op = 0.0;    // 每次操作的operator new次数
+};
+
+/**
+ * @brief 先预热再重复执行fn，返回平均耗时和分配次数
+ */
+template <typename Fn>
+Result Measure(int iterations, Fn fn)
+{
+    for (int i = 0; i < iterations / 10 + 1; i++)
+    {
+        fn();
+    }
+    size_t allocs = AllocCount();
+    auto start    = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    Result result;
+    result.us_per_op     = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+    result.allocs_per_op = (double)(AllocCount() - allocs) / iterations;
+    return result;
+}
+
+/**
+ * @brief 读取整个文件，失败返回false
+ */
+bool ReadFile(const std::string &path, std::string &content);
+
+}    // namespace bench
+
+#endif    // ROBOT_BENCH_UTIL_H
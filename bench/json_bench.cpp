@@ -0,0 +1,179 @@
+/**
+ * @file json_bench.cpp
+ * @brief JsonDocument/JsonWriter与cJSON、jsoncpp、nlohmann::json的解析、序列化对比
+ * @details 语料为corpus/json下抓取的AIUI/AVVTN消息，每个文件一个JSON。
+ *          输出每种库每条消息的平均耗时和operator new次数（cJSON的malloc钩子也计入），
+ *          并检查JsonWriter的输出与原文在nlohmann::json下语义相同。
+ *          用法：json_bench [语料目录] [迭代次数]
+ */
+#include "bench_util.h"
+#include "cjson/cJSON.h"
+#include "json/json.h"
+#include "nlohmann/json.hpp"
+#include "utils/JsonDocument.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef BENCH_CORPUS_DIR
+#define BENCH_CORPUS_DIR "corpus"
+#endif
+
+namespace {
+
+struct Sample
+{
+    std::string name;
+    std::string text;
+};
+
+void *CountedMalloc(size_t size)
+{
+    return ::operator new(size);
+}
+
+void CountedFree(void *p)
+{
+    ::operator delete(p);
+}
+
+std::vector<Sample> LoadCorpus(const std::string &dir)
+{
+    std::vector<Sample> samples;
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr)
+    {
+        return samples;
+    }
+    while (struct dirent *entry = readdir(d))
+    {
+        std::string name = entry->d_name;
+        if (name.size() < 5 || name.compare(name.size() - 5, 5, ".json") != 0)
+        {
+            continue;
+        }
+        Sample sample;
+        sample.name = name;
+        if (bench::ReadFile(dir + "/" + name, sample.text))
+        {
+            samples.push_back(sample);
+        }
+    }
+    closedir(d);
+    std::sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b) { return a.name < b.name; });
+    return samples;
+}
+
+void WriteNode(const JsonNode &node, JsonWriter &writer)
+{
+    switch (node.type())
+    {
+        case JsonNode::TYPE_NULL: writer.Null(); break;
+        case JsonNode::TYPE_BOOL: writer.Bool(node.asBool()); break;
+        case JsonNode::TYPE_NUMBER:
+            if (node.isInteger())
+            {
+                writer.Int(node.asInt64());
+            }
+            else
+            {
+                writer.Double(node.asDouble());
+            }
+            break;
+        case JsonNode::TYPE_STRING: writer.String(node.c_str(), node.length()); break;
+        case JsonNode::TYPE_ARRAY:
+            writer.StartArray();
+            for (const JsonNode &item : node)
+            {
+                WriteNode(item, writer);
+            }
+            writer.EndArray();
+            break;
+        case JsonNode::TYPE_OBJECT:
+            writer.StartObject();
+            for (const JsonNode &item : node)
+            {
+                writer.Key(item.key(), item.keyLength());
+                WriteNode(item, writer);
+            }
+            writer.EndObject();
+            break;
+    }
+}
+
+void Print(const char *op, const char *lib, const bench::Result &result)
+{
+    printf("  %-10s %-12s %8.3f us  %6.1f allocs\n", op, lib, result.us_per_op, result.allocs_per_op);
+}
+
+}    // namespace
+
+int main(int argc, char **argv)
+{
+    std::string dir = argc > 1 ? argv[1] : BENCH_CORPUS_DIR;
+    int iterations  = argc > 2 ? atoi(argv[2]) : 20000;
+
+    cJSON_Hooks hooks = { CountedMalloc, CountedFree };
+    cJSON_InitHooks(&hooks);
+
+    std::vector<Sample> samples = LoadCorpus(dir);
+    if (samples.empty())
+    {
+        fprintf(stderr, "no *.json in %s\n", dir.c_str());
+        return 1;
+    }
+
+    int mismatches = 0;
+    for (const Sample &sample : samples)
+    {
+        const char *text = sample.text.c_str();
+        size_t len       = sample.text.size();
+        printf("%s (%zu bytes)\n", sample.name.c_str(), len);
+
+        // 先确认四个库都能解析，且JsonWriter的输出与原文语义一致
+        JsonDocument doc;
+        cJSON *cj = cJSON_ParseWithLength(text, len);
+        aiui_va::Json::Value jv;
+        nlohmann::json nj = nlohmann::json::parse(text, text + len, nullptr, false);
+        if (!doc.Parse(text, len) || cj == nullptr || !aiui_va::Json::Reader().parse(text, text + len, jv, false) ||
+            nj.is_discarded())
+        {
+            printf("  parse failed\n");
+            cJSON_Delete(cj);
+            mismatches++;
+            continue;
+        }
+        std::string out;
+        JsonWriter writer(out);
+        WriteNode(doc.Root(), writer);
+        if (nlohmann::json::parse(out, nullptr, false) != nj)
+        {
+            printf("  JsonWriter output differs: %s\n", out.c_str());
+            mismatches++;
+        }
+
+        Print("parse", "cJSON", bench::Measure(iterations, [&]() { cJSON_Delete(cJSON_ParseWithLength(text, len)); }));
+        Print("parse", "jsoncpp", bench::Measure(iterations, [&]() {
+                  aiui_va::Json::Value value;
+                  aiui_va::Json::Reader().parse(text, text + len, value, false);
+              }));
+        Print("parse", "nlohmann", bench::Measure(iterations, [&]() { nj = nlohmann::json::parse(text, text + len); }));
+        Print("parse", "JsonDocument", bench::Measure(iterations, [&]() { doc.Parse(text, len); }));
+
+        Print("serialize", "cJSON", bench::Measure(iterations, [&]() { cJSON_free(cJSON_PrintUnformatted(cj)); }));
+        Print("serialize", "jsoncpp", bench::Measure(iterations, [&]() { aiui_va::Json::FastWriter().write(jv); }));
+        Print("serialize", "nlohmann", bench::Measure(iterations, [&]() { nj.dump(); }));
+        Print("serialize", "JsonWriter", bench::Measure(iterations, [&]() {
+                  out.clear();
+                  JsonWriter w(out);
+                  WriteNode(doc.Root(), w);
+              }));
+        cJSON_Delete(cj);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file log_async_bench.cpp
+ * @brief 异步日志吞吐：8个线程同时写，两个计数输出目标，依次测block、drop、drop_low三种溢出策略
+ * @details 每个线程写N条INFO，每100条夹一条900字节的WARN。记录生产线程写完的耗时、
+ *          全部写出的耗时、单次调用的最长耗时，以及队列统计的增量。
+ *          输出目标收到的条数与写出统计不符，或block策略下有丢弃，返回非0。
+ *          用法：log_async_bench [每线程条数]
+ */
+#include "utils/Logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int kProducers = 8;
+
+std::atomic<uint64_t> g_lines{0};
+
+/**
+ * @brief 只计数本程序写的日志，队列丢弃提示等不算在内
+ */
+class CountingSink : public Logger::LogSink
+{
+public:
+    void Write(const Logger::LogEntry &entry, const std::string &formatted) override
+    {
+        (void)formatted;
+        if (entry.message.compare(0, 7, "thread ") == 0)
+        {
+            g_lines.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void Flush() override {}
+};
+
+/**
+ * @brief 按policy跑一轮，返回是否通过检查
+ */
+bool RunPolicy(const char *policy, int lines_per_thread)
+{
+    Logger::Logger &logger = Logger::Logger::GetInstance();
+    logger.SetOverflowPolicy(Logger::OverflowPolicyFromString(policy, Logger::OverflowPolicy::BLOCK));
+    logger.Flush();
+    Logger::AsyncWriter::Stats before = logger.GetAsyncStats();
+    g_lines.store(0);
+
+    const std::string long_text(900, 'x');
+    std::vector<double> worst_us(kProducers);
+    std::vector<std::thread> producers;
+    auto start = Clock::now();
+    for (int t = 0; t < kProducers; t++)
+    {
+        producers.emplace_back([&, t]() {
+            double worst = 0.0;
+            for (int k = 0; k < lines_per_thread; k++)
+            {
+                auto call = Clock::now();
+                if (k % 100 == 99)
+                {
+                    LOG_WARN("thread %d long %s", t, long_text.c_str());
+                }
+                else
+                {
+                    LOG_INFO("thread %d line %d 识别结果 rms %.2f", t, k, k * 0.5);
+                }
+                worst = std::max(worst, std::chrono::duration<double, std::micro>(Clock::now() - call).count());
+            }
+            worst_us[t] = worst;
+        });
+    }
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    double produce_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // 等队列写空：写出加丢弃等于写入的条数
+    const uint64_t total = (uint64_t)kProducers * lines_per_thread;
+    Logger::AsyncWriter::Stats after;
+    do
+    {
+        logger.Flush();
+        after = logger.GetAsyncStats();
+    } while (after.written - before.written + after.dropped - before.dropped < total &&
+             Clock::now() - start < std::chrono::seconds(60));
+    double total_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    uint64_t written = after.written - before.written;
+    uint64_t dropped = after.dropped - before.dropped;
+    uint64_t received = g_lines.load() / 2;
+    printf("%-8s 生产 %7.0f ms  写完 %7.0f ms  %9.0f 条/s  单次最长 %7.0f us  "
+           "写出 %llu 丢弃 %llu 等待 %llu 批 %llu\n",
+           policy, produce_ms, total_ms, total / total_ms * 1000.0, *std::max_element(worst_us.begin(), worst_us.end()),
+           (unsigned long long)written, (unsigned long long)dropped, (unsigned long long)(after.blocked - before.blocked),
+           (unsigned long long)(after.batches - before.batches));
+
+    bool ok = true;
+    if (written + dropped != total || received != written)
+    {
+        fprintf(stderr, "%s: 写入 %llu 写出 %llu 丢弃 %llu 输出目标收到 %llu\n", policy, (unsigned long long)total,
+                (unsigned long long)written, (unsigned long long)dropped, (unsigned long long)received);
+        ok = false;
+    }
+    if (strcmp(policy, "block") == 0 && dropped != 0)
+    {
+        fprintf(stderr, "block策略下丢弃了 %llu 条\n", (unsigned long long)dropped);
+        ok = false;
+    }
+    return ok;
+}
+
+}    // namespace
+
+int main(int argc, char **argv)
+{
+    int lines_per_thread = argc > 1 ? atoi(argv[1]) : 50000;
+
+    Logger::Logger &logger = Logger::Logger::GetInstance();
+    logger.SetLevel(Logger::LogLevel::LOG_INFO);
+    logger.SetAsyncMode(true);
+    logger.AddSink(std::unique_ptr<Logger::LogSink>(new CountingSink));
+    logger.AddSink(std::unique_ptr<Logger::LogSink>(new CountingSink));
+
+    printf("%d个线程，每线程 %d 条\n", kProducers, lines_per_thread);
+    bool ok = true;
+    for (const char *policy : { "block", "drop", "drop_low" })
+    {
+        ok = RunPolicy(policy, lines_per_thread) && ok;
+    }
+    logger.SetAsyncMode(false);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file log_disabled_bench.cpp
+ * @brief 被过滤的LOG_DEBUG调用开销：单线程和4线程，运行期级别为INFO
+ * @details 对照项format+Log按原宏的写法先调用fmt::format再交给Logger::Log过滤，
+ *          不含原GetInstance()的互斥锁，实际的旧开销比它更高。
+ *          同一源文件另编译为log_disabled_bench_stripped（LOG_MIN_LEVEL=2），
+ *          看编译期去掉DEBUG后的开销。被过滤的调用若求值了参数则返回非0。
+ *          用法：log_disabled_bench [迭代次数]
+ */
+#include "bench_util.h"
+#include "utils/Logger.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int kThreads = 4;
+
+int g_evaluated = 0;
+
+int Evaluated(int value)
+{
+    g_evaluated++;
+    return value;
+}
+
+/**
+ * @brief kThreads个线程各执行iterations次fn，返回每次调用的平均纳秒数
+ */
+template <typename Fn>
+double ThreadedNanos(int iterations, Fn fn)
+{
+    std::vector<double> nanos(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&, t]() {
+            auto start = Clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                fn(i);
+            }
+            nanos[t] = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+        });
+    }
+    double total = 0.0;
+    for (int t = 0; t < kThreads; t++)
+    {
+        threads[t].join();
+        total += nanos[t];
+    }
+    return total / kThreads;
+}
+
+}    // namespace
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 5000000;
+    Logger::Logger::GetInstance().SetLevel(Logger::LogLevel::LOG_INFO);
+
+    const std::string name = "robot_avvtn";
+    int frame = 0;
+    auto macro = [&](int i) { LOG_DEBUG("frame %d from %s, rms %.2f", i, name.c_str(), i * 0.5); };
+    auto eager = [&](int i) {
+        Logger::Logger::GetInstance().Log(Logger::LogLevel::LOG_DEBUG,
+                                          Logger::fmt::format("frame %d from %s, rms %.2f", i, name.c_str(), i * 0.5),
+                                          __FILE__, __LINE__);
+    };
+
+    bench::Result macro_one = bench::Measure(iterations, [&]() { macro(frame++); });
+    bench::Result eager_one = bench::Measure(iterations / 10, [&]() { eager(frame++); });
+    double macro_threads = ThreadedNanos(iterations / kThreads, macro);
+    double eager_threads = ThreadedNanos(iterations / 10 / kThreads, eager);
+
+    LOG_DEBUG("evaluated %d", Evaluated(frame));
+
+    printf("LOG_MIN_LEVEL=%d, 运行期级别INFO，每次调用耗时\n", LOG_MIN_LEVEL);
+    printf("%-10s 1线程 %8.1f ns %5.1f allocs   %d线程 %8.1f ns\n", "LOG_DEBUG", macro_one.us_per_op * 1000.0,
+           macro_one.allocs_per_op, kThreads, macro_threads);
+    printf("%-10s 1线程 %8.1f ns %5.1f allocs   %d线程 %8.1f ns\n", "format+Log", eager_one.us_per_op * 1000.0,
+           eager_one.allocs_per_op, kThreads, eager_threads);
+    if (g_evaluated != 0)
+    {
+        fprintf(stderr, "被过滤的日志求值了参数\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file log_format_bench.cpp
+ * @brief 日志格式化：DefaultFormatter的Format()/FormatTo()对比stringstream旧实现（reference/）
+ * @details 先在若干时间戳、行号组合上比较新旧格式化结果逐字节一致，旧实现拿完整路径，
+ *          新实现拿日志宏传入的Basename(__FILE__)。再按时间戳每条前进50us（约2万条跨一秒）
+ *          测每条的耗时和分配次数。结果不一致返回非0。
+ *          用法：log_format_bench [条数]
+ */
+#include "bench_util.h"
+#include "reference/OldLogFormatter.h"
+#include "utils/Logger.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+const char *kPath    = "/home/cat/robot_avvtn/src/avvtn_capture/aiui_handle.cpp";
+const char *kMessage = "大模型返回nlp语义结果: seq = 3, status = 1, answer（应答语）: 好的";
+
+/**
+ * @brief 跨秒、跨年和无文件名等组合上比较新旧输出，返回不一致的条数
+ */
+int CheckSameText()
+{
+    Logger::OldDefaultFormatter old_formatter;
+    Logger::DefaultFormatter formatter;
+    int mismatched = 0;
+    for (long long ms : { 1760846462001LL, 1760846462999LL, 1760846463050LL, 1767225599999LL })
+    {
+        for (int line : { 0, 7, 589, -3 })
+        {
+            Logger::LogEntry old_entry(Logger::LogLevel::LOG_WARN, kMessage, line == 0 ? "" : kPath, line);
+            Logger::LogEntry entry(Logger::LogLevel::LOG_WARN, kMessage, line == 0 ? "" : Logger::Basename(kPath), line);
+            old_entry.timestamp = entry.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+
+            std::string expected = old_formatter.Format(old_entry);
+            std::string actual   = formatter.Format(entry);
+            char buffer[1024];
+            size_t length = formatter.FormatTo(entry, buffer, sizeof(buffer));
+            if (actual != expected || std::string(buffer, length) != expected)
+            {
+                fprintf(stderr, "MISMATCH\n  old: %s\n  new: %s\n", expected.c_str(), actual.c_str());
+                mismatched++;
+            }
+        }
+    }
+    return mismatched;
+}
+
+void Print(const char *name, const bench::Result &result)
+{
+    printf("%-16s %8.0f ns/条  %5.2f allocs/条\n", name, result.us_per_op * 1000.0, result.allocs_per_op);
+}
+
+}    // namespace
+
+int main(int argc, char **argv)
+{
+    int entries    = argc > 1 ? atoi(argv[1]) : 1000000;
+    int mismatched = CheckSameText();
+
+    Logger::OldDefaultFormatter old_formatter;
+    Logger::DefaultFormatter formatter;
+    Logger::LogEntry old_entry(Logger::LogLevel::LOG_INFO, kMessage, kPath, 589);
+    Logger::LogEntry entry(Logger::LogLevel::LOG_INFO, kMessage, Logger::Basename(kPath), 589);
+    const auto start = entry.timestamp;
+    printf("%s\n", formatter.Format(entry).c_str());
+
+    // 时间戳每条前进50us
+    long long step = 0;
+    size_t total   = 0;
+    char buffer[4096];
+    Print("旧 Format()", bench::Measure(entries / 10, [&]() {
+              old_entry.timestamp = start + std::chrono::microseconds(50 * step++);
+              total += old_formatter.Format(old_entry).size();
+          }));
+    step = 0;
+    Print("新 Format()", bench::Measure(entries, [&]() {
+              entry.timestamp = start + std::chrono::microseconds(50 * step++);
+              total += formatter.Format(entry).size();
+          }));
+    step = 0;
+    Print("新 FormatTo()", bench::Measure(entries, [&]() {
+              entry.timestamp = start + std::chrono::microseconds(50 * step++);
+              total += formatter.FormatTo(entry, buffer, sizeof(buffer));
+          }));
+
+    printf("新旧输出一致性：%d 处不一致\n", mismatched);
+    return mismatched == 0 && total != 0 ? 0 : 1;
+}
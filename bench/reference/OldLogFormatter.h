@@ -0,0 +1,47 @@
+//
+// 基准对照用：src/utils/Logger.hpp 中DefaultFormatter改为直接写缓冲之前基于stringstream的实现，只改了类名
+//
+
+#ifndef ROBOT_BENCH_OLD_LOG_FORMATTER_H
+#define ROBOT_BENCH_OLD_LOG_FORMATTER_H
+
+#include "utils/Logger.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace Logger {
+
+// 默认日志格式化器
+class OldDefaultFormatter : public LogFormatter {
+public:
+    std::string Format(const LogEntry& entry) override {
+        auto time = std::chrono::system_clock::to_time_t(entry.timestamp);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            entry.timestamp.time_since_epoch()).count() % 1000;
+        
+        std::stringstream ss;
+        ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S")
+           << "." << std::setfill('0') << std::setw(3) << ms
+           << " [" << LevelToString(entry.level) << "]"
+           << " [thread:" << entry.threadId << "]";
+        
+        if (!entry.file.empty()) {
+            // 提取文件名（不含路径）
+            size_t pos = entry.file.find_last_of("/\\");
+            std::string filename = (pos != std::string::npos) ? 
+                                  entry.file.substr(pos + 1) : entry.file;
+            ss << " [" << filename << ":" << entry.line << "]";
+        }
+        
+        ss << " " << entry.message;
+        return ss.str();
+    }
+};
+
+} // namespace Logger
+
+#endif // ROBOT_BENCH_OLD_LOG_FORMATTER_H
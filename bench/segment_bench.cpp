@@ -0,0 +1,213 @@
+/**
+ * @file segment_bench.cpp
+ * @brief 流式NLP文本分句：当前StreamNlpTtsHelper与wregex旧实现的一致性和耗时对比
+ * @details 语料每行一条回答，按随机长度切成流式片段后分别喂给新旧实现，
+ *          覆盖不同的最小合成长度、结尾空片段和相邻片段乱序，比较输出的分句序列；
+ *          再把语料拼成长回答，测量两者处理一条回答的耗时。
+ *          用法：segment_bench [语料文件]
+ */
+#include "reference/OldStreamNlpTtsHelper.h"
+#include "utils/StreamNlpTtsHelper.h"
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef BENCH_CORPUS_FILE
+#define BENCH_CORPUS_FILE "nlp_answers.txt"
+#endif
+
+const std::wstring OldStreamNlpTtsHelper::REGEX_SENTENCE_DIVIDER = L"[,.;，。；]";
+
+namespace {
+
+/**
+ * @brief 记录分句输出，并对每个分句立即回一帧合成结果以推动后续分句
+ */
+template <typename Helper>
+class Recorder : public Helper::Listener
+{
+public:
+    void onText(const typename Helper::OutTextSeg &seg) override
+    {
+        out.push_back(std::to_string(seg.mIndex) + "|" + seg.mText + "|" + std::to_string(seg.mStatus) + "|" +
+                      std::to_string(seg.mOffset));
+        pending.push_back(seg.mTag);
+    }
+
+    void onTtsData(const Json::Value &bizParamJson, const char *, int) override
+    {
+        const Json::Value &content = bizParamJson["data"][0]["content"][0];
+        out.push_back("tts|" + std::to_string(content["dts"].asInt()) + "|" +
+                      std::to_string(content["text_start"].asInt()));
+    }
+
+    void onFinish(const std::string &fullText) override { out.push_back("finish|" + fullText); }
+
+    std::vector<std::string> out;
+    std::deque<std::string> pending;
+};
+
+std::vector<std::string> SplitCodepoints(const std::string &text)
+{
+    std::vector<std::string> chars;
+    for (size_t i = 0; i < text.size();)
+    {
+        unsigned char c = text[i];
+        size_t len      = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : 4;
+        chars.push_back(text.substr(i, len));
+        i += len;
+    }
+    return chars;
+}
+
+template <typename Helper>
+std::vector<std::string> Run(const std::vector<std::string> &chunks, int limit, bool shuffle, unsigned seed)
+{
+    auto recorder = std::make_shared<Recorder<Helper>>();
+    Helper helper(recorder);
+    helper.setTextMinLimit(limit);
+
+    std::vector<int> order(chunks.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = (int)i;
+    }
+    if (shuffle)
+    {
+        std::mt19937 rng(seed);
+        for (size_t i = 0; i + 1 < order.size(); i++)
+        {
+            if (rng() % 3 == 0)
+            {
+                std::swap(order[i], order[i + 1]);
+            }
+        }
+    }
+
+    Json::Value frame;
+    Json::Value &content    = frame["data"][0]["content"][0];
+    content["dts"]          = 2;
+    content["text_start"]   = 0;
+    content["text_end"]     = 1;
+    content["text_percent"] = 100;
+    for (int index : order)
+    {
+        int status = index == (int)chunks.size() - 1 ? Helper::STATUS_END
+                     : index == 0                    ? Helper::STATUS_BEGIN
+                                                     : Helper::STATUS_CONTINUE;
+        helper.addText(chunks[index], index, status);
+        while (!recorder->pending.empty())
+        {
+            std::string tag = recorder->pending.front();
+            recorder->pending.pop_front();
+            Json::Value copy = frame;
+            helper.onOriginTtsData(tag, copy, "", 0);
+        }
+    }
+    return recorder->out;
+}
+
+template <typename Helper>
+double MillisPerAnswer(const std::vector<std::string> &chunks, int limit, int rounds)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+    {
+        Run<Helper>(chunks, limit, false, 0);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / rounds;
+}
+
+}    // namespace
+
+int main(int argc, char **argv)
+{
+    std::ifstream in(argc > 1 ? argv[1] : BENCH_CORPUS_FILE);
+    std::vector<std::string> corpus;
+    for (std::string line; std::getline(in, line);)
+    {
+        if (!line.empty())
+        {
+            corpus.push_back(line);
+        }
+    }
+    if (corpus.empty())
+    {
+        fprintf(stderr, "empty corpus\n");
+        return 1;
+    }
+
+    // 一致性：随机切片、不同最小合成长度、部分带结尾空片段、部分相邻片段乱序
+    int total = 0;
+    int mismatched = 0;
+    std::mt19937 rng(42);
+    for (const std::string &text : corpus)
+    {
+        std::vector<std::string> chars = SplitCodepoints(text);
+        for (int limit : { 1, 3, 5, 10, 20, 50, 100 })
+        {
+            for (int rep = 0; rep < 30; rep++)
+            {
+                std::vector<std::string> chunks;
+                for (size_t i = 0; i < chars.size();)
+                {
+                    std::string chunk;
+                    for (size_t n = 1 + rng() % 8; n > 0 && i < chars.size(); n--, i++)
+                    {
+                        chunk += chars[i];
+                    }
+                    chunks.push_back(chunk);
+                }
+                if (rep % 5 == 0)
+                {
+                    chunks.push_back("");
+                }
+                bool shuffle = rep % 3 == 1;
+                std::vector<std::string> expected = Run<OldStreamNlpTtsHelper>(chunks, limit, shuffle, rep);
+                std::vector<std::string> actual   = Run<StreamNlpTtsHelper>(chunks, limit, shuffle, rep);
+                total++;
+                if (expected != actual)
+                {
+                    if (++mismatched <= 3)
+                    {
+                        printf("MISMATCH limit=%d text=%s\n", limit, text.c_str());
+                        for (size_t k = 0; k < std::max(expected.size(), actual.size()); k++)
+                        {
+                            printf("  %s   ||   %s\n", k < expected.size() ? expected[k].c_str() : "-",
+                                   k < actual.size() ? actual[k].c_str() : "-");
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("%d/%d cases mismatched\n", mismatched, total);
+
+    // 耗时：语料拼成长回答，每次两个字符流式送入
+    std::string answer;
+    for (int i = 0; i < 60; i++)
+    {
+        answer += corpus[i % corpus.size()];
+    }
+    std::vector<std::string> chars = SplitCodepoints(answer);
+    std::vector<std::string> chunks;
+    for (size_t i = 0; i < chars.size(); i += 2)
+    {
+        chunks.push_back(chars[i] + (i + 1 < chars.size() ? chars[i + 1] : ""));
+    }
+    printf("long answer: %zu chars, %zu chunks\n", chars.size(), chunks.size());
+    for (int limit : { 20, 100 })
+    {
+        double old_ms = MillisPerAnswer<OldStreamNlpTtsHelper>(chunks, limit, 20);
+        double new_ms = MillisPerAnswer<StreamNlpTtsHelper>(chunks, limit, 20);
+        printf("limit %3d: wregex %.2f ms, current %.2f ms per answer (%.1fx)\n", limit, old_ms, new_ms,
+               old_ms / new_ms);
+    }
+    return mismatched == 0 ? 0 : 1;
+}
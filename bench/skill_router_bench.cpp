@@ -0,0 +1,198 @@
+/**
+ * @file skill_router_bench.cpp
+ * @brief 技能结果分发：SkillRouter路由表与原handleSkill中if/else链的耗时对比
+ * @details 两边都在已解析好的JsonDocument上运行，只比较路由匹配和取字段，
+ *          旧写法按原代码逐个比较type字符串、用operator[]逐级取值。
+ *          同时检查两边提取出的运动指令参数一致。
+ *          用法：skill_router_bench [迭代次数]
+ */
+#include "avvtn_capture/skill_router.h"
+#include "utils/JsonDocument.h"
+#include "utils/Logger.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Extracted
+{
+    bool motion = false;
+    std::string intent_name;
+    std::string id;
+    std::string distance;
+    std::string unit;
+    size_t touched = 0;    // 防止被优化掉
+};
+
+std::string Slot(const JsonNode &result, const char *name)
+{
+    const JsonNode &value = result["slots"][name]["normValue"];
+    return value.isString() ? value.asString() : std::string();
+}
+
+/**
+ * @brief 原handleSkill的分支逻辑
+ */
+void OldRoute(const JsonNode &text_root, Extracted &out)
+{
+    if (text_root["category"].isString() && text_root["category"].equals("IFLYTEK.datetimePro"))
+    {
+        return;
+    }
+    const JsonNode &result = text_root["data"]["result"][0];
+    if (!result["type"].isString())
+    {
+        return;
+    }
+    const JsonNode &type = result["type"];
+    auto intent = [&]() {
+        if (!result["intentName"].isString() || !result["id"].isInteger())
+        {
+            return false;
+        }
+        out.motion      = true;
+        out.intent_name = result["intentName"].asString();
+        out.id          = std::to_string(result["id"].asInt());
+        return true;
+    };
+    if (type.equals("face_rec_start"))
+    {
+        out.touched++;
+    }
+    else if (type.equals("move"))
+    {
+        if (intent())
+        {
+            out.distance = Slot(result, "distance");
+            out.unit     = Slot(result, "move_unit");
+        }
+    }
+    else if (type.equals("turn"))
+    {
+        if (intent())
+        {
+            out.distance = Slot(result, "distance");
+            out.unit     = Slot(result, "turn_unit");
+        }
+    }
+    else if (type.equals("action"))
+    {
+        intent();
+    }
+    else if (type.equals("stop") || type.equals("shut_up"))
+    {
+        out.touched++;
+    }
+    else if (type.equals("vip"))
+    {
+        out.intent_name = result["intentName"].asString();
+    }
+    else if (type.equals("new_year"))
+    {
+        static const int kIds[] = { 2003, 2014, 2016, 3052, 3053, 3012 };
+        out.motion              = true;
+        out.intent_name         = result["intentName"].asString();
+        out.id                  = std::to_string(kIds[rand() % 6]);
+    }
+}
+
+void NewRoute(const SkillRouter &router, const JsonNode &text_root, Extracted &out)
+{
+    const SkillRouter::Route *category = router.matchCategory(text_root);
+    if (category != nullptr && category->handler == SkillRouter::HANDLER_IGNORE)
+    {
+        return;
+    }
+    const JsonNode &result          = router.result(text_root);
+    const SkillRouter::Route *route = router.matchType(result);
+    if (!router.type(result).isString() || route == nullptr)
+    {
+        return;
+    }
+    if (route->handler != SkillRouter::HANDLER_MOTION)
+    {
+        out.touched++;
+        return;
+    }
+    MotionScheduler::Command command;
+    if (router.extractCommand(*route, result, command))
+    {
+        out.motion      = true;
+        out.intent_name = command.intent_name;
+        out.id          = command.id;
+        out.distance    = command.distance;
+        out.unit        = command.unit;
+    }
+}
+
+double NanosPerCall(int iterations, const std::function<void()> &fn)
+{
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        fn();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+}    // namespace
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+    Logger::Logger::GetInstance().SetLevel(Logger::LogLevel::LOG_WARN);
+
+    SkillRouter router;
+    router.build(AppConfig::getInstance().skills.routes);
+
+    static const char *kSamples[][2] = {
+        { "move", R"({"category":"OS.robot","data":{"result":[{"type":"move","intentName":"move_forward","id":12,)"
+                  R"("slots":{"distance":{"normValue":"2"},"move_unit":{"normValue":"米"}}}]}})" },
+        { "turn", R"({"category":"OS.robot","data":{"result":[{"type":"turn","intentName":"turn_left","id":13,)"
+                  R"("slots":{"distance":{"normValue":"90"},"turn_unit":{"normValue":"度"}}}]}})" },
+        { "action", R"({"category":"OS.robot","data":{"result":[{"type":"action","intentName":"wave","id":3001}]}})" },
+        { "new_year", R"({"category":"OS.robot","data":{"result":[{"type":"new_year","intentName":"ny","id":1}]}})" },
+        { "stop", R"({"category":"OS.robot","data":{"result":[{"type":"stop","intentName":"stop","id":3}]}})" },
+        { "datetime", R"({"category":"IFLYTEK.datetimePro","data":{"result":[{"type":"move"}]}})" },
+        { "unknown", R"({"category":"OS.robot","data":{"result":[{"type":"dance_party","intentName":"x","id":3}]}})" },
+    };
+
+    int mismatched = 0;
+    for (const auto &sample : kSamples)
+    {
+        JsonDocument doc;
+        if (!doc.Parse(std::string(sample[1])))
+        {
+            fprintf(stderr, "%s: parse failed\n", sample[0]);
+            return 1;
+        }
+
+        Extracted expected;
+        Extracted actual;
+        OldRoute(doc.Root(), expected);
+        NewRoute(router, doc.Root(), actual);
+        // new_year的id随机，只比较是否为运动指令和意图名
+        bool same = expected.motion == actual.motion && expected.intent_name == actual.intent_name &&
+                    expected.distance == actual.distance && expected.unit == actual.unit &&
+                    (strcmp(sample[0], "new_year") == 0 || expected.id == actual.id);
+        if (!same)
+        {
+            mismatched++;
+        }
+
+        Extracted sink;
+        double old_ns    = NanosPerCall(iterations, [&]() { OldRoute(doc.Root(), sink); });
+        double router_ns = NanosPerCall(iterations, [&]() { NewRoute(router, doc.Root(), sink); });
+        printf("%-9s if/else %6.0f ns  router %6.0f ns  %s intent=%s id=%s distance=%s unit=%s%s\n", sample[0], old_ns, router_ns,
+               actual.motion ? "motion" : "-", actual.intent_name.c_str(), actual.id.c_str(), actual.distance.c_str(),
+               actual.unit.c_str(), same ? "" : "  MISMATCH");
+    }
+    return mismatched == 0 ? 0 : 1;
+}
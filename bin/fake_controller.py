@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+运动控制器的本地替身，用于测试和测量指令客户端的延迟。
+
+接收 /webrtc/move、/webrtc/turn、/webrtc/action、/webrtc/stop 的POST请求，
+按HTTP/1.1保持长连接，可以模拟处理延迟和故障。
+
+用法:
+    ./bin/fake_controller.py --port 8848 --delay-ms 5 --fail-rate 0.1
+然后把robot.cfg中robot_command.base_url改为 http://127.0.0.1:8848
+"""
+import argparse
+import json
+import random
+import signal
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+ENDPOINTS = ("/webrtc/move", "/webrtc/turn", "/webrtc/action", "/webrtc/stop")
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.requests = 0
+        self.connections = 0
+        self.failed = 0
+
+    def summary(self):
+        with self.lock:
+            return "requests=%d connections=%d failed=%d" % (self.requests, self.connections, self.failed)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    # 响应头和body分两次写，长连接上不关Nagle会碰上对端的延迟确认，每个响应多等40 ms
+    disable_nagle_algorithm = True
+
+    def setup(self):
+        super().setup()
+        with self.server.stats.lock:
+            self.server.stats.connections += 1
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length)
+        args = self.server.args
+        with self.server.stats.lock:
+            self.server.stats.requests += 1
+
+        if self.path not in ENDPOINTS:
+            self.reply(404, {"code": 404, "msg": "unknown endpoint"})
+            return
+        try:
+            json.loads(body or b"null")
+        except ValueError:
+            self.reply(400, {"code": 400, "msg": "invalid json"})
+            return
+
+        delay_ms = args.stop_delay_ms if self.path == "/webrtc/stop" else args.delay_ms
+        if delay_ms > 0:
+            time.sleep(delay_ms / 1000.0)
+        if random.random() < args.fail_rate:
+            with self.server.stats.lock:
+                self.server.stats.failed += 1
+            self.reply(args.fail_status, {"code": args.fail_status, "msg": "injected failure"})
+            return
+        if not args.quiet:
+            print("%s %s" % (self.path, body.decode("utf-8", "replace")), flush=True)
+        self.reply(200, {"code": 0, "msg": "ok"})
+
+    def reply(self, status, payload):
+        data = json.dumps(payload).encode("utf-8")
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        try:
+            self.end_headers()
+            self.wfile.write(data)
+        except (BrokenPipeError, ConnectionResetError):
+            # 客户端撤回了请求（停止时撤回未应答的移动）
+            if not self.server.args.quiet:
+                print("%s 客户端已断开" % self.path, flush=True)
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description="运动控制器替身")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8848)
+    parser.add_argument("--delay-ms", type=float, default=0, help="移动、转向、动作的处理延迟")
+    parser.add_argument("--stop-delay-ms", type=float, default=0, help="停止的处理延迟")
+    parser.add_argument("--fail-rate", type=float, default=0, help="返回错误的比例")
+    parser.add_argument("--fail-status", type=int, default=503, help="注入故障时的状态码")
+    parser.add_argument("--quiet", action="store_true", help="不打印收到的指令")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer((args.host, args.port), Handler)
+    server.daemon_threads = True
+    server.args = args
+    server.stats = Stats()
+    # 后台运行时SIGINT被忽略，SIGTERM也按Ctrl+C处理，退出前打印统计
+    signal.signal(signal.SIGTERM, signal.default_int_handler)
+    print("fake controller on http://%s:%d" % (args.host, args.port), flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print(server.stats.summary(), flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -91,6 +91,7 @@ if ps -p $NEW_PID > /dev/null 2>&1; then
     echo_color $BLUE "  PID: $NEW_PID"
     echo_color $BLUE "  日志: $LOG_FILE"
     echo_color $BLUE "  监控: tail -f $LOG_FILE"
+    echo_color $BLUE "  程序日志: app.log（robot.cfg中log.output为file时日志只写这里）"
     
     # 显示最后几行日志
     echo_color $YELLOW "=== 程序启动日志 ==="
@@ -1,4 +1,7 @@
 #!/bin/bash
+# 先编译运动指令消息包，主程序通过install/setup.bash找到它
+(cd interfaces && colcon build --packages-select robot_avvtn_msgs) || exit 1
+source interfaces/install/setup.bash
 cd build && rm -rf * 
 cmake .. -DCMAKE_BUILD_TYPE=Release
 make -j8
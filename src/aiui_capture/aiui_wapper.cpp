@@ -1,30 +1,28 @@
 #include "aiui_wapper.h"
 #include "utils/Logger.hpp"
-#include "ros2/ros_manager.hpp"
+#include "utils/AppConfig.h"
+#include "utils/TtsCache.h"
+
+#include <algorithm>
+#include <chrono>
 
 // TtsHelperListener
 void TtsHelperListener::onText(const StreamNlpTtsHelper::OutTextSeg &textSeg)
 {
-    if (textSeg.isBegin() || textSeg.isEnd())
-    {
-        if (aiui_pcm_player_get_state() != PCM_PLAYER_STATE_STARTED)
-        {
-            aiui_pcm_player_start();
-        }
-        if (textSeg.isBegin())
-        {
-            aiui_pcm_player_clear();
-        }
-    }
-    // 调用合成 - 参考demo中TtsHelperListener::onText的实现
+    // 调用合成 - 参考demo中TtsHelperListener::onText的实现，经播报队列与其他播报仲裁
     LOG_INFO("调用合成:");
-    aiui_wrapper_ptr_->StartTTS(textSeg.mText, textSeg.mTag);
+    SpeechQueue &queue = aiui_wrapper_ptr_->speech_queue_;
+    queue.speak(textSeg.mText, SpeechQueue::PRIORITY_CHAT, queue.currentTurn(), textSeg.mTag);
     return;
 }
 
 void TtsHelperListener::onFinish(const std::string &fullText)
 {
     LOG_INFO("tts, fullText = %s", fullText.c_str());
+    const std::shared_ptr<StreamNlpTtsHelper> &helper = aiui_wrapper_ptr_->listener_->tts_helper_ptr_;
+    LOG_INFO("流式合成测速: 合成 %.1f 字/秒, 播放 %.1f 字/秒, 首包延迟 %.0f ms",
+             helper->getSynthCharsPerSec(), helper->getPlaybackCharsPerSec(), helper->getSynthLatencyMs());
+    LOG_INFO("流式合成断档: %d 次, 累计 %lld ms, 最长 %lld ms", helper->getGapCount(), helper->getGapTotalMs(), helper->getGapMaxMs());
     return;
 }
 
@@ -37,7 +35,7 @@ void TtsHelperListener::onTtsData(const Json::Value &bizParamJson, const char *a
 
     LOG_DEBUG("将合成数据写入播放器");
     // 将合成数据写入播放器
-    aiui_pcm_player_write(0, audio, len, dts, progress);
+    PcmOutput::getInstance().write(0, audio, len, dts, progress);
     return;
 }
 
@@ -49,48 +47,50 @@ int AIUIListener::Init(const aiui_callback_pack_t &aiui_callback_pack)
 
     aiui_callback_pack_ = aiui_callback_pack;
 
-    LOG_INFO("创建内置的pcm播放器, 并初始化，设置回调，启动起来");
-    // 创建内置的pcm播放器，并初始化，设置回调，启动起来
-    ret = aiui_pcm_player_create();
+    LOG_INFO("创建pcm播放器, 并初始化，设置回调，启动起来");
+    // 按配置创建AIUI内置或本程序的ALSA播放器，并初始化，设置回调，启动起来
+    ret = PcmOutput::getInstance().create();
     if (ret != 0)
     {
-        std::cout << "aiui_pcm_player_create failed" << std::endl;
         LOG_ERROR("内置的pcm播放器创建失败");
         return -1;
     }
 
     LOG_INFO("获取音频输出设备数量");
     // 获取输出设备数量
-    int count = aiui_pcm_player_get_output_device_count();
+    int count = PcmOutput::getInstance().getOutputDeviceCount();
     for (int i = 0; i < count; i++)
     {
         // 打印输出设备信息
-        std::cout << "pcm player index: " << i << " device name: " << aiui_pcm_player_get_device_name(i) << std::endl;
-        LOG_INFO("pcm player index: %d, device name: %s", i, aiui_pcm_player_get_device_name(i));
+        LOG_INFO("pcm player index: %d, device name: %s", i, PcmOutput::getInstance().getDeviceName(i));
     }
 
     LOG_INFO("选择默认播放设备进行初始化");
     // 初始化播放器，你应该根据上面打印的设备信息，选择一个设备，然后初始化，当前默认-1代表了默认的播放设备索引
     // 如果默认设备无法播放，请根据上述打印结果选择其他设备，并初始化
-    ret = aiui_pcm_player_init(-1);
+    ret = PcmOutput::getInstance().init(-1);
     if (ret != 0)
     {
         LOG_ERROR("内置的pcm播放器初始化失败");
-        std::cout << "aiui_pcm_player_init failed" << std::endl;
         return -1;
     }
 
     // 创建TTS播放辅助类
     tts_helper_ptr_ = std::make_shared<StreamNlpTtsHelper>(std::make_shared<TtsHelperListener>(aiui_wrapper_ptr_));
-    // 设置TTS最小文本长度
-    tts_helper_ptr_->setTextMinLimit(20);
+    // 设置分段策略：首段短句尽快出声，后续按实测的合成/播放速度放大
+    const AppConfig::TtsConfig &tts_cfg = AppConfig::getInstance().tts;
+    tts_helper_ptr_->setFirstTextMinLimit(tts_cfg.first_segment_min_chars);
+    tts_helper_ptr_->setTextMinLimit(tts_cfg.segment_min_chars);
+    tts_helper_ptr_->setTextMaxLimit(tts_cfg.segment_max_chars);
+    tts_helper_ptr_->setAdaptiveSegment(tts_cfg.adaptive_segment);
+    tts_helper_ptr_->setMaxInFlight(tts_cfg.max_inflight_segments);
     LOG_INFO("初始化AIUIListener成功");
     return 0;
 }
 
 int AIUIListener::Destory()
 {
-    aiui_pcm_player_destroy();
+    PcmOutput::getInstance().destroy();
     return 0;
 }
 
@@ -102,7 +102,6 @@ void AIUIListener::onEvent(const IAIUIEvent &event)
     }
     else
     {
-        std::cout << "AIUI callback function is not set" << std::endl;
         LOG_ERROR("AIUI callback function is not set");
     }
     return;
@@ -122,7 +121,6 @@ int AiuiWrapper::Init(const aiui_init_param_t &aiui_init_param)
     int ret   = listener_->Init(aiui_init_param_.callback);
     if (ret != 0)
     {
-        std::cout << "AIUIListener Init failed" << std::endl;
         LOG_ERROR("AIUIListener Init failed");
         return -1;
     }
@@ -135,7 +133,6 @@ int AiuiWrapper::Init(const aiui_init_param_t &aiui_init_param)
         std::ifstream config_file(aiui_init_param_.param.cfg_path, std::ios_base::in | std::ios::binary);
         if (!config_file.is_open())
         {
-            std::cout << "Error open config file: " << aiui_init_param_.param.cfg_path << std::endl;
             LOG_ERROR("Error open config file: %s", aiui_init_param_.param.cfg_path.c_str());
             return -1;
         }
@@ -148,22 +145,31 @@ int AiuiWrapper::Init(const aiui_init_param_t &aiui_init_param)
     Json::Reader reader;
     if (!reader.parse(aiui_params, param_json, false))
     {
-        std::cout << "Parse config error: " << reader.getFormattedErrorMessages() << std::endl;
         LOG_ERROR("Parse config error: %s", reader.getFormattedErrorMessages().c_str());
         return -1;
     }
 
+    // 合成缓存
+    // 缓存键带上aiui.cfg中整个tts配置：jsoncpp对象按键名排序，toString()的结果与文件中的顺序和空白无关，
+    // 发音人以外的vcn、engine_type等改动也会让旧录音失效
+    tts_voice_name_   = param_json["tts"]["voice_name"].asString();
+    tts_cache_params_ = param_json["tts"].toString();
+    const AppConfig::TtsCacheConfig &cache_cfg = AppConfig::getInstance().tts_cache;
+    if (cache_cfg.enable)
+    {
+        TtsCache::getInstance().open(cache_cfg.dir, cache_cfg.memory_entries, cache_cfg.disk_max_mb);
+    }
+
     LOG_INFO("创建AIUI代理Agent");
     // 创建AIUI代理
     aiui_agent_ = IAIUIAgent::createAgent(param_json.toString().c_str(), listener_.get(), GetMacAddress().c_str());
     if (!aiui_agent_)
     {
-        std::cout << "Create AIUI agent failed" << std::endl;
         LOG_ERROR("Create AIUI agent failed");
         return -1;
     }
 
-    std::cout << "AiuiWrapper Init success" << std::endl;
+    LOG_INFO("AiuiWrapper Init success");
     return 0;
 }
 
@@ -292,11 +298,11 @@ void AiuiWrapper::WriteAudioFromLocal(bool repeat)
         WriteAudio(nullptr, 0, true);
 
         delete[] audio;
-        std::cout << "write audio finish" << std::endl;
+        LOG_INFO("write audio finish");
     }
     else
     {
-        std::cout << "open file failed, path=" << TEST_AUDIO_PATH << std::endl;
+        LOG_ERROR("open file failed, path=%s", TEST_AUDIO_PATH);
     }
     return;
 }
@@ -331,21 +337,112 @@ void AiuiWrapper::StopRecordAudio()
     return;
 }
 
-void AiuiWrapper::StartTTS(const std::string &text, const std::string &tag)
+bool AiuiWrapper::StartTTS(const std::string &text, const std::string &tag, bool cacheable)
 {
+    //不设置发言人 默认发言人为aiui.cfg中配置的；本次调用的合成参数（tag除外）也要进缓存键
+    std::string synth_params;
+    std::string tts_tag = tag;
+    TtsCache &cache     = TtsCache::getInstance();
+    if (cacheable && cache.isEnabled())
+    {
+        // 固定话术和技能答复先查缓存，命中时不再请求云端合成；未命中的合成结果带标签录入缓存
+        std::string key = TtsCache::makeKey(tts_voice_name_, cacheParams(synth_params), text);
+        if (playCachedTts(key, text))
+        {
+            return true;
+        }
+        tts_tag = cache.beginRecord(key, true, tts_tag);
+    }
+
     LOG_INFO("发送开始TTS命令给AIUI");
     AIUIBuffer textData = aiui_create_buffer_from_data(text.c_str(), text.length());
 
-    //不设置发言人 默认发言人为aiui.cfg中配置的
-    std::string params;
-    if (!tag.empty())
+    std::string params = synth_params;
+    if (!tts_tag.empty())
     {
-        params.append(",tag=").append(tag);
+        params.append(",tag=").append(tts_tag);
     }
 
     // 使用aiui.cfg中配置的发音人合成
     sendAIUIMessage(AIUIConstant::CMD_TTS, AIUIConstant::START, 0, params.c_str(), textData);
-    return;
+    return false;
+}
+
+bool AiuiWrapper::playCachedTts(const std::string &key, const std::string &text)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const std::string> pcm = TtsCache::getInstance().lookup(key);
+    if (!pcm || pcm->empty())
+    {
+        return false;
+    }
+
+    if (PcmOutput::getInstance().getState() != PCM_PLAYER_STATE_STARTED)
+    {
+        PcmOutput::getInstance().start();
+    }
+
+    // 按200ms一块写入，与云端合成结果一样首块清掉播放器中之前的音频，末块触发播放完成回调
+    const int block = 6400;
+    const int total = (int)pcm->size();
+    for (int offset = 0; offset < total; offset += block)
+    {
+        int len    = (std::min)(block, total - offset);
+        bool first = offset == 0;
+        bool last  = offset + len >= total;
+        int dts    = PCM_PLAYER_DTS_BLOCK_FOLLOW;
+        if (first && last)
+        {
+            dts = PCM_PLAYER_DTS_ONE_BLOCK;
+        }
+        else if (first)
+        {
+            dts = PCM_PLAYER_DTS_BLOCK_FIRST;
+        }
+        else if (last)
+        {
+            dts = PCM_PLAYER_DTS_BLOCK_LAST;
+        }
+        PcmOutput::getInstance().write(0, pcm->data() + offset, len, dts, (int)((long long)(offset + len) * 100 / total));
+    }
+
+    double latency_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+    TtsCache &cache   = TtsCache::getInstance();
+    cache.reportHit(latency_ms);
+    TtsCache::Stats stats = cache.getStats();
+    LOG_INFO("TTS缓存命中: %s, 起播 %.2f ms, 命中率 %.1f%% (%d/%d), 云端首包 %.0f ms, 累计节省 %lld ms", text.c_str(), latency_ms,
+             stats.hits * 100.0 / (stats.hits + stats.misses), stats.hits, stats.hits + stats.misses, stats.missLatencyMs, stats.savedMs);
+
+    return true;
+}
+
+std::string AiuiWrapper::cacheParams(const std::string &synth_params) const
+{
+    return tts_cache_params_ + synth_params;
+}
+
+void AiuiWrapper::PrewarmTtsCache()
+{
+    TtsCache &cache = TtsCache::getInstance();
+    if (!cache.isEnabled() || cache.hasSilentRecording())
+    {
+        return;
+    }
+
+    const std::vector<std::string> &phrases = AppConfig::getInstance().tts_cache.prewarm;
+    while (tts_prewarm_index_ < phrases.size())
+    {
+        const std::string &text = phrases[tts_prewarm_index_++];
+        std::string key         = TtsCache::makeKey(tts_voice_name_, cacheParams(""), text);
+        if (cache.contains(key))
+        {
+            continue;
+        }
+
+        LOG_INFO("预热TTS缓存: %s", text.c_str());
+        StartTTS(text, cache.beginRecord(key, false));
+        return;
+    }
 }
 
 void AiuiWrapper::StartHTS(const std::string &text, const std::string &tag)
@@ -368,6 +465,13 @@ void AiuiWrapper::StartHTS(const std::string &text, const std::string &tag)
     return;
 }
 
+void AiuiWrapper::CancelTTS()
+{
+    LOG_INFO("发送取消TTS命令给AIUI");
+    sendAIUIMessage(AIUIConstant::CMD_TTS, AIUIConstant::CANCEL);
+    return;
+}
+
 void AiuiWrapper::StartTTSUrl(const std::string &text)
 {
     AIUIBuffer textData = aiui_create_buffer_from_data(text.c_str(), text.length());
@@ -382,7 +486,7 @@ void AiuiWrapper::BuildEsrGrammar()
     std::ifstream grammar_file("AIUI/esr/message.fsa", std::ios_base::in | std::ios::binary);
     if (!grammar_file.is_open())
     {
-        std::cout << "Error open grammar file" << std::endl;
+        LOG_ERROR("Error open grammar file");
         return;
     }
 
@@ -395,7 +499,7 @@ void AiuiWrapper::BuildEsrGrammar()
 
 void AiuiWrapper::CleanDialogHistory()
 {
-    std::cout << "cleanDialogHistory" << std::endl;
+    LOG_INFO("cleanDialogHistory");
     sendAIUIMessage(AIUIConstant::CMD_CLEAN_DIALOG_HISTORY);
     return;
 }
@@ -456,7 +560,7 @@ void AiuiWrapper::SyncV2SeeSayData()
     std::ifstream see_say_file(TEST_SEE_SAY_PATH, std::ios_base::in | std::ios::binary);
     if (!see_say_file.is_open())
     {
-        std::cout << "Error open see say file: " << TEST_SEE_SAY_PATH << std::endl;
+        LOG_ERROR("Error open see say file: %s", TEST_SEE_SAY_PATH);
         return;
     }
 
@@ -467,11 +571,11 @@ void AiuiWrapper::SyncV2SeeSayData()
     Json::Reader reader;
     if (!reader.parse(seeSayContent, contentJson, false))
     {
-        std::cout << "syncV2SeeSayData parse error! info=" << seeSayContent << std::endl;
+        LOG_ERROR("syncV2SeeSayData parse error! info=%s", seeSayContent.c_str());
         return;
     }
 
-    std::cout << "see say content: " << contentJson.asString() << std::endl;
+    LOG_INFO("see say content: %s", contentJson.asString().c_str());
     // 整个json在进行base64编码
     std::string dataStrBase64 = Base64Util::encode(contentJson.asString());
     Json::Value syncSeeSayJson;
@@ -496,7 +600,7 @@ void AiuiWrapper::VoiceCloneReg(const std::string &resPath)
     paramJson["tag"]      = "voice_clone_tag_0";
     paramJson["res_path"] = resource_path;
 
-    std::cout << "上传声音复刻的资源,资源路径: " << resource_path << std::endl;
+    LOG_INFO("上传声音复刻的资源,资源路径: %s", resource_path.c_str());
 
     // 注：数据同步请在连接服务器之后进行，否则可能失败
     sendAIUIMessage(AIUIConstant::CMD_CLONE_VOICE, AIUIConstant::VOICE_CLONE_REG, 0, paramJson.toString().c_str(), nullptr);
@@ -519,11 +623,11 @@ void AiuiWrapper::VoiceCloneDelRes()
 
     if (resId.empty())
     {
-        std::cout << "删除声音复刻的资源失败，资源ID为NULL" << std::endl;
+        LOG_ERROR("删除声音复刻的资源失败，资源ID为NULL");
         return;
     }
 
-    std::cout << "删除声音复刻的资源,res id = " << resId << std::endl;
+    LOG_INFO("删除声音复刻的资源,res id = %s", resId.c_str());
 
     Json::Value paramJson;
     paramJson["tag"]    = "voice_clone_tag_1";
@@ -560,7 +664,7 @@ void AiuiWrapper::StartVoiceCloneTTS(const std::string &text, const std::string
 
     if (resId.empty())
     {
-        std::cout << "请求声音复刻的tts失败，资源ID为NULL" << std::endl;
+        LOG_ERROR("请求声音复刻的tts失败，资源ID为NULL");
         return;
     }
 
@@ -611,12 +715,10 @@ void AiuiWrapper::OperateWakeupWord(int op)
             text = std::string((std::istreambuf_iterator<char>(wake_file)), std::istreambuf_iterator<char>());
             wake_file.close();
         }
-        std::cout << "wakeup word process text: " << text << ", operate type:" << op << std::endl;
         LOG_INFO("wakeup word process text: %s, operate type: %d", text.c_str(), op);
     }
     else
     {
-        std::cout << "wakeup word process operate type:" << op << std::endl;
         LOG_INFO("wakeup word process operate type: %d", op);
     }
 
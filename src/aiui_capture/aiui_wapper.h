@@ -31,6 +31,8 @@
 // AIUI SDK相关头文件
 #include "aiui/AIUI_V2.h"                // AIUI SDK主头文件
 #include "aiui/PcmPlayer_C.h"            // PCM音频播放器
+#include "audio_player/pcm_output.h"     // 播放器入口（AIUI内置或ALSA）
+#include "aiui_capture/speech_queue.h"   // 播报队列
 #include "utils/Base64Util.h"            // Base64编码工具
 #include "utils/IatResultUtil.h"         // 语音识别结果处理工具
 #include "utils/StreamNlpTtsHelper.h"    // 流式NLP TTS助手
@@ -50,9 +52,6 @@
 #define AIUI_VER 3
 #endif
 
-// 是否使用语义后合成。当在AIUI平台应用配置页面打开"语音合成"开关时，需要打开该宏
-#define USE_POST_SEMANTIC_TTS
-
 // 使用AIUI命名空间
 using namespace aiui_va;
 using namespace aiui_v2;
@@ -245,10 +244,13 @@ public:
     // TTS语音合成相关函数
     /**
      * @brief 开始TTS语音合成
+     * @details 业务播报请走speech_queue_，这里只负责发合成请求
      * @param text 要合成的文本
      * @param tag 标签，默认为空字符串
+     * @param cacheable 是否先查合成缓存，未命中的合成结果以tag录入缓存
+     * @return 合成缓存命中、音频已直接写入播放器时返回true
      */
-    void StartTTS(const std::string &text, const std::string &tag = "");
+    bool StartTTS(const std::string &text, const std::string &tag = "", bool cacheable = false);
 
     /**
      * @brief 开始HTS语音合成
@@ -263,6 +265,17 @@ public:
      */
     void StartTTSUrl(const std::string &text);
 
+    /**
+     * @brief 取消正在进行的TTS合成
+     */
+    void CancelTTS();
+
+    /**
+     * @brief 预热合成缓存：每次发一句配置中还没缓存的话术，合成结果只录入缓存不播放
+     * @details 在AIUI就绪后以及上一句预热录完后调用，同一时间只有一句在合成
+     */
+    void PrewarmTtsCache();
+
     // 语法和对话相关函数
     /**
      * @brief 构建ESR语法
@@ -335,6 +348,8 @@ public:
 
     std::shared_ptr<AIUIListener> listener_;    // AIUI监听器智能指针
 
+    SpeechQueue speech_queue_{ this };          // 播报队列，所有业务播报经它按优先级排队
+
 private:
     /**
      * @brief 初始化设置
@@ -351,6 +366,19 @@ private:
      */
     void sendAIUIMessage(int cmd, int arg1 = 0, int arg2 = 0, const char *params = "", AIUIBuffer data = nullptr);
 
+    /**
+     * @brief 合成缓存命中时直接把PCM写入播放器
+     * @param key 缓存键
+     * @param text 合成文本，用于日志
+     * @return 命中返回true
+     */
+    bool playCachedTts(const std::string &key, const std::string &text);
+
+    /**
+     * @brief 合成缓存键中的参数部分：aiui.cfg的tts配置加上本次调用的合成参数
+     * @param synth_params 本次调用传给CMD_TTS的合成参数，不含tag
+     */
+    std::string cacheParams(const std::string &synth_params) const;
 
 private:
     aiui_init_param_t aiui_init_param_;      // AIUI初始化参数
@@ -358,6 +386,9 @@ private:
     std::string sync_session_id_;            // 同步会话ID
     std::string voice_clone_resource_id_;    // 语音克隆资源ID
     int pcm_player_index_;                   // PCM播放器索引
+    std::string tts_voice_name_;             // aiui.cfg中配置的发音人，作为合成缓存键的一部分
+    std::string tts_cache_params_;           // aiui.cfg中整个tts配置的规范化文本，作为合成缓存键的一部分
+    size_t tts_prewarm_index_ = 0;           // 下一句要预热的话术
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,411 @@
+#include "aiui_capture/speech_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "aiui_capture/aiui_wapper.h"
+#include "utils/Logger.hpp"
+
+namespace
+{
+
+// 保留最近几轮已作废的识别sid，云端语义后合成晚到时据此识别过期的应答
+const size_t kRetiredSidCount = 8;
+
+}    // namespace
+
+SpeechTokenPtr SpeechQueue::newToken()
+{
+    return std::make_shared<SpeechCancelToken>();
+}
+
+const char *SpeechQueue::priorityName(Priority priority)
+{
+    switch (priority)
+    {
+        case PRIORITY_SAFETY:
+            return "安全提示";
+        case PRIORITY_COMMAND:
+            return "指令确认";
+        case PRIORITY_SKILL:
+            return "技能答复";
+        case PRIORITY_GREETING:
+            return "唤醒应答";
+        case PRIORITY_CHAT:
+            return "闲聊应答";
+        default:
+            return "未知";
+    }
+}
+
+SpeechTokenPtr SpeechQueue::newTurn(const std::string &iat_sid)
+{
+    Dispatch dispatch;
+    SpeechTokenPtr token = newToken();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (turn_token_)
+        {
+            turn_token_->cancel();
+        }
+        if (!turn_sid_.empty())
+        {
+            retired_sids_.push_back(turn_sid_);
+            if (retired_sids_.size() > kRetiredSidCount)
+            {
+                retired_sids_.pop_front();
+            }
+        }
+        turn_sid_   = iat_sid;
+        turn_token_ = token;
+        lingering_tags_.clear();
+        lingering_token_.reset();
+
+        // 上一轮的应答还在播，新的提问到来后不应再听到它
+        if (active_ && active_token_->isCancelled())
+        {
+            LOG_INFO("播报队列: 新的提问，停止上一轮的%s", priorityName(active_priority_));
+            dispatch.preempt = true;
+            finishActiveLocked(nowMs(), dispatch);
+        }
+    }
+    execute(dispatch);
+    return token;
+}
+
+SpeechTokenPtr SpeechQueue::currentTurn()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!turn_token_)
+    {
+        turn_token_ = newToken();
+    }
+    return turn_token_;
+}
+
+void SpeechQueue::speak(const std::string &text, Priority priority, const SpeechTokenPtr &token, const std::string &tag)
+{
+    Dispatch dispatch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!token || token->isCancelled())
+        {
+            stats_[priority].dropped++;
+            LOG_DEBUG("播报队列: 令牌已作废，丢弃%s: %s", priorityName(priority), text.c_str());
+            return;
+        }
+
+        long long now = nowMs();
+        Item item;
+        item.text       = text;
+        item.tag        = tag;
+        item.cacheable  = tag.empty();
+        item.priority   = priority;
+        item.token      = token;
+        item.enqueue_ms = now;
+
+        expireLocked(now, dispatch);
+        if (active_ && active_token_->isCancelled())
+        {
+            dispatch.preempt = true;
+            finishActiveLocked(now, dispatch);
+        }
+
+        if (!active_)
+        {
+            activateLocked(item, now, dispatch);
+        }
+        else if (priority == active_priority_ && token == active_token_)
+        {
+            // 流式应答的后续分段，与正在播的分段并行合成
+            joinLocked(item, now, dispatch);
+        }
+        else if (priority < active_priority_)
+        {
+            LOG_INFO("播报队列: %s抢占%s", priorityName(priority), priorityName(active_priority_));
+            stats_[active_priority_].preempted++;
+            active_token_->cancel();
+            active_          = false;
+            dispatch.preempt = true;
+            activateLocked(item, now, dispatch);
+        }
+        else
+        {
+            LOG_DEBUG("播报队列: %s排队等待%s播完", priorityName(priority), priorityName(active_priority_));
+            pending_[priority].push_back(item);
+        }
+    }
+    execute(dispatch);
+}
+
+bool SpeechQueue::admitTts(const std::string &tag, const std::string &sid, int len)
+{
+    Dispatch dispatch;
+    bool admit = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        long long now = nowMs();
+        expireLocked(now, dispatch);
+
+        if (!tag.empty())
+        {
+            if (active_ && active_tags_.count(tag))
+            {
+                admit = true;
+            }
+            else if (!active_ && lingering_tags_.count(tag) && !lingering_token_->isCancelled())
+            {
+                // 分段之间播放器空闲过，本组已按结束处理，晚到的分段把它重新接上
+                active_          = true;
+                active_priority_ = lingering_priority_;
+                active_token_    = lingering_token_;
+                active_tags_.swap(lingering_tags_);
+                active_start_ms_ = now;
+                lingering_tags_.clear();
+                lingering_token_.reset();
+                admit = true;
+            }
+        }
+        else if (std::find(retired_sids_.begin(), retired_sids_.end(), sid) == retired_sids_.end())
+        {
+            // 云端语义后合成没有标签，sid不属于已作废的轮次就按本轮闲聊应答处理
+            if (!turn_token_)
+            {
+                turn_token_ = newToken();
+            }
+            if (!turn_token_->isCancelled())
+            {
+                if (!active_)
+                {
+                    Item item;
+                    item.priority   = PRIORITY_CHAT;
+                    item.token      = turn_token_;
+                    item.enqueue_ms = now;
+                    activateLocked(item, now, dispatch);
+                    admit = true;
+                }
+                else if (active_priority_ == PRIORITY_CHAT && active_token_ == turn_token_)
+                {
+                    active_tags_.insert(std::string());
+                    admit = true;
+                }
+            }
+        }
+
+        if (admit && len > 0)
+        {
+            active_audio_ms_ = now;
+        }
+    }
+    execute(dispatch);
+    return admit;
+}
+
+void SpeechQueue::onPlaybackFinished()
+{
+    Dispatch dispatch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 本组还没写过音频时的播完回调属于被抢占或清空的旧音频
+        if (!active_ || active_audio_ms_ == 0)
+        {
+            return;
+        }
+        finishActiveLocked(nowMs(), dispatch);
+    }
+    execute(dispatch);
+}
+
+void SpeechQueue::onPlaybackIdle()
+{
+    Dispatch dispatch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        long long now = nowMs();
+        expireLocked(now, dispatch);
+        if (active_ && active_audio_ms_ != 0)
+        {
+            lingering_priority_ = active_priority_;
+            lingering_token_    = active_token_;
+            lingering_tags_     = active_tags_;
+            finishActiveLocked(now, dispatch);
+        }
+    }
+    execute(dispatch);
+}
+
+void SpeechQueue::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (active_)
+    {
+        active_token_->cancel();
+        active_ = false;
+        active_tags_.clear();
+        active_token_.reset();
+    }
+    for (int p = 0; p < PRIORITY_COUNT; p++)
+    {
+        for (Item &item : pending_[p])
+        {
+            item.token->cancel();
+            stats_[p].dropped++;
+        }
+        pending_[p].clear();
+    }
+    lingering_tags_.clear();
+    lingering_token_.reset();
+}
+
+SpeechQueue::Stats SpeechQueue::getStats(Priority priority)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_[priority];
+}
+
+void SpeechQueue::activateLocked(Item &item, long long now, Dispatch &dispatch)
+{
+    active_          = true;
+    active_priority_ = item.priority;
+    active_token_    = item.token;
+    active_start_ms_ = now;
+    active_audio_ms_ = 0;
+    active_tags_.clear();
+
+    if (lingering_token_ == item.token && lingering_priority_ == item.priority)
+    {
+        active_tags_.swap(lingering_tags_);
+    }
+    lingering_tags_.clear();
+    lingering_token_.reset();
+
+    joinLocked(item, now, dispatch);
+}
+
+void SpeechQueue::joinLocked(Item &item, long long now, Dispatch &dispatch)
+{
+    Stats &stats   = stats_[item.priority];
+    double wait_ms = (double)(now - item.enqueue_ms);
+    stats.played++;
+    wait_total_ms_[item.priority] += wait_ms;
+    stats.avg_wait_ms = wait_total_ms_[item.priority] / stats.played;
+    stats.max_wait_ms = (std::max)(stats.max_wait_ms, wait_ms);
+
+    // 云端语义后合成不需要发请求，只占住播放权
+    if (item.text.empty() && item.tag.empty())
+    {
+        return;
+    }
+    if (item.tag.empty())
+    {
+        item.tag = "speech-" + std::to_string(++tag_seq_);
+    }
+    active_tags_.insert(item.tag);
+    if (wait_ms > 0)
+    {
+        LOG_INFO("播报队列: %s排队 %.0f ms 后开播", priorityName(item.priority), wait_ms);
+    }
+    dispatch.start.push_back(item);
+}
+
+void SpeechQueue::finishActiveLocked(long long now, Dispatch &dispatch)
+{
+    active_ = false;
+    active_tags_.clear();
+    active_token_.reset();
+
+    for (int p = 0; p < PRIORITY_COUNT; p++)
+    {
+        std::deque<Item> &queue = pending_[p];
+        while (!queue.empty() && queue.front().token->isCancelled())
+        {
+            stats_[p].dropped++;
+            queue.pop_front();
+        }
+        if (queue.empty())
+        {
+            continue;
+        }
+
+        Item head = queue.front();
+        queue.pop_front();
+        activateLocked(head, now, dispatch);
+
+        // 同组排在后面的分段一起开播
+        for (auto it = queue.begin(); it != queue.end();)
+        {
+            if (it->token == active_token_)
+            {
+                joinLocked(*it, now, dispatch);
+                it = queue.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return;
+    }
+
+    logStatsLocked();
+}
+
+void SpeechQueue::expireLocked(long long now, Dispatch &dispatch)
+{
+    if (active_ && active_audio_ms_ == 0 && now - active_start_ms_ > kNoAudioTimeoutMs)
+    {
+        LOG_WARN("播报队列: %s开播 %lld ms 仍无音频，让给下一组", priorityName(active_priority_), now - active_start_ms_);
+        finishActiveLocked(now, dispatch);
+    }
+}
+
+void SpeechQueue::logStatsLocked()
+{
+    std::string line;
+    char buf[160];
+    for (int p = 0; p < PRIORITY_COUNT; p++)
+    {
+        const Stats &stats = stats_[p];
+        if (stats.played == 0 && stats.dropped == 0)
+        {
+            continue;
+        }
+        snprintf(buf, sizeof(buf), " %s: 开播 %d, 丢弃 %d, 被抢占 %d, 等待平均 %.0f ms 最长 %.0f ms;", priorityName((Priority)p),
+                 stats.played, stats.dropped, stats.preempted, stats.avg_wait_ms, stats.max_wait_ms);
+        line.append(buf);
+    }
+    LOG_INFO("播报队列空闲,%s", line.c_str());
+}
+
+void SpeechQueue::execute(const Dispatch &dispatch)
+{
+    if (dispatch.preempt)
+    {
+        PcmOutput::getInstance().clear();
+        aiui_wrapper_->CancelTTS();
+    }
+
+    for (const Item &item : dispatch.start)
+    {
+        if (PcmOutput::getInstance().getState() != PCM_PLAYER_STATE_STARTED)
+        {
+            PcmOutput::getInstance().start();
+        }
+        LOG_INFO("播报[%s]: %s", priorityName(item.priority), item.text.c_str());
+        if (aiui_wrapper_->StartTTS(item.text, item.tag, item.cacheable))
+        {
+            // 合成缓存命中时音频已直接写入播放器，不会再经过admitTts()
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (active_ && active_tags_.count(item.tag))
+            {
+                active_audio_ms_ = nowMs();
+            }
+        }
+    }
+}
+
+long long SpeechQueue::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
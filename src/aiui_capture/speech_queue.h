@@ -0,0 +1,178 @@
+/**
+ * @file speech_queue.h
+ * @brief 播报队列：按优先级仲裁所有要说出口的话
+ * @details 唤醒应答、技能答复、流式语义应答的分段和安全提示都通过speak()排队，同一时间只有一组在播。
+ *          同优先级、同取消令牌的请求算同一组（流式应答的各个分段），组内直接发合成，不互相等待。
+ *          更高优先级的请求到来时清空播放器、取消云端合成，被抢占的组连同它的令牌一起作废。
+ *          技能答复和闲聊应答用本轮对话的令牌，新的提问到来时上一轮的令牌作废，
+ *          晚到的旧合成音频在admitTts()处被拦下，不会再写进播放器。
+ */
+#ifndef SPEECH_QUEUE_H
+#define SPEECH_QUEUE_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+class AiuiWrapper;
+
+/**
+ * @brief 播报请求的取消令牌，作废后持有它的请求不再开播，正在播的被停掉
+ */
+class SpeechCancelToken
+{
+public:
+    void cancel() { cancelled_ = true; }
+    bool isCancelled() const { return cancelled_; }
+
+private:
+    std::atomic<bool> cancelled_{ false };
+};
+
+typedef std::shared_ptr<SpeechCancelToken> SpeechTokenPtr;
+
+class SpeechQueue
+{
+public:
+    /**
+     * @brief 优先级，数值越小越优先
+     */
+    enum Priority
+    {
+        PRIORITY_SAFETY = 0,    // 安全提示
+        PRIORITY_COMMAND,       // 停止等控制指令的确认
+        PRIORITY_SKILL,         // 技能答复
+        PRIORITY_GREETING,      // 唤醒应答
+        PRIORITY_CHAT,          // 大模型闲聊应答
+        PRIORITY_COUNT
+    };
+
+    struct Stats
+    {
+        int played         = 0;    // 开播的请求数
+        int dropped        = 0;    // 开播前令牌已作废而丢弃的请求数
+        int preempted      = 0;    // 播放中被更高优先级抢占的次数
+        double avg_wait_ms = 0;    // 从入队到开播的平均等待
+        double max_wait_ms = 0;
+    };
+
+    explicit SpeechQueue(AiuiWrapper *aiui_wrapper) : aiui_wrapper_(aiui_wrapper) {}
+
+    static SpeechTokenPtr newToken();
+
+    static const char *priorityName(Priority priority);
+
+    /**
+     * @brief 新的提问开始：上一轮的令牌作废，上一轮还在播的应答立即停掉
+     * @param iat_sid 本轮识别sid，云端语义后合成的sid与之相同
+     * @return 本轮的令牌
+     */
+    SpeechTokenPtr newTurn(const std::string &iat_sid);
+
+    /**
+     * @brief 本轮对话的令牌，技能答复和闲聊应答用它
+     */
+    SpeechTokenPtr currentTurn();
+
+    /**
+     * @brief 提交一句播报
+     * @param text 合成文本
+     * @param priority 优先级
+     * @param token 取消令牌
+     * @param tag 合成标签；为空时由队列生成，并先查合成缓存
+     */
+    void speak(const std::string &text, Priority priority, const SpeechTokenPtr &token, const std::string &tag = "");
+
+    /**
+     * @brief 提交一句不属于任何对话轮次的播报，使用独立的令牌
+     */
+    void speak(const std::string &text, Priority priority) { speak(text, priority, newToken()); }
+
+    /**
+     * @brief 每块合成音频写入播放器前调用
+     * @param tag 合成标签；为空表示云端语义后合成，按本轮闲聊应答处理
+     * @param sid 合成sid
+     * @param len 音频长度
+     * @return 属于正在播的组返回true；被抢占、已作废或过期的返回false，调用方丢弃
+     */
+    bool admitTts(const std::string &tag, const std::string &sid, int len);
+
+    /**
+     * @brief 播放器播完最后一块，当前组结束，开播下一组
+     */
+    void onPlaybackFinished();
+
+    /**
+     * @brief 播放器一段时间没有进度，当前组已写过音频的按结束处理
+     */
+    void onPlaybackIdle();
+
+    /**
+     * @brief 用户打断或重新唤醒：作废正在播和排队中的全部请求，停播由调用方完成
+     */
+    void cancelAll();
+
+    Stats getStats(Priority priority);
+
+private:
+    struct Item
+    {
+        std::string text;
+        std::string tag;
+        bool cacheable     = false;    // 队列生成的标签先查合成缓存
+        Priority priority  = PRIORITY_CHAT;
+        SpeechTokenPtr token;
+        long long enqueue_ms = 0;
+    };
+
+    // 在锁内决定、在锁外执行的动作，播放器和AIUI调用不在锁内进行
+    struct Dispatch
+    {
+        bool preempt = false;    // 清空播放器并取消云端合成
+        std::vector<Item> start;
+    };
+
+    void activateLocked(Item &item, long long now, Dispatch &dispatch);
+    void joinLocked(Item &item, long long now, Dispatch &dispatch);
+    void finishActiveLocked(long long now, Dispatch &dispatch);
+    void expireLocked(long long now, Dispatch &dispatch);
+    void logStatsLocked();
+    void execute(const Dispatch &dispatch);
+
+    static long long nowMs();
+
+    // 开播后这么久还没有任何音频写入，视为合成失败，让给下一组
+    static const long long kNoAudioTimeoutMs = 10 * 1000;
+
+    AiuiWrapper *aiui_wrapper_;
+
+    std::mutex mutex_;
+    std::deque<Item> pending_[PRIORITY_COUNT];
+
+    bool active_               = false;
+    Priority active_priority_  = PRIORITY_CHAT;
+    SpeechTokenPtr active_token_;
+    std::set<std::string> active_tags_;    // 本组已发出的合成标签，空串表示云端语义后合成
+    long long active_start_ms_ = 0;
+    long long active_audio_ms_ = 0;        // 本组最近一次写入音频的时间，0表示还没写过
+
+    // 播放器空闲而结束、但令牌仍有效的组，其后续分段的音频晚到时重新接上
+    Priority lingering_priority_ = PRIORITY_CHAT;
+    SpeechTokenPtr lingering_token_;
+    std::set<std::string> lingering_tags_;
+
+    SpeechTokenPtr turn_token_;
+    std::string turn_sid_;
+    std::deque<std::string> retired_sids_;    // 最近几轮已作废的识别sid
+
+    int tag_seq_ = 0;
+
+    Stats stats_[PRIORITY_COUNT];
+    double wait_total_ms_[PRIORITY_COUNT] = {};
+};
+
+#endif    // SPEECH_QUEUE_H
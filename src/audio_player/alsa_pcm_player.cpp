@@ -0,0 +1,510 @@
+#include "audio_player/alsa_pcm_player.h"
+
+#ifdef ROBOT_HAS_ALSA
+
+#include <alsa/asoundlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "utils/Logger.hpp"
+
+namespace
+{
+
+// 播完后静音持续这么久就停掉设备，下次写入再启动
+const int kParkMs = 3000;
+
+bool isFirstBlock(int dts)
+{
+    return dts == PCM_PLAYER_DTS_BLOCK_FIRST || dts == PCM_PLAYER_DTS_ONE_BLOCK;
+}
+
+bool isLastBlock(int dts)
+{
+    return dts == PCM_PLAYER_DTS_BLOCK_LAST || dts == PCM_PLAYER_DTS_ONE_BLOCK;
+}
+
+}    // namespace
+
+AlsaPcmPlayer::AlsaPcmPlayer(const std::string &device, int period_ms, int periods, int ring_seconds)
+    : device_(device), period_ms_((std::max)(period_ms, 1)), periods_((std::max)(periods, 2)), ring_seconds_((std::max)(ring_seconds, 1))
+{
+}
+
+AlsaPcmPlayer::~AlsaPcmPlayer()
+{
+    destroy();
+}
+
+int AlsaPcmPlayer::init(int sample_rate)
+{
+    int err = snd_pcm_open(&pcm_, device_.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+    if (err < 0)
+    {
+        LOG_ERROR("打开ALSA设备 %s 失败: %s", device_.c_str(), snd_strerror(err));
+        pcm_ = nullptr;
+        return -1;
+    }
+
+    snd_pcm_hw_params_t *hw_params;
+    snd_pcm_hw_params_alloca(&hw_params);
+    snd_pcm_hw_params_any(pcm_, hw_params);
+    snd_pcm_hw_params_set_access(pcm_, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+    snd_pcm_hw_params_set_format(pcm_, hw_params, SND_PCM_FORMAT_S16_LE);
+    snd_pcm_hw_params_set_channels(pcm_, hw_params, 1);
+    unsigned int rate = (unsigned int)sample_rate;
+    snd_pcm_hw_params_set_rate_near(pcm_, hw_params, &rate, nullptr);
+    snd_pcm_uframes_t period = (snd_pcm_uframes_t)rate * period_ms_ / 1000;
+    snd_pcm_hw_params_set_period_size_near(pcm_, hw_params, &period, nullptr);
+    snd_pcm_uframes_t buffer = period * periods_;
+    snd_pcm_hw_params_set_buffer_size_near(pcm_, hw_params, &buffer);
+    err = snd_pcm_hw_params(pcm_, hw_params);
+    if (err < 0)
+    {
+        LOG_ERROR("设置ALSA硬件参数失败: %s", snd_strerror(err));
+        snd_pcm_close(pcm_);
+        pcm_ = nullptr;
+        return -1;
+    }
+    // 以驱动最终协商的结果为准，缓冲大小可能被向上取整，不一定是周期的periods_倍
+    snd_pcm_hw_params_get_period_size(hw_params, &period, nullptr);
+    snd_pcm_hw_params_get_buffer_size(hw_params, &buffer);
+
+    // 写满一个周期就开始出声，起播延迟不再等整个设备缓冲填满
+    snd_pcm_sw_params_t *sw_params;
+    snd_pcm_sw_params_alloca(&sw_params);
+    snd_pcm_sw_params_current(pcm_, sw_params);
+    snd_pcm_sw_params_set_start_threshold(pcm_, sw_params, period);
+    snd_pcm_sw_params_set_avail_min(pcm_, sw_params, period);
+    snd_pcm_sw_params(pcm_, sw_params);
+
+    sample_rate_   = (int)rate;
+    period_frames_  = period;
+    buffer_periods_ = (size_t)((buffer + period - 1) / period);
+    ring_.assign((size_t)rate * 2 * ring_seconds_, 0);
+    LOG_INFO("ALSA播放器: 设备 %s, %u Hz, 周期 %lu 帧, 设备缓冲 %lu 帧, 环形缓冲 %d 秒", device_.c_str(), rate, (unsigned long)period,
+             (unsigned long)buffer, ring_seconds_);
+
+    running_ = true;
+    thread_  = std::thread(&AlsaPcmPlayer::run, this);
+    state_   = PCM_PLAYER_STATE_INITED;
+    return 0;
+}
+
+void AlsaPcmPlayer::setCallbacks(pcm_player_onstarted_cb on_started, pcm_player_onstopped_cb on_stopped,
+                                 pcm_player_onplayprogress_cb on_progress, pcm_player_onerror_cb on_error)
+{
+    on_started_  = on_started;
+    on_stopped_  = on_stopped;
+    on_progress_ = on_progress;
+    on_error_    = on_error;
+}
+
+int AlsaPcmPlayer::start()
+{
+    if (pcm_ == nullptr)
+    {
+        return -1;
+    }
+    state_ = PCM_PLAYER_STATE_STARTED;
+    if (on_started_)
+    {
+        on_started_();
+    }
+    return 0;
+}
+
+int AlsaPcmPlayer::write(int stream_id, const char *pcm, int len, int dts, int progress)
+{
+    if (pcm == nullptr || len <= 0)
+    {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (state_ != PCM_PLAYER_STATE_STARTED)
+    {
+        return -1;
+    }
+
+    uint64_t write = write_pos_.load();
+    if (isFirstBlock(dts))
+    {
+        flush_to_ = write;
+    }
+
+    // 按播放线程实际读到的位置判断是否写得下，不覆盖它可能正在读的数据
+    if (write - read_pos_.load() + (uint64_t)len > ring_.size())
+    {
+        overflows_++;
+        LOG_WARN("ALSA播放器: 环形缓冲已满，丢弃 %d 字节", len);
+        return -1;
+    }
+
+    // 标记先于音频可见，播放线程读到这段音频时一定能找到它的标记
+    size_t tail = marker_tail_.load();
+    if (tail - marker_head_.load() < kMaxMarkers)
+    {
+        Marker &marker   = markers_[tail % kMaxMarkers];
+        marker           = Marker();
+        marker.start     = write;
+        marker.end       = write + len;
+        marker.stream_id = stream_id;
+        marker.dts       = dts;
+        marker.progress  = progress;
+        marker.write_ms  = isFirstBlock(dts) ? nowMs() : 0;
+        marker_tail_     = tail + 1;
+    }
+    else if (isLastBlock(dts))
+    {
+        // 播完回调不能丢，否则播报队列和对话状态只能等兜底超时
+        overflow_stream_id_ = stream_id;
+        overflow_progress_  = progress;
+        overflow_end_       = write + len;
+        LOG_WARN("ALSA播放器: 待播标记已满，末块只回调播完");
+    }
+    else
+    {
+        LOG_WARN("ALSA播放器: 待播标记已满，这块音频不回调进度");
+    }
+
+    size_t capacity = ring_.size();
+    size_t index    = (size_t)(write % capacity);
+    size_t first    = (std::min)((size_t)len, capacity - index);
+    memcpy(ring_.data() + index, pcm, first);
+    memcpy(ring_.data(), pcm + first, len - first);
+
+    stream_open_ = dts == PCM_PLAYER_DTS_BLOCK_FIRST || dts == PCM_PLAYER_DTS_BLOCK_FOLLOW;
+    write_pos_   = write + len;
+    wake();
+    return 0;
+}
+
+int AlsaPcmPlayer::clear()
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    flush_to_    = write_pos_.load();
+    stream_open_ = false;
+    return 0;
+}
+
+int AlsaPcmPlayer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        if (state_ != PCM_PLAYER_STATE_STARTED)
+        {
+            return 0;
+        }
+        state_       = PCM_PLAYER_STATE_STOPPED;
+        flush_to_    = write_pos_.load();
+        stream_open_ = false;
+    }
+
+    // 设备缓冲中的音频由播放线程drop掉，打断时不再漏出
+    drop_request_ = true;
+    wake();
+    if (on_stopped_)
+    {
+        on_stopped_();
+    }
+    return 0;
+}
+
+void AlsaPcmPlayer::destroy()
+{
+    if (running_.exchange(false))
+    {
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            park_cv_.notify_one();
+        }
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+    if (pcm_ != nullptr)
+    {
+        snd_pcm_close(pcm_);
+        pcm_ = nullptr;
+    }
+    state_ = PCM_PLAYER_STATE_DESTROYED;
+}
+
+AlsaPcmPlayer::Stats AlsaPcmPlayer::getStats()
+{
+    Stats stats;
+    stats.plays                = plays_.load();
+    stats.avg_start_latency_ms = stats.plays > 0 ? (double)latency_total_ms_.load() / stats.plays : 0;
+    stats.max_start_latency_ms = (double)latency_max_ms_.load();
+    stats.underruns            = underruns_.load();
+    stats.xruns                = xruns_.load();
+    stats.overflows            = overflows_.load();
+    stats.played_frames        = played_bytes_.load() / 2;
+    return stats;
+}
+
+void AlsaPcmPlayer::run()
+{
+    std::vector<char> period(period_frames_ * 2);
+    uint64_t read    = read_pos_.load();
+    int idle_periods = 0;
+    const int park_periods = kParkMs / period_ms_;
+
+    while (running_)
+    {
+        if (drop_request_.exchange(false))
+        {
+            snd_pcm_drop(pcm_);
+            applyFlush(read);
+            read_pos_ = read;
+            parked_   = true;
+        }
+
+        if (parked_)
+        {
+            {
+                std::unique_lock<std::mutex> lock(park_mutex_);
+                park_cv_.wait(lock, [&] { return !running_ || drop_request_ || write_pos_.load() != read; });
+            }
+            if (!running_)
+            {
+                break;
+            }
+            if (drop_request_)
+            {
+                continue;
+            }
+
+            parked_ = false;
+            snd_pcm_prepare(pcm_);
+            checkpoints_.clear();
+            device_written_ = 0;
+            ring_played_    = read;
+            starving_       = false;
+            idle_periods    = 0;
+        }
+
+        applyFlush(read);
+        uint64_t write  = write_pos_.load();
+        size_t bytes    = (size_t)(std::min)(write - read, (uint64_t)period.size()) & ~(size_t)1;
+        size_t capacity = ring_.size();
+        size_t index    = (size_t)(read % capacity);
+        size_t first    = (std::min)(bytes, capacity - index);
+        memcpy(period.data(), ring_.data() + index, first);
+        memcpy(period.data() + first, ring_.data(), bytes - first);
+        memset(period.data() + bytes, 0, period.size() - bytes);
+
+        // 一句话还没写完缓冲就空了，补的静音会被听成断档
+        if (bytes < period.size() && stream_open_)
+        {
+            if (!starving_)
+            {
+                starving_ = true;
+                underruns_++;
+                LOG_WARN("ALSA播放器: 欠载，环形缓冲只剩 %zu 字节", bytes);
+            }
+        }
+        else if (bytes == period.size() || !stream_open_)
+        {
+            starving_ = false;
+        }
+
+        Checkpoint checkpoint;
+        checkpoint.ring_pos = read;
+        checkpoint.bytes    = bytes;
+        writePeriod(period.data());
+        checkpoint.device_frame = device_written_;
+        checkpoints_.push_back(checkpoint);
+        device_written_ += period_frames_;
+        read += bytes;
+        read_pos_ = read;
+
+        updatePlayed();
+        fireMarkers();
+
+        if (bytes == 0 && marker_head_.load() == marker_tail_.load() && overflow_end_.load() == 0 &&
+            checkpoints_.size() <= buffer_periods_)
+        {
+            if (++idle_periods > park_periods)
+            {
+                snd_pcm_drop(pcm_);
+                parked_ = true;
+                LOG_DEBUG("ALSA播放器: 空闲，停止设备");
+            }
+        }
+        else
+        {
+            idle_periods = 0;
+        }
+    }
+}
+
+void AlsaPcmPlayer::applyFlush(uint64_t &read)
+{
+    uint64_t flush = flush_to_.load();
+    if (flush <= read)
+    {
+        return;
+    }
+    read = flush;
+
+    // 被清掉的音频不再回调进度和播完
+    size_t head = marker_head_.load();
+    size_t tail = marker_tail_.load();
+    while (head != tail && markers_[head % kMaxMarkers].end <= flush)
+    {
+        head++;
+    }
+    marker_head_ = head;
+    starving_    = false;
+
+    // 写入端可能同时记下新的末块，只清掉被清空范围内的那个
+    uint64_t overflow = overflow_end_.load();
+    if (overflow != 0 && overflow <= flush)
+    {
+        overflow_end_.compare_exchange_strong(overflow, 0);
+    }
+}
+
+void AlsaPcmPlayer::writePeriod(const char *data)
+{
+    const char *cursor      = data;
+    snd_pcm_uframes_t left = period_frames_;
+    while (left > 0 && running_)
+    {
+        snd_pcm_sframes_t written = snd_pcm_writei(pcm_, cursor, left);
+        if (written == -EAGAIN)
+        {
+            continue;
+        }
+        if (written < 0)
+        {
+            if (written == -EPIPE)
+            {
+                // 设备缓冲放空了，之前写入的都已播完，位置从头计
+                xruns_++;
+                for (const Checkpoint &checkpoint : checkpoints_)
+                {
+                    ring_played_ = checkpoint.ring_pos + checkpoint.bytes;
+                    played_bytes_ += checkpoint.bytes;
+                }
+                checkpoints_.clear();
+                device_written_ = 0;
+            }
+            int err = snd_pcm_recover(pcm_, (int)written, 1);
+            if (err < 0)
+            {
+                LOG_ERROR("ALSA播放器: 写设备失败: %s", snd_strerror(err));
+                if (on_error_)
+                {
+                    on_error_(err, snd_strerror(err));
+                }
+                return;
+            }
+            continue;
+        }
+        cursor += written * 2;
+        left -= written;
+    }
+}
+
+void AlsaPcmPlayer::updatePlayed()
+{
+    // 已写入设备的帧减去设备中还没播的帧，就是扬声器实际播到的位置
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(pcm_, &delay) < 0 || delay < 0)
+    {
+        delay = 0;
+    }
+    uint64_t played = device_written_ > (uint64_t)delay ? device_written_ - (uint64_t)delay : 0;
+
+    while (!checkpoints_.empty())
+    {
+        const Checkpoint &checkpoint = checkpoints_.front();
+        if (played >= checkpoint.device_frame + period_frames_)
+        {
+            ring_played_ = checkpoint.ring_pos + checkpoint.bytes;
+            played_bytes_ += checkpoint.bytes;
+            checkpoints_.pop_front();
+            continue;
+        }
+        if (played > checkpoint.device_frame)
+        {
+            ring_played_ = checkpoint.ring_pos + (std::min)(checkpoint.bytes, (size_t)(played - checkpoint.device_frame) * 2);
+        }
+        break;
+    }
+}
+
+void AlsaPcmPlayer::fireMarkers()
+{
+    size_t head = marker_head_.load();
+    size_t tail = marker_tail_.load();
+    while (head != tail)
+    {
+        Marker &marker = markers_[head % kMaxMarkers];
+        if (!marker.started && marker.write_ms != 0 && ring_played_ > marker.start)
+        {
+            marker.started    = true;
+            long long latency = nowMs() - marker.write_ms;
+            plays_++;
+            latency_total_ms_ += latency;
+            long long max = latency_max_ms_.load();
+            while (latency > max && !latency_max_ms_.compare_exchange_weak(max, latency))
+            {
+            }
+            LOG_DEBUG("ALSA播放器: 起播延迟 %lld ms", latency);
+        }
+        if (ring_played_ < marker.end)
+        {
+            break;
+        }
+
+        bool completed = isLastBlock(marker.dts);
+        head++;
+        marker_head_ = head;
+        if (on_progress_)
+        {
+            on_progress_(marker.stream_id, marker.progress, nullptr, (int)(marker.end - marker.start), completed);
+        }
+        if (completed)
+        {
+            Stats stats = getStats();
+            LOG_INFO("ALSA播放器: 播完, 起播延迟平均 %.1f ms 最长 %.1f ms, 欠载 %d 次, xrun %d 次, 累计播出 %.1f 秒", stats.avg_start_latency_ms,
+                     stats.max_start_latency_ms, stats.underruns, stats.xruns, stats.played_frames / (double)sample_rate_);
+        }
+    }
+
+    // 标记数组满时记下的末块，它前面的标记都回调过之后才回调
+    uint64_t overflow = overflow_end_.load();
+    if (overflow != 0 && ring_played_ >= overflow && (head == tail || markers_[head % kMaxMarkers].start >= overflow) &&
+        overflow_end_.compare_exchange_strong(overflow, 0))
+    {
+        if (on_progress_)
+        {
+            on_progress_(overflow_stream_id_.load(), overflow_progress_.load(), nullptr, 0, true);
+        }
+        LOG_INFO("ALSA播放器: 播完");
+    }
+}
+
+void AlsaPcmPlayer::wake()
+{
+    if (parked_)
+    {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        park_cv_.notify_one();
+    }
+}
+
+long long AlsaPcmPlayer::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif    // ROBOT_HAS_ALSA
@@ -0,0 +1,164 @@
+/**
+ * @file alsa_pcm_player.h
+ * @brief 本程序自己的ALSA播放器
+ * @details 写入端把音频放进无锁环形缓冲（单写单读，多个写线程之间用写锁串行），
+ *          播放线程每次从环形缓冲取一个ALSA周期写入设备，数据不够时补静音。
+ *          每块写入都记一个标记（起止位置、dts、进度），播放线程用snd_pcm_delay换算出
+ *          扬声器实际播到的位置，播过一块就回调一次进度，播完最后一块回调isCompleted。
+ *          标记数组满时只放弃中间块的进度回调，末块的播完回调记在单独的位置，不会丢。
+ *          写入、清空、dts语义与aiui_pcm_player_*一致，由PcmOutput按配置选用。
+ */
+#ifndef ALSA_PCM_PLAYER_H
+#define ALSA_PCM_PLAYER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "aiui_capture/aiui/PcmPlayer_C.h"
+
+typedef struct _snd_pcm snd_pcm_t;
+
+class AlsaPcmPlayer
+{
+public:
+    struct Stats
+    {
+        int plays                   = 0;    // 起播次数（首块或单块音频开始出声）
+        double avg_start_latency_ms = 0;    // 首块写入到开始出声的平均耗时
+        double max_start_latency_ms = 0;
+        int underruns               = 0;    // 一句话没播完环形缓冲就空了的次数
+        int xruns                   = 0;    // 设备层面的欠载（EPIPE）次数
+        int overflows               = 0;    // 环形缓冲满而拒绝写入的次数
+        long long played_frames     = 0;    // 实际播出的音频帧数（不含补的静音）
+    };
+
+    /**
+     * @param device ALSA设备名，如"default"、"plughw:0,0"
+     * @param period_ms 每个ALSA周期的时长
+     * @param periods 设备缓冲的周期数，起播延迟约为period_ms * periods
+     * @param ring_seconds 环形缓冲能存的音频时长，合成比播放快，整段应答会先写进来
+     */
+    AlsaPcmPlayer(const std::string &device, int period_ms, int periods, int ring_seconds);
+    ~AlsaPcmPlayer();
+
+    int init(int sample_rate);
+
+    void setCallbacks(pcm_player_onstarted_cb on_started, pcm_player_onstopped_cb on_stopped, pcm_player_onplayprogress_cb on_progress,
+                      pcm_player_onerror_cb on_error);
+
+    int getState() const { return state_; }
+
+    int start();
+
+    /**
+     * @brief 写入音频，参数同aiui_pcm_player_write；首块和单块会清掉之前写入还没播的音频
+     */
+    int write(int stream_id, const char *pcm, int len, int dts, int progress);
+
+    int clear();
+
+    /**
+     * @brief 停止播放，设备中已有的音频一并丢弃
+     */
+    int stop();
+
+    void destroy();
+
+    Stats getStats();
+
+private:
+    // 一块写入的音频，位置按写入的总字节数计
+    struct Marker
+    {
+        uint64_t start      = 0;
+        uint64_t end        = 0;
+        int stream_id       = 0;
+        int dts             = 0;
+        int progress        = 0;
+        long long write_ms  = 0;        // 首块和单块的写入时间，用于统计起播延迟
+        bool started        = false;    // 播放线程已记过起播
+    };
+
+    // 写入设备的一个周期中环形缓冲数据的位置，播放线程据此把设备位置换算回环形缓冲位置
+    struct Checkpoint
+    {
+        uint64_t device_frame = 0;    // 该周期在设备上的起始帧
+        uint64_t ring_pos     = 0;    // 该周期数据在环形缓冲中的起始位置
+        size_t bytes          = 0;    // 该周期中来自环形缓冲的字节数，其余为静音
+    };
+
+    void run();
+    void applyFlush(uint64_t &read);
+    void writePeriod(const char *data);
+    void updatePlayed();
+    void fireMarkers();
+    void wake();
+
+    static long long nowMs();
+
+    static const size_t kMaxMarkers = 1024;
+
+    std::string device_;
+    int period_ms_;
+    int periods_;
+    int ring_seconds_;
+
+    snd_pcm_t *pcm_            = nullptr;
+    int sample_rate_           = 16000;
+    size_t period_frames_      = 0;
+    size_t buffer_periods_     = 0;    // 协商后的设备缓冲能放下的周期数，可能比periods_多
+    std::atomic<int> state_{ PCM_PLAYER_STATE_NOT_INITED };
+
+    pcm_player_onstarted_cb on_started_     = nullptr;
+    pcm_player_onstopped_cb on_stopped_     = nullptr;
+    pcm_player_onplayprogress_cb on_progress_ = nullptr;
+    pcm_player_onerror_cb on_error_         = nullptr;
+
+    // 环形缓冲，位置单调递增，取模得到下标
+    std::vector<char> ring_;
+    std::atomic<uint64_t> write_pos_{ 0 };
+    std::atomic<uint64_t> read_pos_{ 0 };
+    std::atomic<uint64_t> flush_to_{ 0 };     // 在此之前写入的音频都不再播放
+    std::atomic<bool> stream_open_{ false };  // 已写首块、还没写末块，期间缓冲变空算欠载
+
+    Marker markers_[kMaxMarkers];
+    std::atomic<size_t> marker_head_{ 0 };    // 播放线程读
+    std::atomic<size_t> marker_tail_{ 0 };    // 写入端写
+
+    // 标记数组满时的末块：播到overflow_end_回调播完，为0表示没有
+    std::atomic<uint64_t> overflow_end_{ 0 };
+    std::atomic<int> overflow_stream_id_{ 0 };
+    std::atomic<int> overflow_progress_{ 0 };
+
+    std::mutex write_mutex_;    // 多个写线程之间串行，播放线程不取这把锁
+
+    // 播放线程空闲时停掉设备睡眠，写入或退出时唤醒；只用于休眠，不在数据通路上
+    std::thread thread_;
+    std::atomic<bool> running_{ false };
+    std::atomic<bool> parked_{ true };
+    std::atomic<bool> drop_request_{ false };
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+
+    // 以下只由播放线程访问
+    uint64_t device_written_ = 0;
+    uint64_t ring_played_    = 0;
+    std::deque<Checkpoint> checkpoints_;
+    bool starving_ = false;
+
+    std::atomic<int> plays_{ 0 };
+    std::atomic<int> underruns_{ 0 };
+    std::atomic<int> xruns_{ 0 };
+    std::atomic<int> overflows_{ 0 };
+    std::atomic<long long> played_bytes_{ 0 };
+    std::atomic<long long> latency_total_ms_{ 0 };
+    std::atomic<long long> latency_max_ms_{ 0 };
+};
+
+#endif    // ALSA_PCM_PLAYER_H
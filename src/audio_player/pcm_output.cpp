@@ -0,0 +1,104 @@
+#include "audio_player/pcm_output.h"
+
+#include "audio_player/alsa_pcm_player.h"
+#include "utils/AppConfig.h"
+#include "utils/Logger.hpp"
+
+PcmOutput &PcmOutput::getInstance()
+{
+    static PcmOutput instance;
+    return instance;
+}
+
+PcmOutput::PcmOutput() = default;
+
+PcmOutput::~PcmOutput() = default;
+
+int PcmOutput::create()
+{
+    const AppConfig::PlayerConfig &cfg = AppConfig::getInstance().player;
+    if (cfg.backend == "alsa")
+    {
+#ifdef ROBOT_HAS_ALSA
+        alsa_.reset(new AlsaPcmPlayer(cfg.device, cfg.period_ms, cfg.periods, cfg.ring_seconds));
+        LOG_INFO("使用ALSA播放器, 设备 %s", cfg.device.c_str());
+        return 0;
+#else
+        LOG_ERROR("编译时没有ALSA开发包，播放后端alsa不可用，改用AIUI内置播放器");
+#endif
+    }
+    return aiui_pcm_player_create();
+}
+
+int PcmOutput::getOutputDeviceCount()
+{
+    return alsa_ ? 1 : aiui_pcm_player_get_output_device_count();
+}
+
+const char *PcmOutput::getDeviceName(int index)
+{
+    if (alsa_)
+    {
+        return AppConfig::getInstance().player.device.c_str();
+    }
+    return aiui_pcm_player_get_device_name(index);
+}
+
+int PcmOutput::init(int dev_index, int sample_rate)
+{
+    return alsa_ ? alsa_->init(sample_rate) : aiui_pcm_player_init(dev_index, sample_rate);
+}
+
+void PcmOutput::setCallbacks(pcm_player_onstarted_cb on_started, pcm_player_onpaused_cb on_paused, pcm_player_onresumed_cb on_resumed,
+                             pcm_player_onstopped_cb on_stopped, pcm_player_onplayprogress_cb on_progress, pcm_player_onerror_cb on_error)
+{
+    if (alsa_)
+    {
+        alsa_->setCallbacks(on_started, on_stopped, on_progress, on_error);
+        return;
+    }
+    aiui_pcm_player_set_callbacks(on_started, on_paused, on_resumed, on_stopped, on_progress, on_error);
+}
+
+int PcmOutput::getState()
+{
+    return alsa_ ? alsa_->getState() : aiui_pcm_player_get_state();
+}
+
+int PcmOutput::start()
+{
+    if (on_begin_ != nullptr)
+    {
+        on_begin_();
+    }
+    return alsa_ ? alsa_->start() : aiui_pcm_player_start();
+}
+
+int PcmOutput::write(int stream_id, const char *pcm, int len, int dts, int progress)
+{
+    if (on_begin_ != nullptr && (dts == PCM_PLAYER_DTS_BLOCK_FIRST || dts == PCM_PLAYER_DTS_ONE_BLOCK))
+    {
+        on_begin_();
+    }
+    return alsa_ ? alsa_->write(stream_id, pcm, len, dts, progress) : aiui_pcm_player_write(stream_id, pcm, len, dts, progress);
+}
+
+int PcmOutput::clear()
+{
+    return alsa_ ? alsa_->clear() : aiui_pcm_player_clear();
+}
+
+int PcmOutput::stop()
+{
+    return alsa_ ? alsa_->stop() : aiui_pcm_player_stop();
+}
+
+void PcmOutput::destroy()
+{
+    if (alsa_)
+    {
+        alsa_->destroy();
+        return;
+    }
+    aiui_pcm_player_destroy();
+}
@@ -0,0 +1,72 @@
+/**
+ * @file pcm_output.h
+ * @brief 播放器入口，按robot.cfg的player.backend选用AIUI内置播放器或本程序的ALSA播放器
+ * @details 接口与aiui_pcm_player_*一一对应，调用方只换函数名，dts、进度和回调语义不变。
+ *          后端在create()时选定，之后不再切换。没有ALSA开发包编译时只有AIUI后端。
+ */
+#ifndef PCM_OUTPUT_H
+#define PCM_OUTPUT_H
+
+#include <memory>
+
+#include "aiui_capture/aiui/PcmPlayer_C.h"
+
+class AlsaPcmPlayer;
+
+typedef void (*pcm_output_onbegin_cb)();
+
+class PcmOutput
+{
+public:
+    static PcmOutput &getInstance();
+
+    /**
+     * @brief 按配置创建播放器
+     * @return 成功返回0
+     */
+    int create();
+
+    int getOutputDeviceCount();
+
+    const char *getDeviceName(int index);
+
+    /**
+     * @param dev_index AIUI后端的设备索引，ALSA后端用配置中的设备名
+     */
+    int init(int dev_index = -1, int sample_rate = 16000);
+
+    /**
+     * @brief 设置回调；ALSA后端没有暂停/恢复，对应回调不会触发
+     */
+    void setCallbacks(pcm_player_onstarted_cb on_started, pcm_player_onpaused_cb on_paused, pcm_player_onresumed_cb on_resumed,
+                      pcm_player_onstopped_cb on_stopped, pcm_player_onplayprogress_cb on_progress, pcm_player_onerror_cb on_error);
+
+    /**
+     * @brief 新一段播放开始时回调：start()或写入首块（dts为BLOCK_FIRST或ONE_BLOCK），在调用线程中、交给播放器之前执行
+     * @details 播放器回调是异步的，stop()之前已排队的进度回调可能在stop()之后才到，调用方据此区分新旧两段播放
+     */
+    void setOnBegin(pcm_output_onbegin_cb on_begin) { on_begin_ = on_begin; }
+
+    int getState();
+
+    int start();
+
+    int write(int stream_id, const char *pcm, int len, int dts, int progress);
+
+    int clear();
+
+    int stop();
+
+    void destroy();
+
+    bool isAlsa() const { return alsa_ != nullptr; }
+
+private:
+    PcmOutput();
+    ~PcmOutput();
+
+    std::unique_ptr<AlsaPcmPlayer> alsa_;
+    pcm_output_onbegin_cb on_begin_ = nullptr;
+};
+
+#endif    // PCM_OUTPUT_H
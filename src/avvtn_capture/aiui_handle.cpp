@@ -1,7 +1,62 @@
 #include "avvtn_capture.h"
 #include "utils/Logger.hpp"
 #include "ros2/ros_manager.hpp"
-#include "utils/json.hpp"
+#include "utils/AppConfig.h"
+#include "utils/TtsCache.h"
+
+#include <chrono>
+#include <cstring>
+
+/**
+ * @brief 取字符串节点的内容，非字符串返回""，避免asString()拷贝出临时std::string
+ */
+static const char *jsonCString(const Json::Value &value)
+{
+    return value.isString() ? value.asCString() : "";
+}
+
+namespace
+{
+
+long long steadyNowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief 单个AIUI结果事件的JSON内存作用域
+ * @details 作用域内jsoncpp的节点和字符串都从线程arena中分配，事件处理完整体回收；
+ *          析构时打印本次事件以及累计的分配次数。必须先于该事件的Json::Value定义。
+ */
+class AiuiEventArena
+{
+public:
+    AiuiEventArena() = default;
+
+    ~AiuiEventArena()
+    {
+        Json::ValueArena::Stats stats = scope_.stats();
+        total_arena_ += stats.arenaAllocations;
+        total_heap_ += stats.heapAllocations;
+        ++total_events_;
+        LOG_DEBUG("JSON分配: 本次arena %zu 次(%zu 字节), 堆 %zu 次; 累计 %zu 个事件, arena %zu 次, 堆 %zu 次",
+                  stats.arenaAllocations, stats.arenaBytes, stats.heapAllocations,
+                  total_events_, total_arena_, total_heap_);
+    }
+
+private:
+    Json::ValueArena::Scope scope_;
+
+    static thread_local size_t total_events_;
+    static thread_local size_t total_arena_;
+    static thread_local size_t total_heap_;
+};
+
+thread_local size_t AiuiEventArena::total_events_ = 0;
+thread_local size_t AiuiEventArena::total_arena_  = 0;
+thread_local size_t AiuiEventArena::total_heap_   = 0;
+
+}    // namespace
 
 void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
 {
@@ -17,16 +72,15 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
                 switch (event.getArg1())
                 {
                     case AIUIConstant::STATE_IDLE: 
-                        std::cout << "EVENT_STATE: STATE_IDLE" << std::endl;
                         LOG_INFO("AIUI当前状态: IDLE");
                         break;
                     case AIUIConstant::STATE_READY:
-                        std::cout << "EVENT_STATE: STATE_READY" << std::endl;
                         LOG_INFO("AIUI当前状态: READY");
+                        self->aiui_wrapper_.PrewarmTtsCache();
                         break;
                     case AIUIConstant::STATE_WORKING:
-                        std::cout << "EVENT_STATE: STATE_WORKING" << std::endl;
                         LOG_INFO("AIUI当前状态: WORKING");
+                        self->aiui_wrapper_.PrewarmTtsCache();
                         break;
                 }
             }
@@ -35,37 +89,28 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
             // 唤醒事件
             case AIUIConstant::EVENT_WAKEUP:
             {
-                self->is_sleeping = false;
-                ROSManager::getInstance().publishStatus("STATUS_WAITING_CONVERSATION");
+                self->conversation_.onWakeup();
                 LOG_INFO("接收到AIUI唤醒事件EVENT_WAKEUP: %s", event.getInfo());
                 LOG_INFO("pcm播放器停止播放");
-                std::cout << "EVENT_WAKEUP: " << event.getInfo() << std::endl;
-                aiui_pcm_player_stop();
+                PcmOutput::getInstance().stop();
+                self->conversation_.onPlaybackStopped();
 
-                /*播放相应唤醒词*/
-                self->aiui_wrapper_.StartTTS("你好");
+                /*播放相应唤醒词，重新唤醒时之前排队和正在播的话都不再需要*/
+                self->aiui_wrapper_.speech_queue_.cancelAll();
+                self->aiui_wrapper_.speech_queue_.speak("你好", SpeechQueue::PRIORITY_GREETING);
 
                 /*发送ROS2话题robot_avvtn_chat_history  答*/
-                nlohmann::json answer = {
-                        {"speaker", "robot"},
-                        {"text", "你好"},
-                        {"is_skill", "0"},
-                        {"is_knowledge", "0"}
-                };
-                ROSManager::getInstance().publishChatHistoryNoStream(answer.dump());
+                std::string answer;
+                JsonWriter(answer).StartObject().Key("is_knowledge").String("0").Key("is_skill").String("0").Key("speaker").String("robot").Key("text").String("你好").EndObject();
+                ROSManager::getInstance().publishChatHistoryNoStream(answer);
             }
             break;
 
             // 休眠事件
             case AIUIConstant::EVENT_SLEEP:
             {
-                self->is_sleeping = true;
-                if (self->is_playing == false)
-                {
-                    ROSManager::getInstance().publishStatus("STATUS_WAITING_WAKEUP");
-                }
+                self->conversation_.onSleep();
                 LOG_INFO("接收到AIUI休眠事件EVENT_SLEEP: arg1 = %d", event.getArg1());
-                std::cout << "EVENT_SLEEP: arg1=" << event.getArg1() << std::endl;
             }
             break;
 
@@ -76,16 +121,18 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
                 switch (event.getArg1())
                 {
                     case AIUIConstant::VAD_BOS_TIMEOUT:
-                        std::cout << "EVENT_VAD: VAD_BOS_TIMEOUT" << std::endl;
                         LOG_DEBUG("EVENT_VAD: VAD_BOS_TIMEOUT");
+                        self->conversation_.onUserSpeechEnd();
                         break;
                     case AIUIConstant::VAD_BOS:
-                        std::cout << "EVENT_VAD: BOS" << std::endl;
                         LOG_DEBUG("EVENT_VAD: BOS");
+                        self->conversation_.onUserSpeechStart();
+                        self->bargeIn("aiui_bos");
+                        self->applyBargeIn();
                         break;
                     case AIUIConstant::VAD_EOS:
-                        std::cout << "EVENT_VAD: EOS" << std::endl;
                         LOG_DEBUG("EVENT_VAD: EOS");
+                        self->conversation_.onUserSpeechEnd();
                         break;
                     case AIUIConstant::VAD_VOL:
                         //LOG_DEBUG("EVENT_VAD: vol = %d", event.getArg2());
@@ -98,47 +145,49 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
             // 结果事件
             case AIUIConstant::EVENT_RESULT:
             {
+                // 引擎线程触发的打断在处理下一个结果前完成清理，旧的合成音频不会再写进播放器
+                self->applyBargeIn();
+
+                AiuiEventArena arena;
+                static thread_local Json::Reader reader;
                 Json::Value bizParamJson;
-                Json::Reader reader;
-                if (!reader.parse(event.getInfo(), bizParamJson, false))
+                const char *info = event.getInfo();
+                if (!reader.parse(info, info + strlen(info), bizParamJson, false))
                 {
                     LOG_ERROR("parse error! info = %s", event.getInfo());
-                    std::cout << "parse error! info=" << event.getInfo() << std::endl;
                     break;
                 }
                 Json::Value &data    = (bizParamJson["data"])[0];
                 Json::Value &params  = data["params"];
                 Json::Value &content = (data["content"])[0];
 
-                std::string sub = params["sub"].asString();
+                const char *sub = jsonCString(params["sub"]);
                 std::string sid = event.getData()->getString("sid", "");
 
-                if (sub == "iat")
+                if (strcmp(sub, "iat") == 0)
                 {
                     if (sid != self->current_iat_sid_)
                     {
                         LOG_DEBUG("iat**********************************");
                         LOG_DEBUG("sid = %s", sid.c_str());
-                        std::cout << "iat**********************************" << std::endl;
-                        std::cout << "sid=" << sid << std::endl;
                         self->current_iat_sid_ = sid;
 
                         LOG_DEBUG("新的会话，清空之前识别缓存，并且停止播放");
                         // 新的会话，清空之前识别缓存，并且停止播放
-                        self->iat_text_buffer_.clear();
                         self->stream_nlp_answer_buffer_.clear();
                         self->aiui_wrapper_.listener_->tts_helper_ptr_->clear();
+                        self->aiui_wrapper_.speech_queue_.newTurn(sid);
                         self->intent_cnt_ = 0;
+                        self->first_nlp_token_ms_ = 0;
+                        self->first_audio_reported_ = false;
                     }
                 }
-                else if (sub == "tts")
+                else if (strcmp(sub, "tts") == 0)
                 {
                     if (sid != self->current_tts_sid_)
                     {
                         LOG_DEBUG("tts**********************************");
                         LOG_DEBUG("sid = %s", sid.c_str());
-                        std::cout << "tts**********************************" << std::endl;
-                        std::cout << "sid=" << sid << std::endl;
                         self->tts_len_         = 0;
                         self->current_tts_sid_ = sid;
                     }
@@ -149,22 +198,21 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
                 // 注意：当buffer里存字符串时也不是以0结尾，当使用C语言时，转成字符串则需要自已在末尾加0
                 const char *buffer = event.getData()->getBinary(cnt_id.c_str(), &dataLen);
 
-                std::string resultStr = std::string(buffer, dataLen);
-                if (sub != "tts")
+                if (strcmp(sub, "tts") != 0)
                 {
-                    LOG_DEBUG("JSON原始数据: %s", resultStr.c_str());
+                    LOG_DEBUG("JSON原始数据: %.*s", dataLen, buffer);
                 }
                 // 当前仅解析iat tts nlp
-                if (sub == "iat")
+                if (strcmp(sub, "iat") == 0)
                 {
                     LOG_DEBUG("接收到AIUI返回的语音识别结果iat");
                     LOG_DEBUG("%s: ", event.getInfo());
 
-                    self->handleAiuiIat(reader, buffer, dataLen);
+                    self->handleAiuiIat(reader, sid, buffer, dataLen);
                     self->is_skill = false;
                     self->is_knowledge = false;
                 }
-                else if (sub == "tts")
+                else if (strcmp(sub, "tts") == 0)
                 {
                     LOG_DEBUG("接收到AIUI返回的语音合成结果tts");
                     if (sid == self->ignore_tts_sid_)
@@ -172,56 +220,74 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
                         LOG_INFO("ignore current tts");
                         break;
                     }
-                    ROSManager::getInstance().publishStatus("STATUS_IN_CONVERSATION");
-                    self->handleAiuiTts(reader, content, event, bizParamJson, buffer, dataLen);
+                    std::string tag = event.getData()->getString("tag", "");
+                    if (!tag.empty() && !TtsCache::getInstance().onTtsData(tag, buffer, dataLen, content["dts"].asInt()))
+                    {
+                        // 预热的合成只录入缓存不播放，录完一句接着预热下一句
+                        self->aiui_wrapper_.PrewarmTtsCache();
+                        break;
+                    }
+                    if (tag.empty() && AppConfig::getInstance().tts.client_stream && sid == self->current_iat_sid_)
+                    {
+                        // 本地分段合成时，平台的语义后合成与之重复，不播放
+                        LOG_DEBUG("忽略语义后合成的音频");
+                        break;
+                    }
+                    if (!self->aiui_wrapper_.speech_queue_.admitTts(tag, sid, dataLen))
+                    {
+                        // 被抢占或属于已作废轮次的合成，晚到的音频不再写入播放器
+                        LOG_DEBUG("播报队列: 丢弃合成音频, tag = %s, sid = %s", tag.c_str(), sid.c_str());
+                        break;
+                    }
+                    self->handleAiuiTts(content, event, bizParamJson, buffer, dataLen);
                 }
-                else if (sub == "nlp")
+                else if (strcmp(sub, "nlp") == 0)
                 {
                     LOG_DEBUG("接收到AIUI返回的语义理解结果nlp");
                     LOG_DEBUG("%s: ", event.getInfo());
-                    LOG_DEBUG("%s", resultStr.c_str());
+                    LOG_DEBUG("%.*s", dataLen, buffer);
 
                     self->handleAiuiStreamNlp(reader, buffer, dataLen);
                 }
-                else if (sub == "event")
+                else if (strcmp(sub, "event") == 0)
                 {
                     //服务事件
                     LOG_DEBUG("接收到AIUI返回的【服务事件event】");
                 }
-                else if (sub == "cbm_tidy")
+                else if (strcmp(sub, "cbm_tidy") == 0)
                 {
-                    self->handleCbmTidy(resultStr);
+                    self->handleCbmTidy(std::string(buffer, dataLen));
                 }
-                else if (sub == "cbm_semantic")
+                else if (strcmp(sub, "cbm_semantic") == 0)
                 {
-                    self->handleCbmSemantic(resultStr);
+                    self->handleCbmSemantic(std::string(buffer, dataLen));
                 }
-                else if (sub == "cbm_tool_pk")
+                else if (strcmp(sub, "cbm_tool_pk") == 0)
                 {
-                    self->handleCbmToolPk(resultStr);
+                    self->handleCbmToolPk(std::string(buffer, dataLen));
                 }
-                else if (sub == "cbm_retrieval_classify")
+                else if (strcmp(sub, "cbm_retrieval_classify") == 0)
                 {
-                    self->handleCbmRetrievalClassify(resultStr);
+                    self->handleCbmRetrievalClassify(std::string(buffer, dataLen));
                 }
-                else if (sub == "cbm_plugin")
+                else if (strcmp(sub, "cbm_plugin") == 0)
                 {
                     //智能体
                     LOG_INFO("接收到AIUI返回的【智能体cbm_plugin】");
                 }
-                else if (sub == "cbm_knowledge")
+                else if (strcmp(sub, "cbm_knowledge") == 0)
                 {
-                    self->handleCbmKnowledge(resultStr);
+                    self->handleCbmKnowledge(std::string(buffer, dataLen));
                 }
                 else
                 {
                     // 其他结果
                     //std::cout << sub << ": " << event.getInfo() << std::endl;
-                    //std::cout << resultStr << std::endl;
+                    //std::cout << std::string(buffer, dataLen) << std::endl;
                     
                     //LOG_INFO("除iat,tts,nlp外的其他返回数据:");
                     //LOG_INFO("%s: ", event.getInfo());
-                    //LOG_INFO("%s", resultStr.c_str());
+                    //LOG_INFO("%.*s", dataLen, buffer);
                 }
             }
             break;
@@ -245,11 +311,11 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
                     if (AIUIConstant::SUCCESS == retCode)
                     {
                         std::string sid = event.getData()->getString("sid", "");
-                        std::cout << "数据同步成功, sid=" << sid << std::endl;
+                        LOG_INFO("数据同步成功, sid = %s", sid.c_str());
                     }
                     else
                     {
-                        std::cout << "数据同步失败, 错误码=" << retCode << std::endl;
+                        LOG_ERROR("数据同步失败, 错误码 = %d", retCode);
                     }
                 }
             }
@@ -259,7 +325,6 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
             case AIUIConstant::EVENT_START_RECORD:
             {
                 LOG_INFO("AIUI已开始录音");
-                std::cout << "EVENT_START_RECORD" << std::endl;
             }
             break;
 
@@ -267,7 +332,6 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
             case AIUIConstant::EVENT_STOP_RECORD:
             {
                 LOG_INFO("AIUI已停止录音");
-                std::cout << "EVENT_STOP_RECORD" << std::endl;
             }
             break;
 
@@ -276,7 +340,6 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
             {
                 std::ostringstream oss;
                 LOG_ERROR("AIUI出错EVENT_ERROR: error = %d, des = %s", event.getArg1(), event.getInfo());
-                std::cout << "EVENT_ERROR: error=" << event.getArg1() << ", des=" << event.getInfo() << std::endl;
             }
             break;
 
@@ -284,7 +347,6 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
             case AIUIConstant::EVENT_CONNECTED_TO_SERVER:
             {
                 std::string uid = event.getData()->getString("uid", "");
-                std::cout << "EVENT_CONNECTED_TO_SERVER, uid=" << uid << std::endl;
                 LOG_INFO("已连接到服务器, uid = %s", uid.c_str());
             }
             break;
@@ -293,7 +355,6 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
             case AIUIConstant::EVENT_SERVER_DISCONNECTED:
             {
                 LOG_INFO("与AIUI服务器断开");
-                std::cout << "EVENT_SERVER_DISCONNECTED" << std::endl;
             }
             break;
 
@@ -303,56 +364,64 @@ void AvvtnCapture::aiuiCallback(void *user_data, const IAIUIEvent &event)
     }
     catch (std::exception &e)
     {
-        std::cout << "Exception in callback: " << e.what() << std::endl;
         LOG_ERROR("Exception in callback: %s", e.what());
     }
     return;
 }
 
-void AvvtnCapture::handleAiuiIat(Json::Reader &reader, const char *buffer, int len)
+void AvvtnCapture::handleAiuiIat(Json::Reader &reader, const std::string &sid, const char *buffer, int len)
 {
-    // 语音识别结果
-    std::string resultStr = std::string(buffer, len);    // 注意：这里不能用string resultStr = buffer，因为buffer不一定以0结尾
+    // 语音识别结果，注意：buffer不一定以0结尾，按长度解析
     Json::Value resultJson;
-    if (reader.parse(resultStr, resultJson, false))
+    if (reader.parse(buffer, buffer + len, resultJson, false))
     {
-        Json::Value textJson = resultJson["text"];
-        bool isWpgs          = false;
-        if (textJson.isMember("pgs"))
-        {
-            isWpgs = true;
-        }
+        const Json::Value &textJson = resultJson["text"];
 
-        if (isWpgs)
-        {
-            iat_text_buffer_ = IatResultUtil::parsePgsIatText(textJson);
-        }
-        else
+        // 按sid拼装，wpgs的rpl修正增量应用
+        IatPgsAssembler &assembler = iat_sessions_.get(sid);
+        bool isLast                = assembler.apply(textJson);
+        LOG_DEBUG("IAT中间结果: 稳定 %zu 字节, 全文 %s", assembler.stableLength(), assembler.text().c_str());
+
+        // 旧会话迟到的结果不再刷新字幕，最终结果照常走chat_history
+        if (sid == current_iat_sid_)
         {
-            // 结果拼接起来
-            iat_text_buffer_.append(IatResultUtil::parseIatResult(textJson));
+            partial_transcript_.update(sid, assembler.text(), assembler.stableLength(), isLast);
+            if (!isLast)
+            {
+                endpointer_.setTranscript(assembler.text(), assembler.stableLength());
+            }
+
+            // 停止类指令不等云端语义，命中就执行，技能结果到达后再对账
+            std::string phrase;
+            int actions = early_command_.onPartial(sid, assembler.text(), assembler.stableLength(), &phrase);
+            if (actions != EarlyCommand::ACTION_NONE)
+            {
+                runEarlyCommand(actions, phrase);
+            }
         }
 
         // 是否是该次会话最后一个识别结果
-        bool isLast = textJson["ls"].asBool();
         if (isLast)
         {
+            const std::string &iat_text = assembler.text();
             /*发送ROS2话题robot_avvtn_chat_history  问*/
-            nlohmann::json ask = {
-                    {"speaker", "person"},
-                    {"text", iat_text_buffer_}
-            };
-            ROSManager::getInstance().publishChatHistory(ask.dump());
-            ROSManager::getInstance().publishChatHistoryNoStream(ask.dump());
-
-            LOG_INFO("IAT语音识别结果: %s", iat_text_buffer_.c_str());
-            std::cout << "iat: " << iat_text_buffer_ << std::endl;
-            iat_text_buffer_.clear();
+            static thread_local std::string ask;
+            ask.clear();
+            JsonWriter(ask).StartObject().Key("speaker").String("person").Key("text").String(iat_text).EndObject();
+            ROSManager::getInstance().publishChatHistory(ask);
+            ROSManager::getInstance().publishChatHistoryNoStream(ask);
+
+            LOG_INFO("IAT语音识别结果: %s", iat_text.c_str());
+            if (assembler.stableRewrites() > 0)
+            {
+                LOG_DEBUG("IAT修正落进稳定前缀 %d 次", assembler.stableRewrites());
+            }
+            iat_sessions_.release(sid);
         }
     }
 }
 
-void AvvtnCapture::handleAiuiTts(const Json::Reader &reader, const Json::Value content, const IAIUIEvent event, Json::Value bizParamJson, const char *buffer, int len)
+void AvvtnCapture::handleAiuiTts(const Json::Value &content, const IAIUIEvent &event, Json::Value &bizParamJson, const char *buffer, int len)
 {
     Json::Value empty;
     // 语音合成结果，返回url或者pcm音频
@@ -360,7 +429,6 @@ void AvvtnCapture::handleAiuiTts(const Json::Reader &reader, const Json::Value c
     if (isUrl.asString() == "1")
     {
         // 云端返回的是url链接，可以用播放器播放
-        std::cout << "tts_url=" << std::string(buffer, len) << std::endl;
         LOG_DEBUG("云端返回的是url链接 tts_url = %s", std::string(buffer, len).c_str());
     }
     else
@@ -383,15 +451,20 @@ void AvvtnCapture::handleAiuiTts(const Json::Reader &reader, const Json::Value c
             if (dts == AIUIConstant::DTS_BLOCK_FIRST || dts == AIUIConstant::DTS_ONE_BLOCK || (dts == AIUIConstant::DTS_BLOCK_LAST && 0 == tts_len_))
             {
 
-                if (aiui_pcm_player_get_state() != PCM_PLAYER_STATE_STARTED)
+                if (PcmOutput::getInstance().getState() != PCM_PLAYER_STATE_STARTED)
                 {
                     LOG_DEBUG("开启PCM播放器");
-                    int ret = aiui_pcm_player_start();
+                    int ret = PcmOutput::getInstance().start();
                 }
             }
 
             tts_len_ += len;
-            aiui_pcm_player_write(0, buffer, len, dts, progress);
+            PcmOutput::getInstance().write(0, buffer, len, dts, progress);
+        }
+
+        if (len > 0)
+        {
+            reportFirstAudioLatency();
         }
         // 若要保存合成音频，请打开以下开关
 #if 1
@@ -410,20 +483,34 @@ void AvvtnCapture::handleAiuiTts(const Json::Reader &reader, const Json::Value c
     }
 }
 
+void AvvtnCapture::reportFirstAudioLatency()
+{
+    if (first_audio_reported_ || first_nlp_token_ms_ == 0)
+    {
+        return;
+    }
+    first_audio_reported_ = true;
+
+    // 以音频写入播放器的时刻近似首个可听到的采样，不含声卡缓冲
+    long long latency = steadyNowMs() - first_nlp_token_ms_;
+    first_audio_latency_total_ms_ += latency;
+    first_audio_latency_count_++;
+    LOG_INFO("首个NLP token到首包音频: %lld ms（平均 %lld ms，共 %d 轮）",
+             latency, first_audio_latency_total_ms_ / first_audio_latency_count_, first_audio_latency_count_);
+}
+
 void AvvtnCapture::handleAiuiStreamNlp(Json::Reader &reader, const char *buffer, int len)
 {
     // 语义理解结果
-    std::string resultStr = std::string(buffer, len);
-
     Json::Value resultJson;
-    if (reader.parse(resultStr, resultJson, false))
+    if (reader.parse(buffer, buffer + len, resultJson, false))
     {
 
         if (resultJson.isMember("nlp"))
         {
             // AIUI v2的语义结果
-            Json::Value nlpJson = resultJson["nlp"];
-            std::string text    = nlpJson["text"].asString();
+            const Json::Value &nlpJson = resultJson["nlp"];
+            const char *text           = jsonCString(nlpJson["text"]);
 
             // 大模型语义结果
             // 流式nlp结果里面有seq和status字段
@@ -432,6 +519,10 @@ void AvvtnCapture::handleAiuiStreamNlp(Json::Reader &reader, const char *buffer,
 
             if (status == 0)
             {
+                if (first_nlp_token_ms_ == 0)
+                {
+                    first_nlp_token_ms_ = steadyNowMs();
+                }
                 stream_nlp_index_ = 0;
                 // 开始新的流式响应
                 stream_nlp_answer_buffer_.clear();
@@ -449,43 +540,37 @@ void AvvtnCapture::handleAiuiStreamNlp(Json::Reader &reader, const char *buffer,
             {
                 int currentIntentIndex = 0;
                 Json::Value metaNlpJson;
-                Json::Value textJson = resultJson["cbm_meta"].get("text", metaNlpJson);
-                if (reader.parse(textJson.asString(), metaNlpJson, false))
+                const char *metaText = jsonCString(resultJson["cbm_meta"]["text"]);
+                if (reader.parse(metaText, metaText + strlen(metaText), metaNlpJson, false))
                 {
                     currentIntentIndex = metaNlpJson["nlp"]["intent"].asInt();
                     if ((intent_cnt_ - 1) != currentIntentIndex)
                     {
-                        LOG_INFO("ignore nlp: %s", resultStr.c_str());
-                        std::cout << "ignore nlp:" << resultStr << std::endl;
+                        LOG_INFO("ignore nlp: %.*s", len, buffer);
                         return;
                     }
                 }
                 else
                 {
-                    LOG_INFO("ignore nlp: %s", resultStr.c_str());
-                    std::cout << "ignore nlp:" << resultStr << std::endl;
+                    LOG_INFO("ignore nlp: %.*s", len, buffer);
                     return;
                 }
             }
 
-#ifndef USE_POST_SEMANTIC_TTS
-            LOG_INFO("未使用应用的语义合成");
-            // 如果使用应用的语义后合成不需要在调用下面的函数否则tts的播报会重复
-            aiui_wrapper_.listener_->tts_helper_ptr_->addText(text, stream_nlp_index_++, status);
-#endif
+            // 使用应用的语义后合成时不能再送这里合成，否则tts的播报会重复；技能已经接管播报时也不送
+            if (AppConfig::getInstance().tts.client_stream && ignore_tts_sid_ != current_iat_sid_ && interrupted_iat_sid_ != current_iat_sid_)
+            {
+                aiui_wrapper_.listener_->tts_helper_ptr_->addText(text, stream_nlp_index_++, status);
+            }
 
-            LOG_INFO("大模型返回nlp语义结果: seq = %d, status = %d, answer（应答语）: %s", seq, status, text.c_str());
-            std::cout << "seq=" << seq << ", status=" << status << ", answer（应答语）: " << text << std::endl;
+            LOG_INFO("大模型返回nlp语义结果: seq = %d, status = %d, answer（应答语）: %s", seq, status, text);
             // 技能返回语音文本时不显示大模型回复的文本
             if (ignore_tts_sid_ != current_iat_sid_)
             {
-                nlohmann::json nlp_answer = {
-                        {"seq", std::to_string(seq)},
-                        {"status", std::to_string(status)},
-                        {"speaker", "robot"},
-                        {"text", text}
-                };
-                ROSManager::getInstance().publishChatHistory(nlp_answer.dump());
+                static thread_local std::string nlp_answer;
+                nlp_answer.clear();
+                JsonWriter(nlp_answer).StartObject().Key("seq").String(std::to_string(seq)).Key("speaker").String("robot").Key("status").String(std::to_string(status)).Key("text").String(text).EndObject();
+                ROSManager::getInstance().publishChatHistory(nlp_answer);
             }
 
             if (status == 2)
@@ -497,13 +582,9 @@ void AvvtnCapture::handleAiuiStreamNlp(Json::Reader &reader, const char *buffer,
                 if (ignore_tts_sid_ != current_iat_sid_)
                 {
                     /*发送ROS2话题robot_avvtn_chat_history  答*/
-                    nlohmann::json answer = {
-                            {"speaker", "robot"},
-                            {"text", stream_nlp_answer_buffer_},
-                            {"is_skill", std::to_string(is_skill)},
-                            {"is_knowledge", std::to_string(is_knowledge)}
-                    };
-                    ROSManager::getInstance().publishChatHistoryNoStream(answer.dump());
+                    std::string answer;
+                    JsonWriter(answer).StartObject().Key("is_knowledge").String(std::to_string(is_knowledge)).Key("is_skill").String(std::to_string(is_skill)).Key("speaker").String("robot").Key("text").String(stream_nlp_answer_buffer_).EndObject();
+                    ROSManager::getInstance().publishChatHistoryNoStream(answer);
                 }
 
                 stream_nlp_answer_buffer_.clear();
@@ -513,65 +594,78 @@ void AvvtnCapture::handleAiuiStreamNlp(Json::Reader &reader, const char *buffer,
         {
             LOG_INFO("无效nlp结果");
             LOG_INFO("----------------------------------");
-            LOG_INFO("nlp: %s", resultStr.c_str());
+            LOG_INFO("nlp: %.*s", len, buffer);
             // 无效结果，把原始结果打印出来
-            std::cout << "----------------------------------" << std::endl;
-            std::cout << "nlp: " << resultStr << std::endl;
         }
     }
 }
 
+/**
+ * @brief 解析 {"<sub>":{"text":"<json字符串>"}} 形式的cbm结果
+ * @param resultStr 原始结果
+ * @param sub 结果类型，如cbm_tidy
+ * @param outer 外层文档
+ * @param inner 内层text的文档
+ * @return 内层text解析后的根节点，失败返回nullptr（已打印原因）
+ */
+static const JsonNode *parseCbmText(const std::string &resultStr, const char *sub, JsonDocument &outer, JsonDocument &inner)
+{
+    if (!outer.Parse(resultStr))
+    {
+        LOG_ERROR("解析JSON字符串失败: %s, resultStr: %s", outer.ErrorMessage(), resultStr.c_str());
+        return nullptr;
+    }
+
+    const JsonNode &cbm = outer[sub];
+    if (!cbm.isObject())
+    {
+        LOG_WARN("JSON中缺少%s字段或%s不是对象类型", sub, sub);
+        return nullptr;
+    }
+
+    const JsonNode &text = cbm["text"];
+    if (!text.isString())
+    {
+        LOG_WARN("%s中缺少text字段或text不是字符串类型", sub);
+        return nullptr;
+    }
+
+    if (!inner.Parse(text.c_str(), text.length()))
+    {
+        LOG_ERROR("解析text字段失败: %s, text_str: %s", inner.ErrorMessage(), text.c_str());
+        return nullptr;
+    }
+    return &inner.Root();
+}
+
 void AvvtnCapture::handleCbmTidy(const std::string& resultStr)
 {
     // 语义规整
     LOG_INFO("接收到AIUI返回的【语义规整cbm_tidy】");
-    
-    try {
-        // 解析外层JSON
-        auto root = nlohmann::json::parse(resultStr);
-        
-        // 检查cbm_tidy字段是否存在
-        if (root.contains("cbm_tidy") && root["cbm_tidy"].is_object()) {
-            auto& cbm_tidy = root["cbm_tidy"];
-            
-            // 检查text字段是否存在且为字符串
-            if (cbm_tidy.contains("text") && cbm_tidy["text"].is_string()) {
-                std::string text_str = cbm_tidy["text"].get<std::string>();
-                
-                try {
-                    // 解析text字段中的JSON
-                    auto text_root = nlohmann::json::parse(text_str);
-                    
-                    // 检查intent字段是否存在且为数组
-                    if (text_root.contains("intent") && text_root["intent"].is_array()) {
-                        auto& intentArray = text_root["intent"];
-                        
-                        // 遍历intent数组
-                        for (const auto& intent : intentArray) {
-                            // 使用value()方法提供默认值，避免键不存在时抛出异常
-                            int index = intent.value("index", 0);
-                            std::string value = intent.value("value", "");
-                            
-                            LOG_INFO("语义规整结果%d: %s", index, value.c_str());
-                        }
-                    } else {
-                        LOG_WARN("text字段中缺少intent数组或intent不是数组类型");
-                    }
-                } catch (const nlohmann::json::parse_error& e) {
-                    LOG_ERROR("解析text字段失败: %s, text_str: %s", e.what(), text_str.c_str());
-                } catch (const nlohmann::json::type_error& e) {
-                    LOG_ERROR("类型错误: %s", e.what());
-                }
-            } else {
-                LOG_WARN("cbm_tidy中缺少text字段或text不是字符串类型");
-            }
-        } else {
-            LOG_WARN("JSON中缺少cbm_tidy字段或cbm_tidy不是对象类型");
-        }
-    } catch (const nlohmann::json::parse_error& e) {
-        LOG_ERROR("解析JSON字符串失败: %s, resultStr: %s", e.what(), resultStr.c_str());
-    } catch (const std::exception& e) {
-        LOG_ERROR("处理cbm_tidy时发生异常: %s", e.what());
+
+    static thread_local JsonDocument outer, inner;
+    const JsonNode *text_root = parseCbmText(resultStr, "cbm_tidy", outer, inner);
+    if (text_root == nullptr)
+    {
+        return;
+    }
+
+    // 检查intent字段是否存在且为数组
+    const JsonNode &intentArray = (*text_root)["intent"];
+    if (!intentArray.isArray())
+    {
+        LOG_WARN("text字段中缺少intent数组或intent不是数组类型");
+        return;
+    }
+
+    // 遍历intent数组
+    for (const JsonNode &intent : intentArray)
+    {
+        // 键不存在时使用默认值
+        int index         = intent["index"].asInt(0);
+        std::string value = intent["value"].asString("");
+
+        LOG_INFO("语义规整结果%d: %s", index, value.c_str());
     }
 }
 
@@ -581,152 +675,94 @@ bool AvvtnCapture::handleCbmSemantic(const std::string& resultStr)
 
     LOG_INFO("接收到AIUI返回的【传统语义技能cbm_semantic】");
 
-    try {
-        // 解析外层JSON
-        auto root = nlohmann::json::parse(resultStr);
-        
-        // 检查cbm_semantic字段是否存在
-        if (!root.contains("cbm_semantic") || !root["cbm_semantic"].is_object()) {
-            LOG_WARN("JSON中缺少cbm_semantic字段或cbm_semantic不是对象类型");
-            return false;
-        }
-        
-        auto& cbm_semantic = root["cbm_semantic"];
-        
-        // 检查text字段是否存在且为字符串
-        if (!cbm_semantic.contains("text") || !cbm_semantic["text"].is_string()) {
-            LOG_WARN("cbm_semantic中缺少text字段或text不是字符串类型");
-            return false;
-        }
-        
-        std::string text_str = cbm_semantic["text"].get<std::string>();
-        
-        try {
-            // 解析text字段中的JSON
-            auto text_root = nlohmann::json::parse(text_str);
-            
-            // 检查rc字段是否存在
-            if (text_root.contains("rc") && text_root["rc"].is_number_integer()) {
-                int rc = text_root["rc"].get<int>();
-                
-                if (rc != 0) {
-                    LOG_INFO("技能结果：未命中技能");
-                    return false;
-                } else {
-                    LOG_INFO("技能结果：命中技能");
-                    is_skill = true;
-                    
-                    // 打印其他字段信息
-                    if (text_root.contains("text") && text_root["text"].is_string()) {
-                        std::string text = text_root["text"].get<std::string>();
-                        LOG_INFO("技能返回内容: %s", text.c_str());
-                    }
-                    
-                    if (text_root.contains("version") && text_root["version"].is_string()) {
-                        std::string version = text_root["version"].get<std::string>();
-                        LOG_INFO("技能版本: %s", version.c_str());
-                    }
-                    
-                    if (text_root.contains("service") && text_root["service"].is_string()) {
-                        std::string service = text_root["service"].get<std::string>();
-                        LOG_INFO("技能名称: %s", service.c_str());
-                    }
+    static thread_local JsonDocument outer, inner;
+    const JsonNode *text_root = parseCbmText(resultStr, "cbm_semantic", outer, inner);
+    if (text_root == nullptr)
+    {
+        return false;
+    }
 
-                    /*技能处理*/
-                    handleSkill(text_str);
-                    
-                    return true;
-                }
-            } else {
-                LOG_WARN("text字段中缺少rc字段或rc不是整数类型");
-                return false;
-            }
-            
-        } catch (const nlohmann::json::parse_error& e) {
-            LOG_ERROR("解析text字段失败: %s, text_str: %s", e.what(), text_str.c_str());
-            return false;
-        } catch (const nlohmann::json::type_error& e) {
-            LOG_ERROR("类型错误: %s", e.what());
-            return false;
-        }
-        
-    } catch (const nlohmann::json::parse_error& e) {
-        LOG_ERROR("解析JSON字符串失败: %s, resultStr: %s", e.what(), resultStr.c_str());
+    // 检查rc字段是否存在
+    const JsonNode &rc = (*text_root)["rc"];
+    if (!rc.isInteger())
+    {
+        LOG_WARN("text字段中缺少rc字段或rc不是整数类型");
         return false;
-    } catch (const std::exception& e) {
-        LOG_ERROR("处理cbm_semantic时发生异常: %s", e.what());
+    }
+
+    if (rc.asInt() != 0)
+    {
+        LOG_INFO("技能结果：未命中技能");
+        early_command_.reconcile(current_iat_sid_, "");
         return false;
     }
+
+    LOG_INFO("技能结果：命中技能");
+    is_skill = true;
+
+    // 打印其他字段信息
+    if ((*text_root)["text"].isString())
+    {
+        LOG_INFO("技能返回内容: %s", (*text_root)["text"].c_str());
+    }
+
+    if ((*text_root)["version"].isString())
+    {
+        LOG_INFO("技能版本: %s", (*text_root)["version"].c_str());
+    }
+
+    if ((*text_root)["service"].isString())
+    {
+        LOG_INFO("技能名称: %s", (*text_root)["service"].c_str());
+    }
+
+    /*技能处理*/
+    handleSkill(*text_root);
+
+    return true;
 }
 
 void AvvtnCapture::handleCbmToolPk(const std::string& resultStr)
 {
     LOG_INFO("接收到AIUI返回的【意图落域cbm_tool_pk】");
-    
-    try {
-        // 解析外层JSON
-        auto root = nlohmann::json::parse(resultStr);
-        
-        // 检查cbm_tool_pk字段是否存在
-        if (!root.contains("cbm_tool_pk") || !root["cbm_tool_pk"].is_object()) {
-            LOG_WARN("JSON中缺少cbm_tool_pk字段或cbm_tool_pk不是对象类型");
-            return;
-        }
-        
-        auto& cbm_tool_pk = root["cbm_tool_pk"];
-        
-        // 检查text字段是否存在且为字符串
-        if (!cbm_tool_pk.contains("text") || !cbm_tool_pk["text"].is_string()) {
-            LOG_WARN("cbm_tool_pk中缺少text字段或text不是字符串类型");
-            return;
-        }
-        
-        std::string text_str = cbm_tool_pk["text"].get<std::string>();
-        
-        try {
-            // 解析text字段中的JSON
-            auto text_root = nlohmann::json::parse(text_str);
-            
-            // 检查pk_type字段
-            if (text_root.contains("pk_type") && text_root["pk_type"].is_string()) {
-                std::string pk_type = text_root["pk_type"].get<std::string>();
-                LOG_INFO("落域结果判定来源模块: %s", pk_type.c_str());
-            }
-            
-            // 检查pk_source字段
-            if (text_root.contains("pk_source") && text_root["pk_source"].is_string()) {
-                std::string pk_source_text_str = text_root["pk_source"].get<std::string>();
-                
-                try {
-                    // 解析pk_source字段中的JSON
-                    auto pk_source_root = nlohmann::json::parse(pk_source_text_str);
-                    
-                    // 检查domain字段
-                    if (pk_source_root.contains("domain") && pk_source_root["domain"].is_string()) {
-                        std::string domain = pk_source_root["domain"].get<std::string>();
-                        LOG_INFO("落域结果: %s", domain.c_str());
-                    } else {
-                        LOG_WARN("pk_source字段中缺少domain字段或domain不是字符串类型");
-                    }
-                } catch (const nlohmann::json::parse_error& e) {
-                    LOG_ERROR("解析pk_source字段失败: %s", e.what());
-                } catch (const nlohmann::json::type_error& e) {
-                    LOG_ERROR("pk_source字段类型错误: %s", e.what());
-                }
-            } else {
-                LOG_WARN("text字段中缺少pk_source字段或pk_source不是字符串类型");
-            }
-            
-        } catch (const nlohmann::json::parse_error& e) {
-            LOG_ERROR("解析text字段失败: %s", e.what());
-        } catch (const nlohmann::json::type_error& e) {
-            LOG_ERROR("text字段类型错误: %s", e.what());
-        }
-        
-    } catch (const nlohmann::json::parse_error& e) {
-        LOG_ERROR("解析JSON字符串失败: %s", e.what());
-    } catch (const std::exception& e) {
-        LOG_ERROR("处理cbm_tool_pk时发生异常: %s", e.what());
+
+    static thread_local JsonDocument outer, inner, pk_source_doc;
+    const JsonNode *text_root = parseCbmText(resultStr, "cbm_tool_pk", outer, inner);
+    if (text_root == nullptr)
+    {
+        return;
+    }
+
+    // 检查pk_type字段
+    if ((*text_root)["pk_type"].isString())
+    {
+        LOG_INFO("落域结果判定来源模块: %s", (*text_root)["pk_type"].c_str());
+    }
+
+    // 检查pk_source字段
+    const JsonNode &pk_source = (*text_root)["pk_source"];
+    if (!pk_source.isString())
+    {
+        LOG_WARN("text字段中缺少pk_source字段或pk_source不是字符串类型");
+        return;
+    }
+
+    // 解析pk_source字段中的JSON
+    if (!pk_source_doc.Parse(pk_source.c_str(), pk_source.length()))
+    {
+        LOG_ERROR("解析pk_source字段失败: %s", pk_source_doc.ErrorMessage());
+        return;
+    }
+
+    // 检查domain字段
+    const JsonNode &domain = pk_source_doc["domain"];
+    if (domain.isString())
+    {
+        LOG_INFO("落域结果: %s", domain.c_str());
+    }
+    else
+    {
+        LOG_WARN("pk_source字段中缺少domain字段或domain不是字符串类型");
     }
 }
 
@@ -735,54 +771,29 @@ void AvvtnCapture::handleCbmRetrievalClassify(const std::string& resultStr)
     //LOG_INFO("JSON原始数据: %s", resultStr.c_str());
 
     LOG_INFO("接收到AIUI返回的【知识分类cbm_retrieval_classify】");
-    
-    try {
-        // 解析外层JSON
-        auto root = nlohmann::json::parse(resultStr);
-        
-        // 检查cbm_retrieval_classify字段是否存在
-        if (!root.contains("cbm_retrieval_classify") || !root["cbm_retrieval_classify"].is_object()) {
-            LOG_WARN("JSON中缺少cbm_retrieval_classify字段或cbm_retrieval_classify不是对象类型");
-            return;
-        }
-        
-        auto& cbm_retrieval_classify = root["cbm_retrieval_classify"];
-        
-        // 检查text字段是否存在且为字符串
-        if (!cbm_retrieval_classify.contains("text") || !cbm_retrieval_classify["text"].is_string()) {
-            LOG_WARN("cbm_retrieval_classify中缺少text字段或text不是字符串类型");
-            return;
-        }
-        
-        std::string text_str = cbm_retrieval_classify["text"].get<std::string>();
-        
-        try {
-            // 解析text字段中的JSON
-            auto text_root = nlohmann::json::parse(text_str);
-            
-            // 检查type字段是否存在且为整数
-            if (text_root.contains("type") && text_root["type"].is_number_integer()) {
-                int type = text_root["type"].get<int>();
-                
-                if (type == 0) {
-                    LOG_INFO("不走知识查询或联网搜索");
-                } else {
-                    LOG_INFO("走知识查询或联网搜索");
-                }
-            } else {
-                LOG_WARN("text字段中缺少type字段或type不是整数类型");
-            }
-            
-        } catch (const nlohmann::json::parse_error& e) {
-            LOG_ERROR("解析text字段失败: %s, text_str: %s", e.what(), text_str.c_str());
-        } catch (const nlohmann::json::type_error& e) {
-            LOG_ERROR("类型错误: %s", e.what());
-        }
-        
-    } catch (const nlohmann::json::parse_error& e) {
-        LOG_ERROR("解析JSON字符串失败: %s", e.what());
-    } catch (const std::exception& e) {
-        LOG_ERROR("处理cbm_retrieval_classify时发生异常: %s", e.what());
+
+    static thread_local JsonDocument outer, inner;
+    const JsonNode *text_root = parseCbmText(resultStr, "cbm_retrieval_classify", outer, inner);
+    if (text_root == nullptr)
+    {
+        return;
+    }
+
+    // 检查type字段是否存在且为整数
+    const JsonNode &type = (*text_root)["type"];
+    if (!type.isInteger())
+    {
+        LOG_WARN("text字段中缺少type字段或type不是整数类型");
+        return;
+    }
+
+    if (type.asInt() == 0)
+    {
+        LOG_INFO("不走知识查询或联网搜索");
+    }
+    else
+    {
+        LOG_INFO("走知识查询或联网搜索");
     }
 }
 
@@ -790,116 +801,82 @@ void AvvtnCapture::handleCbmKnowledge(const std::string& resultStr)
 {
     LOG_INFO("JSON原始数据: %s", resultStr.c_str());
     LOG_INFO("接收到AIUI返回的【知识溯源cbm_knowledge】");
-    
-    try {
-        // 解析外层JSON
-        auto root = nlohmann::json::parse(resultStr);
-        
-        // 检查cbm_knowledge字段是否存在
-        if (!root.contains("cbm_knowledge") || !root["cbm_knowledge"].is_object()) {
-            LOG_WARN("JSON中缺少cbm_knowledge字段或cbm_knowledge不是对象类型");
-            LOG_INFO("未命中知识库");
-            return;
+
+    static thread_local JsonDocument outer, inner;
+    const JsonNode *text_array = parseCbmText(resultStr, "cbm_knowledge", outer, inner);
+    if (text_array == nullptr)
+    {
+        LOG_INFO("未命中知识库");
+        return;
+    }
+
+    // 检查是否是数组
+    if (!text_array->isArray())
+    {
+        LOG_WARN("text字段不是有效的JSON数组");
+        LOG_INFO("未命中知识库");
+        return;
+    }
+
+    if (text_array->empty())
+    {
+        LOG_INFO("未命中知识库");
+        return;
+    }
+
+    // 遍历知识条目
+    for (const JsonNode &item : *text_array)
+    {
+        if (!item.isObject())
+        {
+            continue;    // 跳过非对象元素
         }
 
-        auto& cbm_knowledge = root["cbm_knowledge"];
-        
-        // 检查text字段是否存在且为字符串
-        if (!cbm_knowledge.contains("text") || !cbm_knowledge["text"].is_string()) {
-            LOG_WARN("cbm_knowledge中缺少text字段或text不是字符串类型");
-            LOG_INFO("未命中知识库");
-            return;
+        LOG_INFO("知识条目开始 ----------");
+
+        // 输出score
+        if (item["score"].isNumber())
+        {
+            LOG_INFO("score: %lf", item["score"].asDouble());
         }
-        
-        std::string text_str = cbm_knowledge["text"].get<std::string>();
-        
-        try {
-            // 解析text字段中的JSON数组
-            auto text_array = nlohmann::json::parse(text_str);
-            
-            // 检查是否是数组
-            if (!text_array.is_array()) {
-                LOG_WARN("text字段不是有效的JSON数组");
-                LOG_INFO("未命中知识库");
-                return;
-            }
-            
-            if (text_array.empty()) {
-                LOG_INFO("未命中知识库");
-                return;
-            }
-            
-            // 遍历知识条目
-            for (const auto& item : text_array) {
-                if (!item.is_object()) {
-                    continue; // 跳过非对象元素
-                }
-                
-                LOG_INFO("知识条目开始 ----------");
-                
-                // 输出score
-                if (item.contains("score") && item["score"].is_number_float()) {
-                    double score = item["score"].get<double>();
-                    LOG_INFO("score: %lf", score);
-                } else if (item.contains("score") && item["score"].is_number_integer()) {
-                    double score = item["score"].get<int>();
-                    LOG_INFO("score: %lf", score);
-                }
-                
-                // 输出repoId
-                if (item.contains("repoId") && item["repoId"].is_string()) {
-                    std::string repoId = item["repoId"].get<std::string>();
-                    LOG_INFO("知识库Id: %s", repoId.c_str());
-                }
-                
-                // 输出docName
-                if (item.contains("docName") && item["docName"].is_string()) {
-                    std::string docName = item["docName"].get<std::string>();
-                    LOG_INFO("来源文档: %s", docName.c_str());
-                }
-                
-                // 输出repoName
-                if (item.contains("repoName") && item["repoName"].is_string()) {
-                    std::string repoName = item["repoName"].get<std::string>();
-                    LOG_INFO("repo名字: %s", repoName.c_str());
-                }
-                
-                // 输出content
-                if (item.contains("content") && item["content"].is_string()) {
-                    std::string content = item["content"].get<std::string>();
-                    LOG_INFO("内容: %s", content.c_str());
-                }
-                
-                // 输出其他可能存在的字段
-                std::vector<std::string> other_fields = {"title", "url", "author", "time"};
-                for (const auto& field : other_fields) {
-                    if (item.contains(field) && item[field].is_string()) {
-                        LOG_INFO("%s: %s", field.c_str(), item[field].get<std::string>().c_str());
-                    }
-                }
-                
-                LOG_INFO("知识条目结束 ----------");
-            }
-            
-            LOG_INFO("总共找到 %zu 个知识条目", text_array.size());
-            if (text_array.size() > 0)
+
+        // 输出repoId
+        if (item["repoId"].isString())
+        {
+            LOG_INFO("知识库Id: %s", item["repoId"].c_str());
+        }
+
+        // 输出docName
+        if (item["docName"].isString())
+        {
+            LOG_INFO("来源文档: %s", item["docName"].c_str());
+        }
+
+        // 输出repoName
+        if (item["repoName"].isString())
+        {
+            LOG_INFO("repo名字: %s", item["repoName"].c_str());
+        }
+
+        // 输出content
+        if (item["content"].isString())
+        {
+            LOG_INFO("内容: %s", item["content"].c_str());
+        }
+
+        // 输出其他可能存在的字段
+        static const char *const other_fields[] = { "title", "url", "author", "time" };
+        for (const char *field : other_fields)
+        {
+            if (item[field].isString())
             {
-                is_knowledge = true;
+                LOG_INFO("%s: %s", field, item[field].c_str());
             }
-            
-        } catch (const nlohmann::json::parse_error& e) {
-            LOG_ERROR("解析text字段失败: %s, text_str: %s", e.what(), text_str.c_str());
-            LOG_INFO("未命中知识库");
-        } catch (const nlohmann::json::type_error& e) {
-            LOG_ERROR("类型错误: %s", e.what());
-            LOG_INFO("未命中知识库");
         }
-        
-    } catch (const nlohmann::json::parse_error& e) {
-        LOG_ERROR("解析JSON字符串失败: %s", e.what());
-        LOG_INFO("未命中知识库");
-    } catch (const std::exception& e) {
-        LOG_ERROR("处理cbm_knowledge时发生异常: %s", e.what());
-        LOG_INFO("未命中知识库");
+
+        LOG_INFO("知识条目结束 ----------");
     }
+
+    LOG_INFO("总共找到 %zu 个知识条目", text_array->size());
+    is_knowledge = true;
 }
@@ -1,96 +1,49 @@
 #include "avvtn_capture/avvtn_capture.h"
 #include "utils/Logger.hpp"
 #include "ros2/ros_manager.hpp"
+#include "utils/AppConfig.h"
 
 static AvvtnCapture* g_avvtn_capture_instance = nullptr;
 
-// 初始化类静态成员（必须在类外初始化）
-std::atomic<bool> AvvtnCapture::g_timer_running(false);
-std::atomic<long long> AvvtnCapture::g_last_active_time(0LL); // 0LL表示long long类型的0
-std::thread AvvtnCapture::g_timer_thread;
-
-// 实现时间戳函数
-inline long long AvvtnCapture::getCurrentTimeMs() {
-    auto now = std::chrono::system_clock::now();
-    auto duration = now.time_since_epoch();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-}
-
-// 实现超时目标函数
-void AvvtnCapture::onPlayerTimeout() {
-    LOG_DEBUG("播放器1秒无进度更新，触发超时回调！");
-
-    if (g_avvtn_capture_instance->is_sleeping == true)
-    {
-        ROSManager::getInstance().publishStatus("STATUS_WAITING_WAKEUP");
-    }
-    else
-    {
-        ROSManager::getInstance().publishStatus("STATUS_WAITING_CONVERSATION");
-    }
-
-    g_avvtn_capture_instance->is_playing = false;
-
-    stopPlayerTimer();
-}
-
-// 实现定时器循环
-void AvvtnCapture::timerLoop() {
-    const int TIMEOUT_MS = 1000;
-    while (g_timer_running) {
-        long long current = getCurrentTimeMs();
-        long long last = g_last_active_time.load();
-        if (last != 0 && (current - last) >= TIMEOUT_MS) {
-            onPlayerTimeout();
-            g_last_active_time = 0;
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-}
-
 /*********************播放回调函数************************/
 void AvvtnCapture::onStarted()
 {
-    std::cout << "PcmPlayer, onStarted" << std::endl;
+    LOG_INFO("PcmPlayer, onStarted");
 }
 
 void AvvtnCapture::onPaused()
 {
-    std::cout << "PcmPlayer, onPaused" << std::endl;
+    LOG_INFO("PcmPlayer, onPaused");
 }
 
 void AvvtnCapture::onResumed()
 {
-    std::cout << "PcmPlayer, onResumed" << std::endl;
+    LOG_INFO("PcmPlayer, onResumed");
 }
 
 void AvvtnCapture::onStopped()
 {
-    std::cout << "PcmPlayer, onStopped" << std::endl;
+    LOG_INFO("PcmPlayer, onStopped");
+    if (g_avvtn_capture_instance != nullptr)
+    {
+        g_avvtn_capture_instance->conversation_.onPlaybackStopped();
+    }
 }
 
 void AvvtnCapture::onError(int error, const char *des)
 {
-    std::cout << "PcmPlayer, onError, error=" << error << ", des=" << des << std::endl;
+    LOG_ERROR("PcmPlayer, onError, error = %d, des = %s", error, des);
 }
 
 void AvvtnCapture::onProgress(int streamId, int progress, const char *audio, int len, bool isCompleted)
 {
     //std::cout << "PcmPlayer, onProgress, streamId=" << streamId << ", progress=" << progress << ", len=" << len << ", isCompleted=" << isCompleted << std::endl;
-    g_avvtn_capture_instance->is_playing = true;
-
-    // 重置定时器：更新最后活动时间戳
-    g_last_active_time = getCurrentTimeMs();
-    // 首次触发时启动定时器线程
-    if (!g_timer_running) {
-        g_timer_running = true;
-        g_timer_thread = std::thread(timerLoop);
-        g_timer_thread.detach();
-    }
+    g_avvtn_capture_instance->barge_in_.onPlayerProgress();
+    g_avvtn_capture_instance->conversation_.onPlaybackProgress(isCompleted);
 
-    // 原有业务逻辑
     if (isCompleted) {
         LOG_DEBUG("音频播放完成！streamId=%d\n", streamId);
+        g_avvtn_capture_instance->aiui_wrapper_.speech_queue_.onPlaybackFinished();
     }
 
     if (progress == 100) {
@@ -98,10 +51,44 @@ void AvvtnCapture::onProgress(int streamId, int progress, const char *audio, int
     }
 }
 
-// 实现停止定时器函数
-void AvvtnCapture::stopPlayerTimer() {
-    g_timer_running = false;
-    g_last_active_time = 0;
+void AvvtnCapture::onPlaybackBegin()
+{
+    if (g_avvtn_capture_instance != nullptr)
+    {
+        g_avvtn_capture_instance->conversation_.onPlaybackBegin();
+    }
+}
+
+void AvvtnCapture::bargeIn(const char *source)
+{
+    // 只在机器人说话时打断
+    if (!conversation_.isPlaying() || !barge_in_.begin(source))
+    {
+        return;
+    }
+
+    PcmOutput::getInstance().clear();
+    PcmOutput::getInstance().stop();
+    barge_in_.silenced();
+    conversation_.onPlaybackStopped();
+
+    aiui_wrapper_.CancelTTS();
+    aiui_wrapper_.speech_queue_.cancelAll();
+    barge_in_pending_ = true;
+}
+
+void AvvtnCapture::applyBargeIn()
+{
+    if (!barge_in_pending_.exchange(false))
+    {
+        return;
+    }
+
+    aiui_wrapper_.listener_->tts_helper_ptr_->clear();
+    ignore_tts_sid_      = current_tts_sid_;
+    interrupted_iat_sid_ = current_iat_sid_;
+    tts_len_             = 0;
+    LOG_INFO("打断: 取消待合成的分段, 忽略合成sid = %s", ignore_tts_sid_.c_str());
 }
 
 // 初始化
@@ -110,6 +97,34 @@ int AvvtnCapture::Init(std::string avvtn_cfg_path, std::string aiui_cfg_path)
     int ret = 0;
     LOG_INFO("初始化多模态降噪引擎AVVTN");
     g_avvtn_capture_instance = this;
+    conversation_.setPublisher([](const char *status) { ROSManager::getInstance().publishStatus(status); });
+    barge_in_.setEnabled(AppConfig::getInstance().barge_in.enable);
+    barge_in_.setDebounceMs(AppConfig::getInstance().barge_in.debounce_ms);
+    const AppConfig::UplinkGateConfig &gate_cfg = AppConfig::getInstance().uplink_gate;
+    uplink_gate_.setEnabled(gate_cfg.enable);
+    uplink_gate_.setEnergyThreshold(gate_cfg.energy_threshold);
+    uplink_gate_.setOpenFrames(gate_cfg.open_frames);
+    uplink_gate_.setBufferMs(gate_cfg.buffer_ms);
+    uplink_gate_.setHangoverMs(gate_cfg.hangover_ms);
+    uplink_gate_.setOpenTimeoutMs(gate_cfg.open_timeout_ms);
+    uplink_gate_.setWriter([this](const char *data, int len, bool is_stop) { endpointer_.write(data, len, is_stop); });
+    const AppConfig::EndpointerConfig &endpoint_cfg = AppConfig::getInstance().endpointer;
+    endpointer_.setEnabled(endpoint_cfg.enable);
+    endpointer_.setSilenceRms(endpoint_cfg.silence_rms);
+    endpointer_.setMinSpeechMs(endpoint_cfg.min_speech_ms);
+    endpointer_.setFinalSilenceMs(endpoint_cfg.final_silence_ms);
+    endpointer_.setStableSilenceMs(endpoint_cfg.stable_silence_ms);
+    endpointer_.setStableMs(endpoint_cfg.stable_ms);
+    endpointer_.setSuffixes(endpoint_cfg.final_suffixes, endpoint_cfg.continuation_suffixes);
+    endpointer_.setWriter([this](const char *data, int len, bool is_stop) { aiui_wrapper_.WriteAudio(data, len, is_stop); });
+    partial_transcript_.setEnabled(AppConfig::getInstance().partial_transcript.enable);
+    partial_transcript_.setMinIntervalMs(AppConfig::getInstance().partial_transcript.min_interval_ms);
+    const AppConfig::EarlyCommandConfig &early_cfg = AppConfig::getInstance().early_command;
+    early_command_.setEnabled(early_cfg.enable);
+    early_command_.setUnstableConfirm(early_cfg.unstable_confirm);
+    early_command_.setPhrases(early_cfg.stop_phrases, early_cfg.shut_up_phrases);
+    skill_router_.build(AppConfig::getInstance().skills.routes);
+    partial_transcript_.setPublisher([](const std::string &message) { ROSManager::getInstance().publishChatPartial(message); });
     // 1、初始化多模态降噪引擎
     std::string avvtn_input_str    = "{ \"params\":{ \"cfg_path\":\"" + avvtn_cfg_path + "\" } }";
     init_param_.callback.handler   = avvtnCallback;
@@ -147,7 +162,8 @@ int AvvtnCapture::Init(std::string avvtn_cfg_path, std::string aiui_cfg_path)
     }
 
     // 初始化pcm播放器回调
-    aiui_pcm_player_set_callbacks(onStarted, onPaused, onResumed, onStopped, onProgress, onError);
+    PcmOutput::getInstance().setCallbacks(onStarted, onPaused, onResumed, onStopped, onProgress, onError);
+    PcmOutput::getInstance().setOnBegin(onPlaybackBegin);
 
     // 3、初始化视频采集
     // ret = video_cap_.Start(this, videoCaptureCallback);
@@ -165,7 +181,7 @@ int AvvtnCapture::Init(std::string avvtn_cfg_path, std::string aiui_cfg_path)
     {
         LOG_INFO("初始化音频采集成功");
         LOG_INFO("开始音频采集...");
-        ROSManager::getInstance().publishStatus("STATUS_WAITING_WAKEUP");
+        conversation_.start();
     }
 
     // test_avvtn();
@@ -202,21 +218,21 @@ int AvvtnCapture::test_avvtn()
     ret = test_set_beam("{\"params\":{\"beam\":\"1\"}}");
     if (ret != 0)
     {
-        std::cerr << "Failed to set beam" << std::endl;
+        LOG_ERROR("Failed to set beam");
         return ret;
     }
     // 测试修改参数
     ret = test_set_param("{\"params\":{\"cae_mode\":\"ivw\"}}");
     if (ret != 0)
     {
-        std::cerr << "Failed to set param" << std::endl;
+        LOG_ERROR("Failed to set param");
         return ret;
     }
 
     ret = test_set_param("{\"params\":{\"log_save\":\"1\"}}");
     if (ret != 0)
     {
-        std::cerr << "Failed to set param" << std::endl;
+        LOG_ERROR("Failed to set param");
         return ret;
     }
 
@@ -233,7 +249,7 @@ int AvvtnCapture::test_avvtn()
     ret                         = test_evaluate_keyword(gbk_word_bytes);
     if (ret != 0)
     {
-        std::cerr << "Failed to evaluate keyword" << std::endl;
+        LOG_ERROR("Failed to evaluate keyword");
         return ret;
     }
     // 2、生成唤醒词
@@ -243,13 +259,13 @@ int AvvtnCapture::test_avvtn()
     ret = test_generate_keyword("{ \"params\":{ \"word\":\"小爱同学\" } }", "./xatx.bin");
     if (ret != 0)
     {
-        std::cerr << "Failed to generate keyword" << std::endl;
+        LOG_ERROR("Failed to generate keyword");
         return ret;
     }
     ret = test_generate_keyword("{ \"params\":{ \"word\":\"小明小明,小美小美,小红小红\" } }", "./xmxm.bin");
     if (ret != 0)
     {
-        std::cerr << "Failed to generate keyword" << std::endl;
+        LOG_ERROR("Failed to generate keyword");
         return ret;
     }
 
@@ -260,13 +276,13 @@ int AvvtnCapture::test_avvtn()
     ret = test_add_keyword("./xatx.bin");
     if (ret != 0)
     {
-        std::cerr << "Failed to add keyword" << std::endl;
+        LOG_ERROR("Failed to add keyword");
         return ret;
     }
     ret = test_add_keyword("./xmxm.bin");
     if (ret != 0)
     {
-        std::cerr << "Failed to add keyword" << std::endl;
+        LOG_ERROR("Failed to add keyword");
         return ret;
     }
 
@@ -276,7 +292,7 @@ int AvvtnCapture::test_avvtn()
     ret = test_remove_keyword("{ \"params\":{ \"id\":\"600\" } }");
     if (ret != 0)
     {
-        std::cerr << "Failed to remove keyword" << std::endl;
+        LOG_ERROR("Failed to remove keyword");
         return ret;
     }
 
@@ -8,13 +8,21 @@
 #ifndef AVVTN_CAPTURE_H
 #define AVVTN_CAPTURE_H
 
+#include <atomic>
 #include <iostream>
 #include <string>
 
 #include "aiui_capture/aiui_wapper.h"
 #include "audio_capture/audio_capture.h"
 #include "avvtn_api/avvtn_api.h"
-#include "utils/cjson/cJSON.h"
+#include "avvtn_capture/barge_in.h"
+#include "avvtn_capture/conversation_state.h"
+#include "avvtn_capture/early_command.h"
+#include "avvtn_capture/endpointer.h"
+#include "avvtn_capture/partial_transcript.h"
+#include "avvtn_capture/skill_router.h"
+#include "avvtn_capture/uplink_gate.h"
+#include "utils/JsonDocument.h"
 #include "video_capture/video_capture.h"
 // 错误检查宏，如果返回值不为0则直接返回该值
 #define CHECK_RET(ret) \
@@ -58,20 +66,7 @@ public:
     static void onStopped();
     static void onError(int error, const char *des);
     static void onProgress(int streamId, int progress, const char *audio, int len, bool isCompleted);
-
-private:
-    // 定时器私有静态成员（仅类内部访问，线程安全）
-    static std::atomic<bool> g_timer_running;
-    static std::atomic<long long> g_last_active_time;
-    static std::thread g_timer_thread;
-
-    // 定时器核心循环（私有静态函数）
-    static void timerLoop();
-    // 获取当前毫秒时间戳（私有内联函数）
-    static inline long long getCurrentTimeMs();
-
-    static void onPlayerTimeout();  // 定时器超时目标函数
-    static void stopPlayerTimer();  // 统一停止定时器函数
+    static void onPlaybackBegin();
 
 private:
     /**
@@ -108,11 +103,11 @@ private:
     /**
      * @brief 解析json数据并检查数据
      * @param data_p 回调数据指针
-     * @param json 解析后的json数据
-     * @param data 解析后的数据
+     * @param doc 用于解析的json文档（调用方复用，避免每帧分配）
+     * @param data 解析后的data节点
      * @return 0表示成功，非0表示失败
      */
-    int parseJsonAndCheckData(avvtn_callback_data_t *data_p, cJSON **json, cJSON **data);
+    int parseJsonAndCheckData(avvtn_callback_data_t *data_p, JsonDocument &doc, const JsonNode **data);
 
     /**
      * @brief 处理人脸识别回调
@@ -140,15 +135,33 @@ private:
 
     /**
      * @brief 处理AIUI识别回调
+     * @param sid 识别会话
      * @param buffer 识别结果
      */
-    void handleAiuiIat(Json::Reader &reader, const char *buffer, int len);
+    void handleAiuiIat(Json::Reader &reader, const std::string &sid, const char *buffer, int len);
 
     /**
      * @brief 处理AIUI合成回调
      * @param buffer 合成结果
      */
-    void handleAiuiTts(const Json::Reader &reader, const Json::Value content, const IAIUIEvent event, Json::Value bizParamJson, const char *buffer, int len);
+    void handleAiuiTts(const Json::Value &content, const IAIUIEvent &event, Json::Value &bizParamJson, const char *buffer, int len);
+
+    /**
+     * @brief 本轮对话第一次收到合成音频时，统计从首个NLP token到首包音频的延迟
+     */
+    void reportFirstAudioLatency();
+
+    /**
+     * @brief 用户开口打断：机器人说话时立即清空并停止播放器、取消云端合成
+     * @details 可在降噪引擎回调线程或AIUI回调线程调用；流式合成状态的清理留给applyBargeIn()
+     * @param source 触发源，用于日志
+     */
+    void bargeIn(const char *source);
+
+    /**
+     * @brief 在AIUI回调线程中完成打断：取消待合成的分段，忽略旧的合成sid
+     */
+    void applyBargeIn();
 
     /**
      * @brief 处理AIUI流式nlp回调
@@ -189,9 +202,16 @@ private:
 
     /**
      * @brief 处理 命中的技能
-     * @param text_str JSON 字符串格式的技能text
+     * @param text_root 已解析的技能text节点
+     */
+    void handleSkill(const JsonNode& text_root);
+
+    /**
+     * @brief 执行识别中间结果上提前检出的指令
+     * @param actions EarlyCommand::Action按位或
+     * @param phrase 命中的短语
      */
-    void handleSkill(const std::string& text_str);
+    void runEarlyCommand(int actions, const std::string &phrase);
 
     /**
      * @brief 测试评估关键词
@@ -266,18 +286,33 @@ private:
     std::string wake_mode_ = "ivw";           // 唤醒模式
     std::string current_tts_sid_;             // 当前合成sid
     std::string current_iat_sid_;             // 当前识别sid
-    std::string iat_text_buffer_;             // 识别结果缓存
+    IatSessions iat_sessions_;                // 按sid拼装的识别结果
+    PartialTranscript partial_transcript_;    // 识别中间结果的实时发布
+    EarlyCommand early_command_;              // 识别中间结果上提前检出的停止类指令
+    SkillRouter skill_router_;                // 技能结果按配置的路由表分发
     std::string stream_nlp_answer_buffer_;    // 流式nlp的应答语缓存
     int tts_len_          = 0;                // 当前收到了tts音频的长度
     int intent_cnt_       = 0;                // 意图的数量
     int stream_nlp_index_ = 0;                // 流式nlp的索引
 
+    long long first_nlp_token_ms_           = 0;        // 本轮首个NLP token的时间
+    bool first_audio_reported_              = false;    // 本轮是否已统计首包音频延迟
+    long long first_audio_latency_total_ms_ = 0;        // 首包音频延迟累计
+    int first_audio_latency_count_          = 0;        // 首包音频延迟统计轮数
+
     std::string ignore_tts_sid_;              // 当前tts不播放，播放技能返回tts
+    std::string interrupted_iat_sid_;         // 被用户打断的那一轮，后续流式应答不再送合成
+
+    BargeInController barge_in_;                     // 打断去重和测速
+    std::atomic<bool> barge_in_pending_{ false };    // 已停播，等AIUI回调线程清理合成状态
+
+    UplinkGate uplink_gate_;    // 机器人说话时暂扣识别音频上送
+    Endpointer endpointer_;     // 一句话明显说完时提前结束上送，串在门控之后
 
     bool is_skill = false;      //是否命中技能
     bool is_knowledge = false;  //是否命中知识库
-    bool is_playing;            //播放器是否正在播放
-    bool is_sleeping;           //是否已经休眠，等待唤醒
+
+    ConversationState conversation_;    // 唤醒、播放、用户说话的状态，变化时发布ROS状态
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "avvtn_capture/avvtn_capture.h"
 #include "utils/Logger.hpp"
-#include "utils/json.hpp"
 #include "ros2/ros_manager.hpp"
 
 int AvvtnCapture::test_evaluate_keyword(const char *keyword)
@@ -16,7 +15,7 @@ int AvvtnCapture::test_evaluate_keyword(const char *keyword)
     avvtn_interact_info.out.str_size          = sizeof(test_res_out);
     ret                                       = avvtn_api_interact(avvtn_cap_, &avvtn_interact_info);
     CHECK_RET(ret);
-    std::cout << "evaluate keyword result: " << test_res_out << std::endl;
+    LOG_INFO("evaluate keyword result: %s", test_res_out);
     return ret;
 }
 
@@ -35,7 +34,7 @@ int AvvtnCapture::test_generate_keyword(const char *keyword, const char *output_
     FILE *fp = NULL;
     if (NULL == (fp = fopen(output_path, "wb")))
     {
-        printf("failed on create custom_keyword: \"%s\"", output_path);
+        LOG_ERROR("failed on create custom_keyword: \"%s\"", output_path);
         return -1;
     }
     fwrite(avvtn_interact_info.out.raw, 1, avvtn_interact_info.out.raw_size, fp);
@@ -56,7 +55,7 @@ int AvvtnCapture::test_add_keyword(const char *output_path)
     avvtn_interact_info.out.str_size          = sizeof(test_res_out);
     ret                                       = avvtn_api_interact(avvtn_cap_, &avvtn_interact_info);
     CHECK_RET(ret);
-    std::cout << "add keyword result: " << test_res_out << std::endl;
+    LOG_INFO("add keyword result: %s", test_res_out);
     return ret;
 }
 
@@ -73,7 +72,7 @@ int AvvtnCapture::test_remove_keyword(const char *keywords_id)
     avvtn_interact_info.out.str_size          = sizeof(test_res_out);
     ret                                       = avvtn_api_interact(avvtn_cap_, &avvtn_interact_info);
     CHECK_RET(ret);
-    std::cout << "remove keyword result: " << test_res_out << std::endl;
+    LOG_INFO("remove keyword result: %s", test_res_out);
     return ret;
 }
 
@@ -103,26 +102,20 @@ int AvvtnCapture::test_set_beam(const char *beam_id)
     return ret;
 }
 
-int AvvtnCapture::parseJsonAndCheckData(avvtn_callback_data_t *data_p, cJSON **json, cJSON **data)
+int AvvtnCapture::parseJsonAndCheckData(avvtn_callback_data_t *data_p, JsonDocument &doc, const JsonNode **data)
 {
-    std::string param_str = std::string((char *)data_p->param, data_p->param_size);
-    // std::cout << "param: " << param_str.c_str() << " len: " << data_p->param_size << std::endl;
-    *json = cJSON_Parse(param_str.c_str());
-    if (*json == nullptr)
+    if (!doc.Parse((const char *)data_p->param, data_p->param_size))
     {
-        LOG_ERROR("Failed to parse JSON!");
+        std::string param_str = std::string((char *)data_p->param, data_p->param_size);
+        LOG_ERROR("Failed to parse JSON: %s, offset: %zu", doc.ErrorMessage(), doc.ErrorOffset());
         LOG_ERROR("param: %s len: %d", param_str.c_str(), data_p->param_size);
-        std::cerr << "Failed to parse JSON!" << std::endl;
-        std::cerr << "param: " << param_str.c_str() << " len: " << data_p->param_size << std::endl;
         return -1;
     }
 
-    *data = cJSON_GetObjectItem(*json, "data");
+    *data = doc.Root().find("data", 4);
     if (*data == nullptr)
     {
         LOG_ERROR("No data object found");
-        std::cerr << "No data object found" << std::endl;
-        cJSON_Delete(*json);
         return -1;
     }
 
@@ -132,26 +125,34 @@ int AvvtnCapture::parseJsonAndCheckData(avvtn_callback_data_t *data_p, cJSON **j
 void AvvtnCapture::handleAudioCAE(avvtn_callback_data_t *data_p)
 {
     LOG_TRACE("触发降噪音频回调");
+    // 降噪音频不管有没有人说话每帧都会到，顺带检查播放器是否没报完成就停了
+    if (conversation_.checkPlaybackStall())
+    {
+        aiui_wrapper_.speech_queue_.onPlaybackIdle();
+    }
+
     // data_p->param 是json格式，需要解析json数据，data_p->data 是音频数据 data_p->data_size 是音频数据大小
     // 降噪音频的通道数为 -1 0 1 2 分别代表纯声学 0说话人 1说话人 2说话人 vad_status 0 1 2 3 分别代表静音 开始说话 说话中 结束说话
-    cJSON *json, *data;
-    if (parseJsonAndCheckData(data_p, &json, &data) != 0)
+    // 每帧都会回调，文档按线程复用，稳态下解析不再分配内存
+    static thread_local JsonDocument doc;
+    const JsonNode *data = nullptr;
+    if (parseJsonAndCheckData(data_p, doc, &data) != 0)
     {
         return;
     }
-    int channel        = -2;
-    int vad_status     = -1;
-    cJSON *channelItem = cJSON_GetObjectItem(data, "channel");
-    if (channelItem != NULL && cJSON_IsNumber(channelItem))
+    int channel                 = -2;
+    int vad_status              = -1;
+    const JsonNode &channelItem = (*data)["channel"];
+    if (channelItem.isNumber())
     {
-        channel = channelItem->valueint;
+        channel = channelItem.asInt();
         LOG_TRACE("降噪音频回调: channel = %d", channel);
     }
 
-    cJSON *vadStatus = cJSON_GetObjectItem(data, "vad_status");
-    if (vadStatus != NULL && cJSON_IsNumber(vadStatus))
+    const JsonNode &vadStatus = (*data)["vad_status"];
+    if (vadStatus.isNumber())
     {
-        vad_status = vadStatus->valueint;
+        vad_status = vadStatus.asInt();
         LOG_TRACE("降噪音频回调: vad_status = %d", vad_status);
     }
 
@@ -198,15 +199,15 @@ void AvvtnCapture::handleAudioCAE(avvtn_callback_data_t *data_p)
         }
 }
 #endif
-    cJSON_Delete(json);
     return;
 }
 
 void AvvtnCapture::handleAudioRec(avvtn_callback_data_t *data_p)
 {
     LOG_DEBUG("触发识别音频回调");
-    cJSON *json, *data;
-    if (parseJsonAndCheckData(data_p, &json, &data) != 0)
+    static thread_local JsonDocument doc;
+    const JsonNode *data = nullptr;
+    if (parseJsonAndCheckData(data_p, doc, &data) != 0)
     {
         return;
     }
@@ -214,28 +215,33 @@ void AvvtnCapture::handleAudioRec(avvtn_callback_data_t *data_p)
     int channel    = -1;
     int vad_status = -1;
 
-    cJSON *channelItem = cJSON_GetObjectItem(data, "channel");
-    if (channelItem != NULL && cJSON_IsNumber(channelItem))
+    const JsonNode &channelItem = (*data)["channel"];
+    if (channelItem.isNumber())
     {
-        channel = channelItem->valueint;
+        channel = channelItem.asInt();
         LOG_DEBUG("识别音频回调: channel = %d", channel);
     }
 
-    cJSON *vadStatus = cJSON_GetObjectItem(data, "vad_status");
-    if (vadStatus != NULL && cJSON_IsNumber(vadStatus))
+    const JsonNode &vadStatus = (*data)["vad_status"];
+    if (vadStatus.isNumber())
     {
-        vad_status = vadStatus->valueint;
+        vad_status = vadStatus.asInt();
         LOG_DEBUG("识别音频回调: vad_status = %d", vad_status);
     }
-    cJSON_Delete(json);
 
-    if (vad_status == 3)
+    if (vad_status == 1)
     {
-        aiui_wrapper_.WriteAudio(nullptr, 0, true);
+        // 引擎的开口检测比AIUI的BOS早，先在这里打断
+        bargeIn("rec_vad");
     }
-    else
+
+    // 补发限流压下的识别中间结果
+    partial_transcript_.poll();
+
+    // 机器人说话时由门控决定是否上送，连续几帧能量超过阈值也算开口
+    if (uplink_gate_.feed((const char *)data_p->data, data_p->data_size, vad_status, conversation_.isPlaying()))
     {
-        aiui_wrapper_.WriteAudio((const char *)data_p->data, data_p->data_size, false);
+        bargeIn("rec_energy");
     }
 
 // 保存音频文件
@@ -257,33 +263,31 @@ void AvvtnCapture::handleFaceRecognition(avvtn_callback_data_t *data_p)
 
     if (!data_p || !data_p->param || !data_p->data || data_p->data_size <= 0)
     {
-        std::cerr << "Invalid callback data!" << std::endl;
+        LOG_ERROR("Invalid callback data!");
         return;
     }
 
     // data_p->param 是json格式，需要解析json数据，包含了各个通道的人脸信息。
-    cJSON *root = cJSON_Parse((char *)data_p->param);
-    if (root == nullptr)
+    static thread_local JsonDocument doc;
+    if (!doc.Parse((const char *)data_p->param, data_p->param_size))
     {
-        std::cerr << "Failed to parse JSON!" << std::endl;
+        LOG_ERROR("Failed to parse JSON: %s, offset: %zu", doc.ErrorMessage(), doc.ErrorOffset());
         return;
     }
-    cJSON *format = cJSON_GetObjectItem(root, "format");
-    if (format == nullptr)
+    const JsonNode &format = doc["format"];
+    if (format.isNull())
     {
-        std::cerr << "No format object found!" << std::endl;
-        cJSON_Delete(root);
+        LOG_ERROR("No format object found!");
         return;
     }
-    if (cJSON_IsNumber(cJSON_GetObjectItem(format, "image_w")) && cJSON_IsNumber(cJSON_GetObjectItem(format, "image_h")))
+    if (format["image_w"].isNumber() && format["image_h"].isNumber())
     {
-        image_w = cJSON_GetObjectItem(format, "image_w")->valueint;
-        image_h = cJSON_GetObjectItem(format, "image_h")->valueint;
+        image_w = format["image_w"].asInt();
+        image_h = format["image_h"].asInt();
     }
     else
     {
-        std::cerr << "Invalid image width or height!" << std::endl;
-        cJSON_Delete(root);
+        LOG_ERROR("Invalid image width or height!");
         return;
     }
     // data_p->data 是视频数据，data_p->data_size 是视频数据大小
@@ -292,29 +296,29 @@ void AvvtnCapture::handleFaceRecognition(avvtn_callback_data_t *data_p)
     // resize操作在算力较弱或者占用较高的主板中可能会造成耗时过长，导致回调函数卡住，建议在实际生产环境中不要使用resize。
     cv::resize(receive_image_, resized_image_, cv::Size(image_w / scaling_factor_, image_h / scaling_factor_));
 
-    cJSON *list = cJSON_GetObjectItem(root, "list");
-    if (list == nullptr || cJSON_GetArraySize(list) == 0)
+    const JsonNode &list = doc["list"];
+    if (list.empty())
     {
-        std::cerr << "No face data found!" << std::endl;
-        cJSON_Delete(root);
+        LOG_DEBUG("No face data found!");
         return;
     }
     // 遍历每个人脸，绘制人脸框
-    int num_faces = cJSON_GetArraySize(list);
-    for (int i = 0; i < num_faces; ++i)
+    int i = -1;
+    for (const JsonNode &face : list)
     {
-        cJSON *face  = cJSON_GetArrayItem(list, i);
-        bool hasFace = cJSON_GetObjectItem(face, "hasFace")->valueint != 0;
+        ++i;
+        // hasFace/mouthOcc 兼容数字和布尔两种写法
+        bool hasFace = face["hasFace"].asInt(face["hasFace"].asBool()) != 0;
         if (!hasFace)
         {
             continue;
         }
         // 获取每个人脸的坐标和尺寸
-        int x         = cJSON_GetObjectItem(face, "x")->valueint;
-        int y         = cJSON_GetObjectItem(face, "y")->valueint;
-        int w         = cJSON_GetObjectItem(face, "w")->valueint;
-        int h         = cJSON_GetObjectItem(face, "h")->valueint;
-        bool mouthOcc = cJSON_GetObjectItem(face, "mouthOcc")->valueint != 0;
+        int x         = face["x"].asInt();
+        int y         = face["y"].asInt();
+        int w         = face["w"].asInt();
+        int h         = face["h"].asInt();
+        bool mouthOcc = face["mouthOcc"].asInt(face["mouthOcc"].asBool()) != 0;
         // 绘制人脸框，缩放坐标值
         cv::Scalar color = mouthOcc ? cv::Scalar(0, 0, 255) : cv::Scalar(0, 255, 0);
         cv::rectangle(resized_image_, cv::Point(x / scaling_factor_, y / scaling_factor_), cv::Point((x + w) / scaling_factor_, (y + h) / scaling_factor_), color, 2);
@@ -326,7 +330,6 @@ void AvvtnCapture::handleFaceRecognition(avvtn_callback_data_t *data_p)
         cv::Point text_pos(x / scaling_factor_, y / scaling_factor_ - 5);
         cv::putText(resized_image_, label, text_pos, cv::FONT_HERSHEY_SIMPLEX, 0.6, color, 2);
     }
-    cJSON_Delete(root);
 
 // 是否显示图像，建议在实际生产环境中不要在回调函数中显示图像，因为显示图像会占用大量算力，导致回调函数卡住。
 #if 1
@@ -344,16 +347,16 @@ void AvvtnCapture::handleAudioWake(avvtn_callback_data_t *data_p)
     ROSManager::getInstance().publishWakeupDetail(wake_str);
     /* 两次唤醒只发送一次wakeup给AIUI */
     std::string msg_type;
-    try {
-        // 解析 JSON
-        auto root = nlohmann::json::parse(wake_str);
+    JsonDocument doc;
+    if (doc.Parse(wake_str))
+    {
         // 提取 msg_type 字段
-        msg_type = root["msg_type"];
-        // 输出结果
-        std::cout << "msg_type: " << msg_type << std::endl;
-    } catch (nlohmann::json::exception& e) {
-        std::cerr << "JSON解析错误: " << e.what() << std::endl;
-        LOG_ERROR("JSON解析错误");
+        msg_type = doc["msg_type"].asString();
+        LOG_DEBUG("唤醒消息类型: %s", msg_type.c_str());
+    }
+    else
+    {
+        LOG_ERROR("JSON解析错误: %s", doc.ErrorMessage());
     }
     if(msg_type == "wakeup_detail")
     {
@@ -365,15 +368,12 @@ void AvvtnCapture::handleAudioWake(avvtn_callback_data_t *data_p)
     if (wake_mode_ == "ivw")
     {
         /*发送ROS2话题robot_avvtn_chat_history  问*/
-        nlohmann::json wake_up = {
-                {"speaker", "person"},
-                {"text", "灵犀灵犀"}
-        };
-        ROSManager::getInstance().publishChatHistory(wake_up.dump());
-        ROSManager::getInstance().publishChatHistoryNoStream(wake_up.dump());
+        std::string wake_up;
+        JsonWriter(wake_up).StartObject().Key("speaker").String("person").Key("text").String("灵犀灵犀").EndObject();
+        ROSManager::getInstance().publishChatHistory(wake_up);
+        ROSManager::getInstance().publishChatHistoryNoStream(wake_up);
 
         aiui_wrapper_.Wakeup();
     }
-    std::cout << "接收到唤醒事件: " << wake_str << std::endl;
     return;
 }
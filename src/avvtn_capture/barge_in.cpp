@@ -0,0 +1,87 @@
+#include "avvtn_capture/barge_in.h"
+
+#include <chrono>
+
+#include "utils/Logger.hpp"
+
+bool BargeInController::begin(const char *source)
+{
+    if (!enabled_)
+    {
+        return false;
+    }
+
+    // 两个触发源可能在不同线程几乎同时到达，只让第一个生效
+    long long now  = nowUs();
+    long long last = onset_us_.load();
+    if (last != 0 && now - last < (long long)debounce_ms_ * 1000)
+    {
+        return false;
+    }
+    if (!onset_us_.compare_exchange_strong(last, now))
+    {
+        return false;
+    }
+
+    silenced_us_ = 0;
+    LOG_INFO("检测到用户开口(%s)，打断播放", source);
+    return true;
+}
+
+void BargeInController::silenced()
+{
+    long long now   = nowUs();
+    long long onset = onset_us_.load();
+    silenced_us_    = now;
+
+    long long latency = now - onset;
+    int count         = ++count_;
+    latency_total_us_ += latency;
+    long long max = latency_max_us_.load();
+    while (latency > max && !latency_max_us_.compare_exchange_weak(max, latency))
+    {
+    }
+
+    LOG_INFO("打断完成: 开口到停播 %.2f ms, 累计 %d 次, 平均 %.2f ms", latency / 1000.0, count, latency_total_us_.load() / 1000.0 / count);
+}
+
+void BargeInController::onPlayerProgress()
+{
+    long long silenced = silenced_us_.load();
+    if (silenced == 0)
+    {
+        return;
+    }
+
+    long long now = nowUs();
+    if (now - silenced > kLateProgressWindowUs || !silenced_us_.compare_exchange_strong(silenced, now))
+    {
+        return;
+    }
+
+    // 静音时刻推后，延迟统计补上这一段
+    long long extra = now - silenced;
+    late_progress_++;
+    latency_total_us_ += extra;
+    long long latency = now - onset_us_.load();
+    long long max     = latency_max_us_.load();
+    while (latency > max && !latency_max_us_.compare_exchange_weak(max, latency))
+    {
+    }
+    LOG_WARN("停播后仍有播放进度，开口到静音 %.2f ms", latency / 1000.0);
+}
+
+BargeInController::Stats BargeInController::getStats() const
+{
+    Stats stats;
+    stats.count          = count_.load();
+    stats.late_progress  = late_progress_.load();
+    stats.avg_latency_ms = stats.count > 0 ? latency_total_us_.load() / 1000.0 / stats.count : 0;
+    stats.max_latency_ms = latency_max_us_.load() / 1000.0;
+    return stats;
+}
+
+long long BargeInController::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
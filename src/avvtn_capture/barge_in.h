@@ -0,0 +1,66 @@
+/**
+ * @file barge_in.h
+ * @brief 打断控制：机器人说话时检测到用户开口，立即停掉播放
+ * @details 触发源有两个：降噪引擎识别音频的vad_status开始说话（最早），以及AIUI的VAD_BOS。
+ *          两者对同一次开口都会触发，begin()按时间窗去重。停播本身由调用方完成，
+ *          这里只负责去重和测速：从检测到开口到播放器停下（以及停下后仍收到的播放进度）的耗时。
+ */
+#ifndef BARGE_IN_H
+#define BARGE_IN_H
+
+#include <atomic>
+
+class BargeInController
+{
+public:
+    struct Stats
+    {
+        int count             = 0;    // 打断次数
+        int late_progress     = 0;    // 停播后仍收到播放进度的次数
+        double avg_latency_ms = 0;    // 开口到静音的平均耗时
+        double max_latency_ms = 0;
+    };
+
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    bool isEnabled() const { return enabled_; }
+
+    void setDebounceMs(int debounce_ms) { debounce_ms_ = debounce_ms; }
+
+    /**
+     * @brief 检测到用户开口
+     * @param source 触发源，用于日志
+     * @return 需要打断返回true，调用方随后停播并调用silenced()；同一次开口的重复触发返回false
+     */
+    bool begin(const char *source);
+
+    /**
+     * @brief 播放器已停下，记录开口到静音的耗时
+     */
+    void silenced();
+
+    /**
+     * @brief 播放器进度回调，停播后短时间内仍有进度说明还有音频漏出，把静音时刻往后推
+     */
+    void onPlayerProgress();
+
+    Stats getStats() const;
+
+private:
+    static long long nowUs();
+
+    // 停播后这段时间内的播放进度都算漏出的音频
+    static const long long kLateProgressWindowUs = 500 * 1000;
+
+    bool enabled_    = true;
+    int debounce_ms_ = 800;
+
+    std::atomic<long long> onset_us_{ 0 };       // 本次开口的时间
+    std::atomic<long long> silenced_us_{ 0 };    // 最近一次确认静音的时间
+
+    std::atomic<int> count_{ 0 };
+    std::atomic<int> late_progress_{ 0 };
+    std::atomic<long long> latency_total_us_{ 0 };
+    std::atomic<long long> latency_max_us_{ 0 };
+};
+
+#endif    // BARGE_IN_H
@@ -0,0 +1,118 @@
+#include "avvtn_capture/conversation_state.h"
+
+#include <chrono>
+
+#include "utils/Logger.hpp"
+
+void ConversationState::start()
+{
+    publish();
+}
+
+void ConversationState::onPlaybackBegin()
+{
+    last_progress_ms_ = nowMs();
+    update(FLAG_PLAYING, FLAG_STOPPED);
+}
+
+void ConversationState::onPlaybackProgress(bool completed)
+{
+    if (completed)
+    {
+        last_progress_ms_ = 0;
+        update(0, FLAG_PLAYING);
+        return;
+    }
+
+    // 停止之后的旧进度回调不能把状态改回播放中
+    if ((state_.load() & FLAG_STOPPED) == 0)
+    {
+        last_progress_ms_ = nowMs();
+    }
+    update(FLAG_PLAYING, 0, FLAG_STOPPED);
+}
+
+void ConversationState::onPlaybackStopped()
+{
+    last_progress_ms_ = 0;
+    update(FLAG_STOPPED, FLAG_PLAYING);
+}
+
+bool ConversationState::checkPlaybackStall()
+{
+    long long last = last_progress_ms_.load();
+    if (last == 0 || nowMs() - last < kStallMs || !last_progress_ms_.compare_exchange_strong(last, 0))
+    {
+        return false;
+    }
+
+    if (!update(0, FLAG_PLAYING))
+    {
+        return false;
+    }
+    LOG_INFO("播放器 %lld ms 无进度且未报播完，按播放结束处理", kStallMs);
+    return true;
+}
+
+bool ConversationState::update(uint32_t set, uint32_t clear, uint32_t unless)
+{
+    uint32_t old_state = state_.load();
+    uint32_t new_state;
+    do
+    {
+        if (old_state & unless)
+        {
+            return false;
+        }
+        new_state = (old_state | set) & ~clear;
+        if (new_state == old_state)
+        {
+            return false;
+        }
+    } while (!state_.compare_exchange_weak(old_state, new_state));
+
+    if (statusOf(old_state) != statusOf(new_state))
+    {
+        publish();
+    }
+    return true;
+}
+
+void ConversationState::publish()
+{
+    dirty_ = true;
+    // 别的线程正在发布时由它把最新状态发出去，这里不等待
+    while (dirty_.load() && !publishing_.exchange(true))
+    {
+        dirty_             = false;
+        const char *status = statusOf(state_.load());
+        if (status != published_)
+        {
+            published_ = status;
+            LOG_INFO("对话状态: %s", status);
+            if (publisher_)
+            {
+                publisher_(status);
+            }
+        }
+        publishing_ = false;
+    }
+}
+
+const char *ConversationState::statusOf(uint32_t state)
+{
+    if (state & (FLAG_PLAYING | FLAG_LISTENING))
+    {
+        return "STATUS_IN_CONVERSATION";
+    }
+    if (state & FLAG_AWAKE)
+    {
+        return "STATUS_WAITING_CONVERSATION";
+    }
+    return "STATUS_WAITING_WAKEUP";
+}
+
+long long ConversationState::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
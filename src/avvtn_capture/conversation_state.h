@@ -0,0 +1,106 @@
+/**
+ * @file conversation_state.h
+ * @brief 对话状态机：由播放器、AIUI唤醒/休眠和VAD事件驱动，状态变化时才发布ROS状态
+ * @details 状态是几个标志位打包成的一个原子字，各回调线程用CAS修改，不加锁。
+ *          对外状态由标志位推出：机器人在说或用户在说为STATUS_IN_CONVERSATION，
+ *          否则已唤醒为STATUS_WAITING_CONVERSATION，未唤醒为STATUS_WAITING_WAKEUP。
+ *          播完以播放器的isCompleted/onStopped为准，不再轮询；只有播放器既没报完成、
+ *          又长时间没有进度时，才由checkPlaybackStall()兜底判定播放结束。
+ *          停止之后、下一段播放开始之前到达的进度回调是stop()之前排队的旧回调，忽略。
+ */
+#ifndef CONVERSATION_STATE_H
+#define CONVERSATION_STATE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+class ConversationState
+{
+public:
+    /**
+     * @brief 状态发布函数，参数为STATUS_xxx字符串
+     */
+    typedef std::function<void(const char *status)> Publisher;
+
+    void setPublisher(const Publisher &publisher) { publisher_ = publisher; }
+
+    /**
+     * @brief 发布当前状态，初始化完成时调用一次
+     */
+    void start();
+
+    void onWakeup() { update(FLAG_AWAKE, 0); }
+
+    /**
+     * @brief 休眠后用户不再处于说话状态；正在播的话播完才回到等待唤醒
+     */
+    void onSleep() { update(0, FLAG_AWAKE | FLAG_LISTENING); }
+
+    void onUserSpeechStart() { update(FLAG_LISTENING, 0); }
+
+    void onUserSpeechEnd() { update(0, FLAG_LISTENING); }
+
+    /**
+     * @brief 新一段播放开始（播放器启动或写入首块），之后的进度回调才有效
+     */
+    void onPlaybackBegin();
+
+    /**
+     * @brief 播放器进度回调
+     * @param completed 播完最后一块
+     */
+    void onPlaybackProgress(bool completed);
+
+    /**
+     * @brief 播放器被停止或清空
+     */
+    void onPlaybackStopped();
+
+    /**
+     * @brief 播放中却超过kStallMs没有进度，判定播放结束
+     * @details 在每帧都会到的降噪音频回调中顺带调用，不单独起线程
+     * @return 本次调用判定了播放结束返回true
+     */
+    bool checkPlaybackStall();
+
+    bool isPlaying() const { return (state_.load() & FLAG_PLAYING) != 0; }
+
+    bool isSleeping() const { return (state_.load() & FLAG_AWAKE) == 0; }
+
+private:
+    enum Flag : uint32_t
+    {
+        FLAG_AWAKE     = 1u << 0,    // 已唤醒
+        FLAG_PLAYING   = 1u << 1,    // 机器人在说话
+        FLAG_LISTENING = 1u << 2,    // 用户在说话（AIUI VAD的BOS到EOS之间）
+        FLAG_STOPPED   = 1u << 3     // 播放被停止，下一段播放开始前的进度回调忽略；不影响对外状态
+    };
+
+    /**
+     * @brief 置位set、清除clear，状态有变化时发布
+     * @param unless 当前状态含这些位时不修改
+     * @return 状态有变化返回true
+     */
+    bool update(uint32_t set, uint32_t clear, uint32_t unless = 0);
+
+    void publish();
+
+    static const char *statusOf(uint32_t state);
+    static long long nowMs();
+
+    // 播放器没报完成时，这么久没有进度才算播完；流式合成分段之间的断档不应触发
+    static const long long kStallMs = 2000;
+
+    Publisher publisher_;
+
+    std::atomic<uint32_t> state_{ 0 };
+    std::atomic<long long> last_progress_ms_{ 0 };
+
+    // 发布由抢到publishing_的线程完成，其他线程只置dirty_，保证最后发出的是最新状态
+    std::atomic<bool> publishing_{ false };
+    std::atomic<bool> dirty_{ false };
+    const char *published_ = nullptr;    // 只在持有publishing_时访问
+};
+
+#endif    // CONVERSATION_STATE_H
@@ -0,0 +1,220 @@
+#include "avvtn_capture/early_command.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "utils/Logger.hpp"
+
+void EarlyCommand::setPhrases(const std::vector<std::string> &stop_phrases, const std::vector<std::string> &shut_up_phrases)
+{
+    automaton_ = AhoCorasick();
+    phrases_.clear();
+    for (const std::string &phrase : stop_phrases)
+    {
+        automaton_.add(phrase, (int)phrases_.size());
+        phrases_.emplace_back(phrase, ACTION_STOP);
+    }
+    for (const std::string &phrase : shut_up_phrases)
+    {
+        automaton_.add(phrase, (int)phrases_.size());
+        phrases_.emplace_back(phrase, ACTION_SHUT_UP);
+    }
+    automaton_.build();
+}
+
+int EarlyCommand::onPartial(const std::string &sid, const std::string &text, size_t stable_len, std::string *phrase)
+{
+    if (!enabled_ || automaton_.empty())
+    {
+        return ACTION_NONE;
+    }
+
+    if (sid != sid_)
+    {
+        // 上一轮本地触发了却一直没等到技能结果，按误触发结算
+        if (!fired_sid_.empty() && fired_sid_ != sid)
+        {
+            settleFired();
+        }
+        sid_            = sid;
+        stable_state_   = 0;
+        stable_scanned_ = 0;
+        tail_actions_   = 0;
+        tail_count_     = 0;
+    }
+
+    int already = fired_sid_ == sid ? fired_actions_ : 0;
+    stable_len  = (std::min)(stable_len, text.size());
+    if (stable_len < stable_scanned_)
+    {
+        // 修正改到了已扫描的稳定前缀，从头重扫
+        stable_state_   = 0;
+        stable_scanned_ = 0;
+    }
+
+    int hits        = scan(stable_state_, text, stable_scanned_, stable_len, phrase) & ~already;
+    stable_scanned_ = stable_len;
+    if (hits != ACTION_NONE)
+    {
+        return fire(hits);
+    }
+
+    if (unstable_confirm_ <= 0)
+    {
+        return ACTION_NONE;
+    }
+
+    // 尾巴接着稳定前缀的状态扫，跨边界的短语也能命中
+    int tail_state = stable_state_;
+    std::string tail_phrase;
+    int tail = scan(tail_state, text, stable_len, text.size(), &tail_phrase) & ~already;
+    tail_count_   = (tail & tail_actions_) != 0 ? tail_count_ + 1 : (tail != ACTION_NONE ? 1 : 0);
+    tail_actions_ = tail_count_ > 1 ? (tail & tail_actions_) : tail;
+    if (tail_actions_ != ACTION_NONE && tail_count_ >= unstable_confirm_)
+    {
+        if (phrase != nullptr)
+        {
+            *phrase = tail_phrase;
+        }
+        return fire(tail_actions_);
+    }
+    return ACTION_NONE;
+}
+
+void EarlyCommand::recordStopLatency(double latency_ms)
+{
+    long long latency_us = (long long)(latency_ms * 1000);
+    stop_total_us_ += latency_us;
+    stop_count_++;
+    long long max_us = stop_max_us_;
+    while (latency_us > max_us && !stop_max_us_.compare_exchange_weak(max_us, latency_us))
+    {
+    }
+}
+
+int EarlyCommand::reconcile(const std::string &sid, const std::string &cloud_type)
+{
+    if (!reconciled_sid_.empty() && sid == reconciled_sid_)
+    {
+        return reconciled_actions_;
+    }
+
+    Action cloud = actionOf(cloud_type);
+    int fired    = fired_sid_ == sid ? fired_actions_ : 0;
+    if (fired != ACTION_NONE)
+    {
+        long long lead = nowMs() - fired_ms_;
+        lead_total_ms_ += lead;
+        lead_count_++;
+        confirmed_ += bitCount(fired & cloud);
+        false_triggers_ += bitCount(fired & ~cloud);
+        fired_sid_.clear();
+        fired_actions_ = 0;
+
+        Stats stats = getStats();
+        LOG_INFO("提前指令对账: 本地 %s, 云端 %s, 比云端早 %lld ms; 累计触发 %d 次 一致 %d 次 误触发 %d 次 漏检 %d 次, 触发到停止平均 %.1f ms",
+                 actionName(fired), cloud_type.empty() ? "无" : cloud_type.c_str(), lead, stats.fired, stats.confirmed, stats.false_triggers,
+                 stats.missed, stats.avg_stop_ms);
+    }
+    else if (enabled_ && cloud != ACTION_NONE)
+    {
+        missed_++;
+        LOG_INFO("提前指令漏检: 云端 %s, 识别中间结果中没有检出", cloud_type.c_str());
+    }
+
+    reconciled_sid_     = sid;
+    reconciled_actions_ = fired;
+    return fired;
+}
+
+EarlyCommand::Stats EarlyCommand::getStats() const
+{
+    Stats stats;
+    stats.fired          = fired_count_;
+    stats.confirmed      = confirmed_;
+    stats.false_triggers = false_triggers_;
+    stats.missed         = missed_;
+    stats.avg_lead_ms    = lead_count_ > 0 ? (double)lead_total_ms_ / lead_count_ : 0;
+    int stop_count       = stop_count_;
+    stats.avg_stop_ms    = stop_count > 0 ? stop_total_us_ / 1000.0 / stop_count : 0;
+    stats.max_stop_ms    = stop_max_us_ / 1000.0;
+    return stats;
+}
+
+int EarlyCommand::scan(int &state, const std::string &text, size_t begin, size_t end, std::string *phrase) const
+{
+    if (begin >= end)
+    {
+        return ACTION_NONE;
+    }
+
+    int actions = ACTION_NONE;
+    state       = automaton_.scan(state, text.data() + begin, end - begin, [&](int id, size_t) {
+        if (actions == ACTION_NONE && phrase != nullptr)
+        {
+            *phrase = phrases_[id].first;
+        }
+        actions |= phrases_[id].second;
+        return true;
+    });
+    return actions;
+}
+
+int EarlyCommand::fire(int actions)
+{
+    if (fired_sid_ != sid_)
+    {
+        fired_sid_     = sid_;
+        fired_actions_ = 0;
+        fired_ms_      = nowMs();
+    }
+    fired_actions_ |= actions;
+    fired_count_ += bitCount(actions);
+    return actions;
+}
+
+void EarlyCommand::settleFired()
+{
+    false_triggers_ += bitCount(fired_actions_);
+    LOG_INFO("提前指令: 会话 %s 本地触发了 %s，没有等到对应的技能结果，记为误触发", fired_sid_.c_str(), actionName(fired_actions_));
+    fired_sid_.clear();
+    fired_actions_ = 0;
+}
+
+EarlyCommand::Action EarlyCommand::actionOf(const std::string &cloud_type)
+{
+    if (cloud_type == "stop")
+    {
+        return ACTION_STOP;
+    }
+    if (cloud_type == "shut_up")
+    {
+        return ACTION_SHUT_UP;
+    }
+    return ACTION_NONE;
+}
+
+const char *EarlyCommand::actionName(int actions)
+{
+    switch (actions)
+    {
+        case ACTION_STOP:
+            return "stop";
+        case ACTION_SHUT_UP:
+            return "shut_up";
+        case ACTION_STOP | ACTION_SHUT_UP:
+            return "stop+shut_up";
+        default:
+            return "无";
+    }
+}
+
+int EarlyCommand::bitCount(int actions)
+{
+    return ((actions & ACTION_STOP) != 0 ? 1 : 0) + ((actions & ACTION_SHUT_UP) != 0 ? 1 : 0);
+}
+
+long long EarlyCommand::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,121 @@
+/**
+ * @file early_command.h
+ * @brief 在识别中间结果上提前检出停止类指令
+ * @details 停止、闭嘴这类指令走完整的云端识别、语义和技能处理要好几秒，机器人在动时太慢。
+ *          这里把配置中的短语编进Aho-Corasick自动机，在识别中间结果上匹配：
+ *          稳定前缀逐段增量扫描，命中即触发；还可能被修正的尾巴上命中的短语，
+ *          要在连续几条中间结果中都出现才触发。每个会话每类指令只触发一次。
+ *          云端语义结果到达后调用reconcile()对账：一致则本地已执行过、技能处理跳过重复执行，
+ *          不一致或没有等到对应的技能结果计为误触发；云端是停止类而本地没检出计为漏检。
+ *          除recordStopLatency()外只在AIUI回调线程中调用，不加锁。
+ */
+#ifndef EARLY_COMMAND_H
+#define EARLY_COMMAND_H
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/AhoCorasick.h"
+
+class EarlyCommand
+{
+public:
+    enum Action
+    {
+        ACTION_NONE    = 0,
+        ACTION_STOP    = 1 << 0,    // 停止运动，对应技能type "stop"
+        ACTION_SHUT_UP = 1 << 1     // 停止说话，对应技能type "shut_up"
+    };
+
+    struct Stats
+    {
+        int fired            = 0;
+        int confirmed        = 0;    // 云端语义与本地一致
+        int false_triggers   = 0;    // 本地触发而云端不是这类指令
+        int missed           = 0;    // 云端是停止类指令而本地没有检出
+        double avg_lead_ms   = 0;    // 本地触发比云端语义结果早多少
+        double avg_stop_ms   = 0;    // 触发到停止请求完成的平均耗时
+        double max_stop_ms   = 0;
+    };
+
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+
+    /**
+     * @param confirm_partials 尾巴上的命中要连续出现的中间结果条数，0为只看稳定前缀
+     */
+    void setUnstableConfirm(int confirm_partials) { unstable_confirm_ = confirm_partials; }
+
+    /**
+     * @brief 设置短语并编译自动机
+     */
+    void setPhrases(const std::vector<std::string> &stop_phrases, const std::vector<std::string> &shut_up_phrases);
+
+    /**
+     * @brief 收到一条识别结果
+     * @param stable_len 整句中不会再被修正的前缀字节数
+     * @param phrase 触发时返回命中的短语
+     * @return 本条结果触发的指令（按位或），ACTION_NONE为不触发
+     */
+    int onPartial(const std::string &sid, const std::string &text, size_t stable_len, std::string *phrase);
+
+    /**
+     * @brief 记录触发到停止请求完成的耗时，在指令客户端线程中调用
+     */
+    void recordStopLatency(double latency_ms);
+
+    /**
+     * @brief 云端技能结果到达时对账
+     * @param cloud_type 技能结果的type，没有时为空
+     * @return 该会话本地已触发过的指令（按位或），调用方据此跳过重复执行
+     */
+    int reconcile(const std::string &sid, const std::string &cloud_type);
+
+    Stats getStats() const;
+
+private:
+    static Action actionOf(const std::string &cloud_type);
+    static const char *actionName(int actions);
+    static int bitCount(int actions);
+    static long long nowMs();
+
+    // 扫描text[begin, end)，返回命中的指令（按位或），phrase为第一个命中的短语
+    int scan(int &state, const std::string &text, size_t begin, size_t end, std::string *phrase) const;
+
+    int fire(int actions);
+
+    void settleFired();
+
+    bool enabled_          = true;
+    int unstable_confirm_  = 2;
+    AhoCorasick automaton_;
+    std::vector<std::pair<std::string, Action>> phrases_;    // 下标即自动机中的编号
+
+    // 当前会话
+    std::string sid_;
+    int stable_state_       = 0;    // 稳定前缀的扫描状态
+    size_t stable_scanned_  = 0;    // 稳定前缀已扫描的字节数
+    int tail_actions_       = 0;    // 上一条结果的尾巴上命中的指令
+    int tail_count_         = 0;    // tail_actions_连续出现的条数
+
+    // 本地触发、等待云端对账的会话
+    std::string fired_sid_;
+    int fired_actions_      = 0;
+    long long fired_ms_     = 0;
+
+    int fired_count_        = 0;
+    int confirmed_          = 0;
+    int false_triggers_     = 0;
+    int missed_             = 0;
+    long long lead_total_ms_ = 0;
+    int lead_count_         = 0;
+    std::string reconciled_sid_;       // 同一会话可能有多条技能结果，只对账一次
+    int reconciled_actions_ = 0;
+    // 停止耗时由指令客户端线程写入
+    std::atomic<int> stop_count_{ 0 };
+    std::atomic<long long> stop_total_us_{ 0 };
+    std::atomic<long long> stop_max_us_{ 0 };
+};
+
+#endif    // EARLY_COMMAND_H
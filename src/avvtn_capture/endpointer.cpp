@@ -0,0 +1,213 @@
+#include "avvtn_capture/endpointer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "utils/Logger.hpp"
+
+void Endpointer::setSuffixes(const std::vector<std::string> &final_suffixes, const std::vector<std::string> &continuation_suffixes)
+{
+    final_suffixes_        = final_suffixes;
+    continuation_suffixes_ = continuation_suffixes;
+}
+
+void Endpointer::write(const char *data, int len, bool is_stop)
+{
+    if (!enabled_)
+    {
+        if (writer_)
+        {
+            writer_(data, len, is_stop);
+        }
+        return;
+    }
+
+    long long now = nowMs();
+    if (is_stop)
+    {
+        if (cut_)
+        {
+            // 已提前结束过，引擎这次的说话结束不再上送
+            long long saved = now - cut_ms_;
+            saved_ms_ += saved;
+            saved_count_++;
+            cut_ = false;
+            LOG_INFO("端点检测: 引擎报说话结束，比提前结束晚 %lld ms", saved);
+            logStats();
+        }
+        else if (writer_)
+        {
+            writer_(nullptr, 0, true);
+        }
+        session_open_ = false;
+        return;
+    }
+
+    bool voiced = frameRms(data, len) >= silence_rms_;
+    if (cut_)
+    {
+        if (!voiced)
+        {
+            return;
+        }
+        false_cuts_++;
+        cut_ = false;
+        LOG_INFO("端点检测: 提前结束 %lld ms 后用户又开口，记为误切，作为新的一句上送", now - cut_ms_);
+        logStats();
+    }
+
+    if (!session_open_)
+    {
+        session_open_ = true;
+        resetTurn();
+    }
+    if (writer_)
+    {
+        writer_(data, len, false);
+    }
+
+    // 16k采样16bit单声道，每毫秒32字节
+    int frame_ms = len / 32;
+    if (voiced)
+    {
+        // 说话结束后引擎仍持续输出静音帧，有声音的才算一句
+        if (speech_ms_ == 0)
+        {
+            turns_++;
+        }
+        speech_ms_ += frame_ms;
+        silence_ms_ = 0;
+    }
+    else
+    {
+        silence_ms_ += frame_ms;
+    }
+    if (speech_ms_ < min_speech_ms_ || silence_ms_ < final_silence_ms_)
+    {
+        return;
+    }
+
+    Completeness state = completeness(now);
+    if (state == FINAL)
+    {
+        cut("句末语气词", now);
+    }
+    else if (state == STABLE && silence_ms_ >= stable_silence_ms_)
+    {
+        cut("识别文本已稳定", now);
+    }
+}
+
+void Endpointer::setTranscript(const std::string &text, size_t stable_len)
+{
+    std::lock_guard<std::mutex> lock(transcript_mutex_);
+    if (text != text_)
+    {
+        text_    = text;
+        text_ms_ = nowMs();
+    }
+    stable_len_ = stable_len;
+}
+
+Endpointer::Stats Endpointer::getStats() const
+{
+    Stats stats;
+    stats.turns        = turns_;
+    stats.early_cuts   = early_cuts_;
+    stats.false_cuts   = false_cuts_;
+    stats.saved_ms     = saved_ms_;
+    stats.avg_saved_ms = saved_count_ > 0 ? (double)saved_ms_ / saved_count_ : 0;
+    return stats;
+}
+
+Endpointer::Completeness Endpointer::completeness(long long now)
+{
+    std::lock_guard<std::mutex> lock(transcript_mutex_);
+    if (text_.empty())
+    {
+        return INCOMPLETE;
+    }
+    for (const std::string &suffix : continuation_suffixes_)
+    {
+        if (endsWith(text_, suffix))
+        {
+            return INCOMPLETE;
+        }
+    }
+    for (const std::string &suffix : final_suffixes_)
+    {
+        if (endsWith(text_, suffix))
+        {
+            return FINAL;
+        }
+    }
+    if (stable_len_ >= text_.size() || now - text_ms_ >= stable_ms_)
+    {
+        return STABLE;
+    }
+    return UNKNOWN;
+}
+
+void Endpointer::cut(const char *reason, long long now)
+{
+    {
+        std::lock_guard<std::mutex> lock(transcript_mutex_);
+        cut_text_ = text_;
+    }
+    LOG_INFO("端点检测: %s，尾静音 %d ms 时提前结束上送, 文本: %s", reason, silence_ms_, cut_text_.c_str());
+    if (writer_)
+    {
+        writer_(nullptr, 0, true);
+    }
+    cut_          = true;
+    cut_ms_       = now;
+    session_open_ = false;
+    early_cuts_++;
+}
+
+void Endpointer::resetTurn()
+{
+    speech_ms_  = 0;
+    silence_ms_ = 0;
+    std::lock_guard<std::mutex> lock(transcript_mutex_);
+    text_.clear();
+    stable_len_ = 0;
+    text_ms_    = 0;
+}
+
+void Endpointer::logStats()
+{
+    Stats stats = getStats();
+    LOG_INFO("端点检测: 共 %d 句, 提前结束 %d 句, 误切 %d 次(%.1f%%), 平均节省 %.0f ms, 累计节省 %lld ms", stats.turns, stats.early_cuts,
+             stats.false_cuts, stats.early_cuts > 0 ? stats.false_cuts * 100.0 / stats.early_cuts : 0.0, stats.avg_saved_ms, stats.saved_ms);
+}
+
+bool Endpointer::endsWith(const std::string &text, const std::string &suffix)
+{
+    return !suffix.empty() && text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int Endpointer::frameRms(const char *data, int len)
+{
+    int count = len / 2;
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int16_t sample;
+        memcpy(&sample, data + i * 2, sizeof(sample));
+        sum += (double)sample * sample;
+    }
+    return (int)std::sqrt(sum / count);
+}
+
+long long Endpointer::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,120 @@
+/**
+ * @file endpointer.h
+ * @brief 语义端点检测：一句话明显说完时不等引擎VAD的尾静音，提前结束识别音频上送
+ * @details 引擎在尾静音达到avvtn.cfg的vad_eos（500 ms）后才报说话结束，每轮都要白等这段时间。
+ *          这里串在上送通路上，自己按帧能量统计尾静音，再结合识别中间结果判断这句话是否完整：
+ *          以语气词或句末标点结尾的，尾静音达到final_silence_ms就结束；
+ *          文本已全部稳定或一段时间没有变化的，尾静音达到stable_silence_ms结束；
+ *          以"然后""还有"这类连接词结尾的不提前结束，交给引擎判断。
+ *          提前结束后，到引擎报说话结束之前的静音帧不再上送；期间用户又开口算一次误切，
+ *          从这一帧起作为新的一句继续上送。引擎随后报的说话结束与提前结束之间的时间计为节省的延迟。
+ *          write()只在降噪引擎回调线程中调用，setTranscript()在AIUI回调线程中调用。
+ */
+#ifndef ENDPOINTER_H
+#define ENDPOINTER_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Endpointer
+{
+public:
+    /**
+     * @brief 上送音频的函数，参数同AiuiWrapper::WriteAudio
+     */
+    typedef std::function<void(const char *data, int len, bool is_stop)> Writer;
+
+    struct Stats
+    {
+        int turns            = 0;    // 上送过的有声音的句数
+        int early_cuts       = 0;    // 提前结束的句数
+        int false_cuts       = 0;    // 提前结束后用户又接着说的次数
+        double avg_saved_ms  = 0;    // 提前结束到引擎报说话结束的平均时间
+        long long saved_ms   = 0;    // 累计节省的时间
+    };
+
+    void setWriter(const Writer &writer) { writer_ = writer; }
+
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+
+    void setSilenceRms(int silence_rms) { silence_rms_ = silence_rms; }
+
+    void setMinSpeechMs(int min_speech_ms) { min_speech_ms_ = min_speech_ms; }
+
+    void setFinalSilenceMs(int final_silence_ms) { final_silence_ms_ = final_silence_ms; }
+
+    void setStableSilenceMs(int stable_silence_ms) { stable_silence_ms_ = stable_silence_ms; }
+
+    void setStableMs(int stable_ms) { stable_ms_ = stable_ms; }
+
+    /**
+     * @param final_suffixes 说明一句话已完整的结尾，如语气词、句末标点
+     * @param continuation_suffixes 说明后面还有话的结尾，如连接词
+     */
+    void setSuffixes(const std::vector<std::string> &final_suffixes, const std::vector<std::string> &continuation_suffixes);
+
+    /**
+     * @brief 上送一帧识别音频或结束上送，由上行门控调用
+     */
+    void write(const char *data, int len, bool is_stop);
+
+    /**
+     * @brief 当前这句话的识别中间结果
+     * @param stable_len 整句中不会再被修正的前缀字节数
+     */
+    void setTranscript(const std::string &text, size_t stable_len);
+
+    Stats getStats() const;
+
+private:
+    enum Completeness
+    {
+        INCOMPLETE,    // 没有文本或以连接词结尾
+        UNKNOWN,       // 文本还在变
+        STABLE,        // 文本全部稳定或一段时间没变
+        FINAL          // 以语气词或句末标点结尾
+    };
+
+    Completeness completeness(long long now);
+    void cut(const char *reason, long long now);
+    void resetTurn();
+    void logStats();
+
+    static bool endsWith(const std::string &text, const std::string &suffix);
+    static int frameRms(const char *data, int len);
+    static long long nowMs();
+
+    Writer writer_;
+    bool enabled_          = false;
+    int silence_rms_       = 300;
+    int min_speech_ms_     = 300;
+    int final_silence_ms_  = 200;
+    int stable_silence_ms_ = 350;
+    int stable_ms_         = 300;
+    std::vector<std::string> final_suffixes_;
+    std::vector<std::string> continuation_suffixes_;
+
+    // 以下只在引擎回调线程中访问
+    bool session_open_   = false;    // 已上送音频、还没结束
+    bool cut_            = false;    // 已提前结束，等引擎报说话结束
+    long long cut_ms_    = 0;
+    int speech_ms_       = 0;        // 本句有声音的时长
+    int silence_ms_      = 0;        // 当前尾静音时长
+    std::string cut_text_;
+
+    // 识别中间结果，AIUI回调线程写
+    std::mutex transcript_mutex_;
+    std::string text_;
+    size_t stable_len_      = 0;
+    long long text_ms_      = 0;    // 文本最后一次变化的时间
+
+    int turns_              = 0;
+    int early_cuts_         = 0;
+    int false_cuts_         = 0;
+    int saved_count_        = 0;
+    long long saved_ms_     = 0;
+};
+
+#endif    // ENDPOINTER_H
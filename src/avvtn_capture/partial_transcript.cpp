@@ -0,0 +1,119 @@
+#include "avvtn_capture/partial_transcript.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "utils/JsonDocument.h"
+
+void PartialTranscript::update(const std::string &sid, const std::string &text, size_t stable_len, bool final)
+{
+    if (!enabled_)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sid != sid_)
+    {
+        sid_ = sid;
+        sent_text_.clear();
+        seq_          = 0;
+        last_send_ms_ = 0;
+    }
+    text_       = text;
+    stable_len_ = stable_len;
+    final_      = final;
+
+    // rpl修正后整句没变的结果不发，最后一条仍要发出，接收端据此定稿
+    if (!final && text_ == sent_text_)
+    {
+        pending_ = false;
+        skipped_++;
+        return;
+    }
+
+    long long now = nowMs();
+    if (final || now - last_send_ms_ >= min_interval_ms_)
+    {
+        sendLocked(now);
+        return;
+    }
+    pending_ = true;
+    skipped_++;
+}
+
+void PartialTranscript::poll()
+{
+    if (!pending_)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    long long now = nowMs();
+    if (pending_ && now - last_send_ms_ >= min_interval_ms_)
+    {
+        skipped_--;    // 压下的这条最终发出去了
+        sendLocked(now);
+    }
+}
+
+void PartialTranscript::sendLocked(long long now)
+{
+    // 与上次发出的文本的公共前缀，退到UTF-8字符边界
+    size_t common = 0;
+    size_t limit  = std::min(text_.size(), sent_text_.size());
+    while (common < limit && text_[common] == sent_text_[common])
+    {
+        common++;
+    }
+    while (common > 0 && common < text_.size() && ((unsigned char)text_[common] & 0xC0) == 0x80)
+    {
+        common--;
+    }
+
+    std::string message;
+    JsonWriter(message)
+        .StartObject()
+        .Key("sid")
+        .String(sid_)
+        .Key("seq")
+        .Int(seq_)
+        .Key("keep")
+        .Int((int64_t)utf8Count(text_, common))
+        .Key("append")
+        .String(text_.data() + common, text_.size() - common)
+        .Key("stable")
+        .Int((int64_t)utf8Count(text_, std::min(stable_len_, text_.size())))
+        .Key("final")
+        .Bool(final_)
+        .EndObject();
+    if (publisher_)
+    {
+        publisher_(message);
+    }
+
+    sent_text_    = text_;
+    seq_++;
+    last_send_ms_ = now;
+    pending_      = false;
+    sent_++;
+}
+
+size_t PartialTranscript::utf8Count(const std::string &text, size_t bytes)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        if (((unsigned char)text[i] & 0xC0) != 0x80)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+long long PartialTranscript::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
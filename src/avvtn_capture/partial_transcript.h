@@ -0,0 +1,71 @@
+/**
+ * @file partial_transcript.h
+ * @brief 用户说话过程中实时发布识别中间结果
+ * @details 每条wpgs中间结果都会改写整句，直接逐条发布既频繁又大多是重复内容。
+ *          这里按最小间隔限流、内容没变不发，每条消息只带与上次发出的文本不同的后缀：
+ *          {"sid":"...","seq":3,"keep":5,"append":"天气怎么样","stable":4,"final":false}
+ *          接收端把已显示文本截到前keep个字再接上append；keep和stable都按UTF-8字符计。
+ *          限流期间被压下的最新结果由poll()在到期后补发，最后一条结果不受限流。
+ */
+#ifndef PARTIAL_TRANSCRIPT_H
+#define PARTIAL_TRANSCRIPT_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+
+class PartialTranscript
+{
+public:
+    typedef std::function<void(const std::string &message)> Publisher;
+
+    void setPublisher(const Publisher &publisher) { publisher_ = publisher; }
+
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+
+    void setMinIntervalMs(int interval_ms) { min_interval_ms_ = interval_ms; }
+
+    /**
+     * @brief 收到一条识别结果（AIUI回调线程）
+     * @param sid 识别会话
+     * @param text 当前整句
+     * @param stable_len 整句中不会再被修正的前缀字节数
+     * @param final 是否是该会话最后一条结果
+     */
+    void update(const std::string &sid, const std::string &text, size_t stable_len, bool final);
+
+    /**
+     * @brief 补发限流期间压下的结果，在高频回调（识别音频）中顺带调用
+     */
+    void poll();
+
+    int sentCount() const { return sent_; }
+
+    int skippedCount() const { return skipped_; }
+
+private:
+    void sendLocked(long long now);
+
+    static size_t utf8Count(const std::string &text, size_t bytes);
+    static long long nowMs();
+
+    Publisher publisher_;
+    bool enabled_        = true;
+    int min_interval_ms_ = 150;
+
+    std::mutex mutex_;
+    std::string sid_;
+    std::string text_;           // 最新结果
+    size_t stable_len_ = 0;
+    bool final_        = false;
+    std::string sent_text_;      // 接收端当前显示的文本
+    int seq_           = 0;
+    long long last_send_ms_ = 0;
+    std::atomic<bool> pending_{ false };    // 有压下未发的结果
+
+    std::atomic<int> sent_{ 0 };
+    std::atomic<int> skipped_{ 0 };    // 限流或内容未变而没有单独发出的结果数
+};
+
+#endif    // PARTIAL_TRANSCRIPT_H
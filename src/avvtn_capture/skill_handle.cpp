@@ -1,383 +1,159 @@
 #include "avvtn_capture.h"
 #include "utils/Logger.hpp"
 #include "ros2/ros_manager.hpp"
-#include "utils/json.hpp"
-#include <curl/curl.h>
+#include "robot_command/motion_scheduler.h"
+#include <chrono>
 #include <string>
-#include <iostream>
-#include <memory>
 
-// 回调函数，用于接收响应数据
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    size_t totalSize = size * nmemb;
-    std::string* response = static_cast<std::string*>(userp);
-    response->append(static_cast<char*>(contents), totalSize);
-    return totalSize;
-}
-
-// 简单的POST请求函数
-bool postRequest(const std::string& endpoint, const nlohmann::json& body, 
-                 const std::string& base_url = "http://192.168.123.164:8848") {
-    // 初始化CURL
-    static bool curl_initialized = false;
-    if (!curl_initialized) {
-        curl_global_init(CURL_GLOBAL_ALL);
-        curl_initialized = true;
-    }
-    
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        std::cerr << "Failed to initialize CURL" << std::endl;
-        return false;
-    }
-    
-    // 构建完整URL
-    std::string url = base_url + endpoint;
-    
-    // 将JSON转换为字符串
-    std::string json_str = body.dump();
-    
-    // 响应数据
-    std::string response;
-    long http_code = 0;
-    
-    // 设置CURL选项
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_str.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, json_str.length());
-    
-    // 设置HTTP头
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    
-    // 设置超时（10秒）
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-    
-    // 设置回调函数接收响应
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    
-    // 禁用SSL验证（仅用于测试环境）
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-    
-    // 记录请求日志
-    std::cout << "请求URL: " << url << "; 请求body: " << json_str << std::endl;
-    
-    // 执行请求
-    CURLcode res = curl_easy_perform(curl);
-    
-    // 获取HTTP状态码
-    if (res == CURLE_OK) {
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-    }
-    
-    // 清理
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    
-    // 检查结果
-    if (res != CURLE_OK) {
-        std::cerr << "请求失败: " << curl_easy_strerror(res) << std::endl;
-        return false;
-    }
-    
-    // 记录响应日志
-    std::cout << "请求成功, 状态码: " << http_code 
-              << ", 响应内容: " << response << std::endl;
-    
-    return true;
+// 发送停止请求，立即发出并取消排队中的运动指令
+void sendStopRequest(const CommandClient::Callback& on_done = nullptr)
+{
+    MotionScheduler::Command command;
+    command.type = MotionScheduler::STOP;
+    MotionScheduler::getInstance().submit(command, on_done);
 }
 
-// 使用示例
-void sendMoveRequest(const std::string& intent_name, const std::string& id,
-                     const std::string& distance, const std::string& move_unit) {
-    // 构建请求体
-    nlohmann::json request_body = {
-        {"data", {
-            {"intent_name", intent_name},
-            {"id", id},
-            {"distance", distance},
-            {"move_unit", move_unit}
-        }}
-    };
 
-    // 发送请求
-    bool success = postRequest("/webrtc/move", request_body);
-    
-    if (!success) {
-        std::cerr << "发送移动请求失败" << std::endl;
+void AvvtnCapture::runEarlyCommand(int actions, const std::string &phrase)
+{
+    if (actions & EarlyCommand::ACTION_STOP)
+    {
+        LOG_INFO("识别中间结果命中停止指令\"%s\"，不等云端语义，提前停止运动", phrase.c_str());
+        // 在指令客户端线程中回调，main在capture析构前停止指令客户端
+        EarlyCommand* early_command = &early_command_;
+        sendStopRequest([early_command](const CommandClient::Result& result) {
+            early_command->recordStopLatency(result.latency_ms);
+            LOG_INFO("提前停止: 触发到停止请求完成 %.1f ms", result.latency_ms);
+        });
     }
-}
-
-// 发送转向请求
-void sendTurnRequest(const std::string& intent_name, const std::string& id,
-                     const std::string& distance, const std::string& turn_unit) {
-    // 构建请求体
-    nlohmann::json request_body = {
-        {"data", {
-            {"intent_name", intent_name},
-            {"id", id},
-            {"distance", distance},
-            {"turn_unit", turn_unit}
-        }}
-    };
 
-    // 发送请求
-    bool success = postRequest("/webrtc/turn", request_body);
-    
-    if (!success) {
-        std::cerr << "发送转向请求失败" << std::endl;
+    if (actions & EarlyCommand::ACTION_SHUT_UP)
+    {
+        LOG_INFO("识别中间结果命中闭嘴指令\"%s\"，提前停止说话", phrase.c_str());
+        if (conversation_.isPlaying())
+        {
+            PcmOutput::getInstance().clear();
+            PcmOutput::getInstance().stop();
+            conversation_.onPlaybackStopped();
+            aiui_wrapper_.CancelTTS();
+            aiui_wrapper_.speech_queue_.cancelAll();
+            // 本身就在AIUI回调线程，直接清理合成状态
+            barge_in_pending_ = true;
+            applyBargeIn();
+        }
     }
 }
 
-// 发送动作请求
-void sendActionRequest(const std::string& intent_name, const std::string& id)
+namespace
 {
-    // 构建请求体
-    nlohmann::json request_body = {
-        {"data", {
-            {"intent_name", intent_name},
-            {"id", id}
-        }}
-    };
-
-    // 发送请求
-    bool success = postRequest("/webrtc/action", request_body);
-    
-    if (!success) {
-        std::cerr << "发送动作请求失败" << std::endl;
-    }
-}
 
-// 发送停止请求
-void sendStopRequest()
+/**
+ * @brief 记录一条技能结果的处理耗时，中途return也会记上
+ */
+class SkillTimer
 {
-    // 构建请求体
-    nlohmann::json request_body = {
-        {"data", {}}
-    };
+public:
+    explicit SkillTimer(SkillRouter& router) : router_(router), start_(std::chrono::steady_clock::now()) {}
 
-    // 发送请求
-    bool success = postRequest("/webrtc/stop", request_body);
-
-    if (!success) {
-        std::cerr << "发送停止请求失败" << std::endl;
+    ~SkillTimer()
+    {
+        router_.recordTime(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count() / 1000.0);
     }
-}
 
+private:
+    SkillRouter& router_;
+    std::chrono::steady_clock::time_point start_;
+};
 
-void AvvtnCapture::handleSkill(const std::string& text_str)
-{
-    try {
-        // 解析text字段中的JSON
-        auto text_root = nlohmann::json::parse(text_str);
+}    // namespace
 
-        if (text_root.contains("category") && text_root["category"].is_string()) {
-            std::string category = text_root["category"].get<std::string>();
-            if (category == "IFLYTEK.datetimePro")
-            {
-                /*官方时间技能*/
-                return;
-            }
-        }
-
-        // 检查voice_answer content字段是否存在
-        // 如果存在，播放技能返回的语音
-        if (text_root.contains("voice_answer") &&
-            text_root["voice_answer"].is_array() &&
-            text_root["voice_answer"].size() > 0 &&
-            text_root["voice_answer"][0].contains("content") &&
-            text_root["voice_answer"][0]["content"].is_string() &&
-            text_root["voice_answer"][0].contains("type") &&
-            text_root["voice_answer"][0]["type"] == "TTS")
+void AvvtnCapture::handleSkill(const JsonNode& text_root)
+{
+    SkillTimer timer(skill_router_);
+    const SkillRouter::Route* category_route = skill_router_.matchCategory(text_root);
+    if (category_route != nullptr && category_route->handler == SkillRouter::HANDLER_IGNORE)
+    {
+        // 如官方时间技能
+        return;
+    }
 
-        {
-            std::string voice_answer_content = text_root["voice_answer"][0]["content"].get<std::string>();
-            LOG_INFO("技能返回TTS内容文本: %s", voice_answer_content.c_str());
-            // 设置ignore本次大模型返回的NLP TTS语音
-            ignore_tts_sid_ = current_iat_sid_;
-            // 调用语音合成TTS，播放技能返回的语音文本
-            aiui_wrapper_.StartTTS(voice_answer_content);
-            // 技能答复的文本发送ROS话题
-            nlohmann::json nlp_answer = {
-                    {"seq", std::to_string(0)},
-                    {"status", std::to_string(2)},
-                    {"speaker", "robot"},
-                    {"text", voice_answer_content}
-            };
-            ROSManager::getInstance().publishChatHistory(nlp_answer.dump());
+    const JsonNode& result          = skill_router_.result(text_root);
+    const SkillRouter::Route* route = skill_router_.matchType(result);
+    bool is_stop_command            = route != nullptr && (route->handler == SkillRouter::HANDLER_STOP || route->handler == SkillRouter::HANDLER_SHUT_UP);
+
+    // 检查voice_answer content字段是否存在
+    // 如果存在，播放技能返回的语音
+    const JsonNode& voice_answer = text_root["voice_answer"][0];
+    if (voice_answer["content"].isString() && voice_answer["type"].equals("TTS"))
+    {
+        std::string voice_answer_content = voice_answer["content"].asString();
+        LOG_INFO("技能返回TTS内容文本: %s", voice_answer_content.c_str());
+        // 设置ignore本次大模型返回的NLP TTS语音
+        ignore_tts_sid_ = current_iat_sid_;
+        // 调用语音合成TTS，播放技能返回的语音文本；停止类指令的确认抢占正在播的闲聊
+        SpeechQueue::Priority priority = is_stop_command ? SpeechQueue::PRIORITY_COMMAND : SpeechQueue::PRIORITY_SKILL;
+        aiui_wrapper_.speech_queue_.speak(voice_answer_content, priority, aiui_wrapper_.speech_queue_.currentTurn());
+        // 技能答复的文本发送ROS话题
+        std::string nlp_answer;
+        JsonWriter(nlp_answer).StartObject().Key("seq").String("0").Key("speaker").String("robot").Key("status").String("2").Key("text").String(voice_answer_content).EndObject();
+        ROSManager::getInstance().publishChatHistory(nlp_answer);
+
+        std::string nlp_answer_nostream;
+        JsonWriter(nlp_answer_nostream).StartObject().Key("is_knowledge").String(std::to_string(is_knowledge)).Key("is_skill").String(std::to_string(is_skill)).Key("speaker").String("robot").Key("text").String(voice_answer_content).EndObject();
+        ROSManager::getInstance().publishChatHistoryNoStream(nlp_answer_nostream);
+    }
 
-            nlohmann::json nlp_answer_nostream = {
-                    {"speaker", "robot"},
-                    {"text", voice_answer_content},
-                    {"is_skill", std::to_string(is_skill)},
-                    {"is_knowledge", std::to_string(is_knowledge)}
-            };
-            ROSManager::getInstance().publishChatHistoryNoStream(nlp_answer_nostream.dump());
-        }
+    // 检查type字段是否存在
+    const JsonNode& type = skill_router_.type(result);
+    if (!type.isString())
+    {
+        return;
+    }
 
-        // 检查type字段是否存在
-        if (text_root.contains("data") &&
-            text_root["data"].contains("result") &&
-            text_root["data"]["result"].is_array() &&
-            text_root["data"]["result"].size() > 0 &&
-            text_root["data"]["result"][0].contains("type") &&
-            text_root["data"]["result"][0]["type"].is_string())
+    LOG_INFO("捕获到技能type!!!");
+    // 与识别中间结果上提前执行的指令对账，已执行过的不再重复
+    int early_actions = early_command_.reconcile(current_iat_sid_, type.asString());
+    if (route == nullptr)
+    {
+        LOG_INFO("新的未定义技能！！！");
+        return;
+    }
+    if (!route->log.empty())
+    {
+        LOG_INFO("%s", route->log.c_str());
+    }
 
+    switch (route->handler)
+    {
+        case SkillRouter::HANDLER_MOTION:
         {
-            LOG_INFO("捕获到技能type!!!");
-            std::string type = text_root["data"]["result"][0]["type"].get<std::string>();
-
-            if (type == "face_rec_start")
-            {
-                LOG_INFO("执行调用人脸识别服务意图!!!");
-            }
-            else if (type == "move")
+            MotionScheduler::Command command;
+            if (!skill_router_.extractCommand(*route, result, command))
             {
-                LOG_INFO("执行移动意图!!!");
-
-                // 提取移动参数
-                auto& result = text_root["data"]["result"][0];
-                std::string intent_name = result["intentName"].get<std::string>();
-                int id = result["id"].get<std::int32_t>();
-
-                // 提取slots
-                std::string distance;
-                std::string move_unit;
-
-                if (result.contains("slots") && result["slots"].is_object()) {
-                    auto& slots = result["slots"];
-                    
-                    if (slots.contains("distance") && 
-                        slots["distance"].is_object() &&
-                        slots["distance"].contains("normValue") &&
-                        slots["distance"]["normValue"].is_string())
-                    {
-                        distance = slots["distance"]["normValue"].get<std::string>();
-                    }
-
-                    if (slots.contains("move_unit") && 
-                        slots["move_unit"].is_object() &&
-                        slots["move_unit"].contains("normValue") &&
-                        slots["move_unit"]["normValue"].is_string())
-                    {
-                        move_unit = slots["move_unit"]["normValue"].get<std::string>();
-                    }
-                }
-                
-                LOG_INFO("移动参数: intent_name=%s, id=%d, distance=%s, move_unit=%s",
-                        intent_name.c_str(), id, distance.c_str(), move_unit.c_str());
-                
-                // TODO: 发送移动请求
-                sendMoveRequest(intent_name, std::to_string(id), distance, move_unit);
-            }
-            else if (type == "turn")
-            {
-                LOG_INFO("执行转向意图!!!");
-                // 提取移动参数
-                auto& result = text_root["data"]["result"][0];
-                std::string intent_name = result["intentName"].get<std::string>();
-                int id = result["id"].get<std::int32_t>();
-
-                // 提取slots
-                std::string distance;
-                std::string turn_unit;
-
-                if (result.contains("slots") && result["slots"].is_object()) {
-                    auto& slots = result["slots"];
-                    
-                    if (slots.contains("distance") && 
-                        slots["distance"].is_object() &&
-                        slots["distance"].contains("normValue") &&
-                        slots["distance"]["normValue"].is_string())
-                    {
-                        distance = slots["distance"]["normValue"].get<std::string>();
-                    }
-
-                    if (slots.contains("turn_unit") && 
-                        slots["turn_unit"].is_object() &&
-                        slots["turn_unit"].contains("normValue") &&
-                        slots["turn_unit"]["normValue"].is_string())
-                    {
-                        turn_unit = slots["turn_unit"]["normValue"].get<std::string>();
-                    }
-                }
-                
-                LOG_INFO("移动参数: intent_name=%s, id=%d, distance=%s, turn_unit=%s",
-                        intent_name.c_str(), id, distance.c_str(), turn_unit.c_str());
-                
-                // TODO: 发送移动请求
-                sendTurnRequest(intent_name, std::to_string(id), distance, turn_unit);
-            }
-            else if (type == "action")
-            {
-                LOG_INFO("执行动作意图!!!");
-                // 提取动作参数
-                auto& result = text_root["data"]["result"][0];
-                std::string intent_name = result["intentName"].get<std::string>();
-                int id = result["id"].get<std::int32_t>();
-
-                LOG_INFO("动作参数: intent_name=%s, id=%d", intent_name.c_str(), id);
-                
-                // 发送动作请求
-                sendActionRequest(intent_name, std::to_string(id));
-            }
-            else if (type == "stop")
-            {
-                LOG_INFO("执行停止意图!!!");
-
-                // TODO: 发送移动请求
-                sendStopRequest();
-            }
-            else if (type == "shut_up")
-            {
-                LOG_INFO("执行停止语音交互意图!!!");
-
-                // 播放shut_up回应语音
-                is_playing = true;
-                // 发送SLEEP给AIUI，重置状态到等待唤醒
-                aiui_wrapper_.ResetWakeup();
-
-            }
-            else if (type == "vip")
-            {
-                LOG_INFO("执行 VIP 场景意图!!!");
-
-                // 提取vip参数
-                auto& result = text_root["data"]["result"][0];
-                std::string intent_name = result["intentName"].get<std::string>();
-
-
+                return;
             }
-            else if (type == "new_year")
+            LOG_INFO("运动参数: type=%s, intent_name=%s, id=%s, distance=%s, unit=%s", route->name.c_str(), command.intent_name.c_str(),
+                     command.id.c_str(), command.distance.c_str(), command.unit.c_str());
+            MotionScheduler::getInstance().submit(command);
+            break;
+        }
+        case SkillRouter::HANDLER_STOP:
+            if (early_actions & EarlyCommand::ACTION_STOP)
             {
-                LOG_INFO("执行新年动作意图!!!");
-                // 提取动作参数
-                auto& result = text_root["data"]["result"][0];
-                std::string intent_name = result["intentName"].get<std::string>();
-
-                int ids[6] = {2003, 2014, 2016, 3052, 3053, 3012};
-                int id = ids[rand() % 6];
-                LOG_INFO("动作参数: intent_name=%s, id=%d", intent_name.c_str(), id);
-
-                // 发送动作请求
-                sendActionRequest(intent_name, std::to_string(id));
+                LOG_INFO("识别中间结果上已提前停止，不再重复发送停止请求");
             }
             else
             {
-                LOG_INFO("新的未定义技能！！！");
+                sendStopRequest();
             }
-        }
-
-    } catch (const nlohmann::json::parse_error& e) {
-        LOG_ERROR("解析text字段失败: %s, text_str: %s", e.what(), text_str.c_str());
-        return;
-    } catch (const nlohmann::json::type_error& e) {
-        LOG_ERROR("类型错误: %s", e.what());
-        return;
+            break;
+        case SkillRouter::HANDLER_SHUT_UP:
+            // 回应语音马上要播，先记为播放中，随后的休眠事件等它播完才回到等待唤醒
+            conversation_.onPlaybackBegin();
+            // 发送SLEEP给AIUI，重置状态到等待唤醒
+            aiui_wrapper_.ResetWakeup();
+            break;
+        default:
+            break;
     }
-
-}
\ No newline at end of file
+}
@@ -0,0 +1,201 @@
+#include "avvtn_capture/skill_router.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "utils/JsonDocument.h"
+#include "utils/Logger.hpp"
+
+SkillRouter::SkillRouter()
+{
+    category_path_.compile("/category");
+    result_path_.compile("/data/result/0");
+    type_path_.compile("/type");
+}
+
+int SkillRouter::build(const std::vector<AppConfig::SkillRoute> &routes)
+{
+    routes_.clear();
+    by_category_.clear();
+    by_type_.clear();
+    routes_.reserve(routes.size());
+
+    for (const AppConfig::SkillRoute &config : routes)
+    {
+        bool by_category = !config.category.empty();
+        Route route;
+        route.name = by_category ? config.category : config.type;
+        route.log  = config.log;
+        if (route.name.empty() || (by_category && !config.type.empty()))
+        {
+            LOG_WARN("技能路由: category和type需要且只能设置一个, 跳过 handler = %s", config.handler.c_str());
+            continue;
+        }
+        if (!parseHandler(config.handler, route.handler))
+        {
+            LOG_WARN("技能路由: %s 未知的处理方式 %s, 跳过", route.name.c_str(), config.handler.c_str());
+            continue;
+        }
+        if (route.handler == HANDLER_MOTION)
+        {
+            if (config.command == "move")
+            {
+                route.command = MotionScheduler::MOVE;
+            }
+            else if (config.command == "turn")
+            {
+                route.command = MotionScheduler::TURN;
+            }
+            else if (config.command == "action")
+            {
+                route.command = MotionScheduler::ACTION;
+            }
+            else
+            {
+                LOG_WARN("技能路由: %s 未知的运动指令 %s, 跳过", route.name.c_str(), config.command.c_str());
+                continue;
+            }
+        }
+        if (!route.intent_name.compile(config.intent_name) || !route.id.compile(config.id) || !route.distance.compile(config.distance) ||
+            !route.unit.compile(config.unit))
+        {
+            LOG_WARN("技能路由: %s 字段路径需以'/'开头, 跳过", route.name.c_str());
+            continue;
+        }
+        route.random_ids = config.random_ids;
+
+        Table &table = by_category ? by_category_ : by_type_;
+        uint64_t key = hash(route.name.data(), route.name.size());
+        if (find(table, key, route.name.data(), route.name.size()) != nullptr)
+        {
+            LOG_WARN("技能路由: %s 重复, 跳过", route.name.c_str());
+            continue;
+        }
+        table.emplace(key, (int)routes_.size());
+        routes_.push_back(route);
+    }
+
+    LOG_INFO("技能路由: 生效 %zu 条, 按category %zu 条, 按type %zu 条", routes_.size(), by_category_.size(), by_type_.size());
+    return (int)routes_.size();
+}
+
+const SkillRouter::Route *SkillRouter::matchCategory(const JsonNode &text_root) const
+{
+    return lookup(by_category_, category_path_.resolve(text_root));
+}
+
+const SkillRouter::Route *SkillRouter::matchType(const JsonNode &result) const
+{
+    return lookup(by_type_, type_path_.resolve(result));
+}
+
+bool SkillRouter::extractCommand(const Route &route, const JsonNode &result, MotionScheduler::Command &command) const
+{
+    const JsonNode &intent_name = route.intent_name.resolve(result);
+    command.type                = route.command;
+    if (!route.random_ids.empty())
+    {
+        command.intent_name = intent_name.asString();
+        command.id          = std::to_string(route.random_ids[rand() % route.random_ids.size()]);
+    }
+    else
+    {
+        const JsonNode &id = route.id.resolve(result);
+        if (!intent_name.isString() || !id.isInteger())
+        {
+            LOG_ERROR("类型错误: intentName需为字符串, id需为整数");
+            return false;
+        }
+        command.intent_name = intent_name.asString();
+        command.id          = std::to_string(id.asInt());
+    }
+
+    // 槽位不存在时为空串
+    if (route.distance.valid())
+    {
+        command.distance = route.distance.resolve(result).asString();
+    }
+    if (route.unit.valid())
+    {
+        command.unit = route.unit.resolve(result).asString();
+    }
+    return true;
+}
+
+void SkillRouter::recordTime(double elapsed_us)
+{
+    handled_++;
+    total_us_ += elapsed_us;
+    max_us_ = (std::max)(max_us_, elapsed_us);
+    if (handled_ % 20 == 0)
+    {
+        Stats stats = getStats();
+        LOG_INFO("技能路由: 已处理 %d 条, 平均 %.1f us, 最大 %.1f us", stats.handled, stats.avg_us, stats.max_us);
+    }
+}
+
+SkillRouter::Stats SkillRouter::getStats() const
+{
+    Stats stats;
+    stats.handled = handled_;
+    stats.avg_us  = handled_ > 0 ? total_us_ / handled_ : 0;
+    stats.max_us  = max_us_;
+    return stats;
+}
+
+const SkillRouter::Route *SkillRouter::lookup(const Table &table, const JsonNode &name) const
+{
+    if (!name.isString())
+    {
+        return nullptr;
+    }
+    return find(table, hash(name.c_str(), name.length()), name.c_str(), name.length());
+}
+
+const SkillRouter::Route *SkillRouter::find(const Table &table, uint64_t key, const char *name, size_t len) const
+{
+    // 哈希相同不代表名字相同，冲突的几条逐个比较
+    auto range = table.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const Route &route = routes_[it->second];
+        if (route.name.size() == len && memcmp(route.name.data(), name, len) == 0)
+        {
+            return &route;
+        }
+    }
+    return nullptr;
+}
+
+bool SkillRouter::parseHandler(const std::string &name, Handler &handler)
+{
+    static const struct
+    {
+        const char *name;
+        Handler handler;
+    } kHandlers[] = {
+        { "ignore", HANDLER_IGNORE }, { "log", HANDLER_LOG }, { "motion", HANDLER_MOTION }, { "stop", HANDLER_STOP }, { "shut_up", HANDLER_SHUT_UP },
+    };
+    for (const auto &item : kHandlers)
+    {
+        if (name == item.name)
+        {
+            handler = item.handler;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t SkillRouter::hash(const char *data, size_t len)
+{
+    // FNV-1a
+    uint64_t value = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        value ^= (unsigned char)data[i];
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file skill_router.h
+ * @brief 按配置的路由表分发技能结果
+ * @details 路由表来自robot.cfg的skills.routes（缺省为内置表），每条路由按category或type匹配，
+ *          交给固定的几种处理方式：忽略、只记日志、发运动指令、停止、停止说话。
+ *          加载时把字段路径编译成JsonPointer，把category/type按哈希建表，
+ *          处理一条技能结果只做一次哈希查找、一次名字比较和几次按段取值，不再逐个比较字符串。
+ *          哈希相同的不同名字各自保留，查找时按名字区分。
+ *          只在AIUI回调线程中使用。
+ */
+#ifndef SKILL_ROUTER_H
+#define SKILL_ROUTER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "robot_command/motion_scheduler.h"
+#include "utils/AppConfig.h"
+#include "utils/JsonPointer.h"
+
+class JsonNode;
+
+class SkillRouter
+{
+public:
+    enum Handler
+    {
+        HANDLER_IGNORE,     // 整条技能结果不处理，只用于category路由
+        HANDLER_LOG,        // 只记日志
+        HANDLER_MOTION,     // 发移动、转向或动作指令
+        HANDLER_STOP,       // 停止运动
+        HANDLER_SHUT_UP     // 停止语音交互
+    };
+
+    struct Route
+    {
+        std::string name;    // category或type
+        Handler handler = HANDLER_LOG;
+        MotionScheduler::Type command = MotionScheduler::ACTION;
+        std::string log;
+        JsonPointer intent_name;
+        JsonPointer id;
+        JsonPointer distance;
+        JsonPointer unit;
+        std::vector<int> random_ids;
+    };
+
+    struct Stats
+    {
+        int handled   = 0;
+        double avg_us = 0;    // 每条技能结果的处理耗时
+        double max_us = 0;
+    };
+
+    SkillRouter();
+
+    /**
+     * @brief 编译路由表，格式不对的路由记日志后跳过
+     * @return 生效的路由条数
+     */
+    int build(const std::vector<AppConfig::SkillRoute> &routes);
+
+    /**
+     * @brief 按技能的category匹配，没有匹配时返回nullptr
+     */
+    const Route *matchCategory(const JsonNode &text_root) const;
+
+    /**
+     * @brief 技能结果data.result[0]
+     */
+    const JsonNode &result(const JsonNode &text_root) const { return result_path_.resolve(text_root); }
+
+    /**
+     * @brief 技能结果的type
+     */
+    const JsonNode &type(const JsonNode &result) const { return type_path_.resolve(result); }
+
+    /**
+     * @brief 按技能结果的type匹配，没有匹配时返回nullptr
+     */
+    const Route *matchType(const JsonNode &result) const;
+
+    /**
+     * @brief 按motion路由取出运动指令的参数
+     * @return intentName不是字符串或id不是整数时返回false
+     */
+    bool extractCommand(const Route &route, const JsonNode &result, MotionScheduler::Command &command) const;
+
+    /**
+     * @brief 记录一条技能结果的处理耗时
+     */
+    void recordTime(double elapsed_us);
+
+    Stats getStats() const;
+
+private:
+    typedef std::unordered_multimap<uint64_t, int> Table;    // 名字的哈希 -> routes_下标，冲突的名字共用一个键
+
+    const Route *find(const Table &table, uint64_t key, const char *name, size_t len) const;
+    const Route *lookup(const Table &table, const JsonNode &name) const;
+
+    static bool parseHandler(const std::string &name, Handler &handler);
+    static uint64_t hash(const char *data, size_t len);
+
+    std::vector<Route> routes_;
+    Table by_category_;
+    Table by_type_;
+    JsonPointer category_path_;
+    JsonPointer result_path_;
+    JsonPointer type_path_;
+
+    int handled_     = 0;
+    double total_us_ = 0;
+    double max_us_   = 0;
+};
+
+#endif    // SKILL_ROUTER_H
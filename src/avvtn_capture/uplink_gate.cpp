@@ -0,0 +1,241 @@
+#include "avvtn_capture/uplink_gate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "utils/Logger.hpp"
+
+void UplinkGate::setBufferMs(int buffer_ms)
+{
+    // 16k采样、16bit单声道，每毫秒32字节
+    ring_.assign((size_t)(std::max)(buffer_ms, 0) * 32, 0);
+    ring_head_ = 0;
+    ring_size_ = 0;
+}
+
+bool UplinkGate::feed(const char *data, int len, int vad_status, bool playing)
+{
+    if (!enabled_)
+    {
+        write(data, len, vad_status == 3);
+        return false;
+    }
+
+    long long now = nowMs();
+    if (playing)
+    {
+        last_playing_ms_ = now;
+    }
+    bool speaking = playing || (last_playing_ms_ != 0 && now - last_playing_ms_ < hangover_ms_);
+
+    if (state_ == STATE_PASS && speaking)
+    {
+        state_       = STATE_HOLD;
+        loud_frames_ = 0;
+    }
+
+    bool energy_onset = false;
+    if (state_ == STATE_HOLD)
+    {
+        if (!speaking)
+        {
+            endHold();
+            state_ = STATE_PASS;
+        }
+        else if (vad_status == 1 || vad_status == 2)
+        {
+            open(true, now);
+        }
+        else if (len > 0 && frameRms(data, len) >= energy_threshold_)
+        {
+            if (++loud_frames_ >= open_frames_)
+            {
+                open(false, now);
+                energy_onset = true;
+            }
+        }
+        else
+        {
+            // 短暂的能量尖峰没到放行条件，不门控时它多半会被云端当成一次开口
+            if (loud_frames_ > 0)
+            {
+                stats_.suppressed_turns++;
+            }
+            loud_frames_ = 0;
+        }
+
+        if (state_ == STATE_HOLD)
+        {
+            if (vad_status == 3)
+            {
+                // 门控开始前就在上送的那句话照常结束，否则这次结束没有对应的上送
+                if (session_open_)
+                {
+                    write(nullptr, 0, true);
+                }
+            }
+            else
+            {
+                hold(data, len);
+            }
+            return false;
+        }
+    }
+
+    if (state_ == STATE_OPEN)
+    {
+        if (vad_status == 1 || vad_status == 2)
+        {
+            open_vad_seen_ = true;
+        }
+        else if (!open_vad_seen_ && now - open_ms_ > open_timeout_ms_)
+        {
+            // 能量放行后引擎一直没认为有人说话，多半是回声或噪声，结束已上送的这段并重新门控
+            stats_.false_opens++;
+            LOG_INFO("上行门控: 能量放行 %lld ms 内未检测到说话，收回", now - open_ms_);
+            if (session_open_)
+            {
+                write(nullptr, 0, true);
+            }
+            state_ = STATE_PASS;
+            if (speaking)
+            {
+                state_       = STATE_HOLD;
+                loud_frames_ = 0;
+                hold(data, len);
+            }
+            return false;
+        }
+
+        if (vad_status == 3)
+        {
+            write(nullptr, 0, true);
+            state_ = STATE_PASS;
+            return energy_onset;
+        }
+    }
+
+    write(data, len, vad_status == 3);
+    return energy_onset;
+}
+
+void UplinkGate::write(const char *data, int len, bool is_stop)
+{
+    session_open_ = !is_stop;
+    if (writer_)
+    {
+        if (is_stop)
+        {
+            writer_(nullptr, 0, true);
+        }
+        else
+        {
+            writer_(data, len, false);
+        }
+    }
+}
+
+void UplinkGate::hold(const char *data, int len)
+{
+    size_t capacity = ring_.size();
+    size_t size     = (size_t)(std::max)(len, 0);
+    if (capacity == 0)
+    {
+        stats_.bytes_saved += size;
+        return;
+    }
+
+    // 只保留最近capacity字节，挤出去的部分不会再上送
+    if (size >= capacity)
+    {
+        stats_.bytes_saved += ring_size_ + (size - capacity);
+        memcpy(ring_.data(), data + (size - capacity), capacity);
+        ring_head_ = 0;
+        ring_size_ = capacity;
+        return;
+    }
+    if (ring_size_ + size > capacity)
+    {
+        size_t overflow = ring_size_ + size - capacity;
+        stats_.bytes_saved += overflow;
+        ring_head_ = (ring_head_ + overflow) % capacity;
+        ring_size_ -= overflow;
+    }
+
+    size_t tail  = (ring_head_ + ring_size_) % capacity;
+    size_t first = (std::min)(size, capacity - tail);
+    memcpy(ring_.data() + tail, data, first);
+    memcpy(ring_.data(), data + first, size - first);
+    ring_size_ += size;
+}
+
+void UplinkGate::open(bool by_vad, long long now)
+{
+    LOG_INFO("上行门控: %s，放行并补发缓存的 %zu 字节", by_vad ? "引擎VAD检测到说话" : "能量超过阈值", ring_size_);
+    if (by_vad)
+    {
+        stats_.vad_opens++;
+    }
+    else
+    {
+        stats_.energy_opens++;
+    }
+
+    // 环形缓存最多分两段，按时间先后补发
+    size_t capacity = ring_.size();
+    if (ring_size_ > 0)
+    {
+        size_t first = (std::min)(ring_size_, capacity - ring_head_);
+        write(ring_.data() + ring_head_, (int)first, false);
+        if (ring_size_ > first)
+        {
+            write(ring_.data(), (int)(ring_size_ - first), false);
+        }
+    }
+    ring_head_ = 0;
+    ring_size_ = 0;
+
+    state_         = STATE_OPEN;
+    open_ms_       = now;
+    open_vad_seen_ = by_vad;
+}
+
+void UplinkGate::endHold()
+{
+    stats_.bytes_saved += ring_size_;
+    ring_head_ = 0;
+    ring_size_ = 0;
+    logStats();
+}
+
+void UplinkGate::logStats()
+{
+    LOG_INFO("上行门控: 累计少传 %lld 字节(%.1f 秒), 放行 VAD %d 次 能量 %d 次, 误放行 %d 次, 拦下疑似误识别 %d 次", stats_.bytes_saved,
+             stats_.bytes_saved / 32000.0, stats_.vad_opens, stats_.energy_opens, stats_.false_opens, stats_.suppressed_turns);
+}
+
+long long UplinkGate::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int UplinkGate::frameRms(const char *data, int len)
+{
+    int count = len / 2;
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int16_t sample;
+        memcpy(&sample, data + i * 2, sizeof(sample));
+        sum += (double)sample * sample;
+    }
+    return (int)std::sqrt(sum / count);
+}
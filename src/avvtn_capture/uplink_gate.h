@@ -0,0 +1,100 @@
+/**
+ * @file uplink_gate.h
+ * @brief 上行门控：机器人说话时暂扣送往AIUI的识别音频
+ * @details 播放期间引擎输出的多是机器人自己的残留回声，照常上送既浪费带宽和云端识别时长，又会产生误识别的对话轮次。
+ *          播放中（以及停止后的一小段拖尾）音频先放进环形缓存不上送；引擎VAD检测到说话，
+ *          或连续几帧能量超过阈值时放行，先补发缓存里的音频再继续实时上送，真实的打断不丢开头。
+ *          只在降噪引擎回调线程中使用。
+ */
+#ifndef UPLINK_GATE_H
+#define UPLINK_GATE_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+class UplinkGate
+{
+public:
+    /**
+     * @brief 上送音频的函数，参数同AiuiWrapper::WriteAudio
+     */
+    typedef std::function<void(const char *data, int len, bool is_stop)> Writer;
+
+    struct Stats
+    {
+        long long bytes_saved = 0;    // 门控期间没有上送的音频字节数
+        int vad_opens         = 0;    // 引擎VAD检测到说话而放行的次数
+        int energy_opens      = 0;    // 能量超过阈值而放行的次数
+        int false_opens       = 0;    // 能量放行后引擎VAD始终没有检测到说话，按误放行收回的次数
+        int suppressed_turns  = 0;    // 门控期间能量尖峰未达放行条件的次数，不门控时这些多半会成为误识别的轮次
+    };
+
+    void setWriter(const Writer &writer) { writer_ = writer; }
+
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+
+    void setEnergyThreshold(int energy_threshold) { energy_threshold_ = energy_threshold; }
+
+    void setOpenFrames(int open_frames) { open_frames_ = open_frames; }
+
+    /**
+     * @brief 环形缓存的时长，按16k采样16bit单声道换算
+     */
+    void setBufferMs(int buffer_ms);
+
+    void setHangoverMs(int hangover_ms) { hangover_ms_ = hangover_ms; }
+
+    void setOpenTimeoutMs(int open_timeout_ms) { open_timeout_ms_ = open_timeout_ms; }
+
+    /**
+     * @brief 送入一帧识别音频
+     * @param data 音频数据
+     * @param len 音频长度
+     * @param vad_status 引擎的VAD状态，1开始说话，3说话结束
+     * @param playing 播放器是否在播放
+     * @return 这一帧因能量超过阈值而放行时返回true，调用方据此打断播放
+     */
+    bool feed(const char *data, int len, int vad_status, bool playing);
+
+    const Stats &getStats() const { return stats_; }
+
+private:
+    enum State
+    {
+        STATE_PASS,    // 机器人没在说话，实时上送
+        STATE_HOLD,    // 机器人在说话，音频进缓存
+        STATE_OPEN     // 机器人在说话但用户开口了，实时上送直到这句话结束
+    };
+
+    void write(const char *data, int len, bool is_stop);
+    void hold(const char *data, int len);
+    void open(bool by_vad, long long now);
+    void endHold();
+    void logStats();
+
+    static long long nowMs();
+    static int frameRms(const char *data, int len);
+
+    Writer writer_;
+    bool enabled_          = false;
+    int energy_threshold_  = 1500;
+    int open_frames_       = 3;
+    int hangover_ms_       = 300;
+    int open_timeout_ms_   = 1500;
+
+    State state_               = STATE_PASS;
+    long long last_playing_ms_ = 0;
+    long long open_ms_         = 0;
+    bool open_vad_seen_        = false;    // 本次放行后引擎VAD是否检测到说话
+    bool session_open_         = false;    // 上次发停止之后是否上送过音频
+    int loud_frames_           = 0;        // 连续超过能量阈值的帧数
+
+    std::vector<char> ring_;    // 门控期间的环形缓存
+    size_t ring_head_ = 0;      // 最早一个字节的位置
+    size_t ring_size_ = 0;
+
+    Stats stats_;
+};
+
+#endif    // UPLINK_GATE_H
@@ -3,12 +3,20 @@
 #include <iostream>
 #include <mutex>
 #include "utils/Logger.hpp"
+#include "utils/AppConfig.h"
 #include "ros2/ros_manager.hpp"
+#include "ros2/ros_log_sink.hpp"
 #include "avvtn_capture/avvtn_capture.h"
+#include "robot_command/command_client.h"
+#include "robot_command/motion_scheduler.h"
 
 static std::mutex mutex_;
 static std::condition_variable cv_;
 
+// 按robot.cfg的log.output移除不需要的输出目标
+static Logger::ConsoleSink *console_sink_ = nullptr;
+static Logger::FileSink *file_sink_       = nullptr;
+
 void signalHandle(int num)
 {
     std::cout << "Caught signal " << num << std::endl;
@@ -33,12 +41,14 @@ void InitLogger() {
     logger.SetLevel(Logger::LogLevel::LOG_INFO);
 
     // 添加控制台输出（带颜色）
-    logger.AddSink(std::unique_ptr<Logger::ConsoleSink>(new Logger::ConsoleSink(true)));
+    console_sink_ = new Logger::ConsoleSink(true);
+    logger.AddSink(std::unique_ptr<Logger::LogSink>(console_sink_));
 
     // 添加文件输出（10MB大小限制，保留5个备份文件）
-    logger.AddSink(std::unique_ptr<Logger::FileSink>(new Logger::FileSink("app.log", 10 * 1024 * 1024, 5, false)));
+    file_sink_ = new Logger::FileSink("app.log", 10 * 1024 * 1024, 5, false);
+    logger.AddSink(std::unique_ptr<Logger::LogSink>(file_sink_));
 
-    // 设置异步模式（提高性能）
+    // 设置异步模式：所有输出目标共用一个后台线程，写日志的线程只把日志放进无锁队列
     logger.SetAsyncMode(true);
 
     // 时间格式
@@ -64,6 +74,28 @@ void InitLogger() {
     logger.Flush();
 }
 
+// 配置加载后调整日志输出
+void ApplyLogConfig()
+{
+    auto &logger                           = Logger::Logger::GetInstance();
+    const AppConfig::LogConfig &log_config = AppConfig::getInstance().log;
+
+    logger.SetOverflowPolicy(Logger::OverflowPolicyFromString(log_config.overflow, Logger::OverflowPolicy::DROP_LOW));
+    file_sink_->SetBuffering((size_t)log_config.file_buffer_kb * 1024, Logger::LevelFromString(log_config.flush_level, Logger::LogLevel::LOG_WARN),
+                             log_config.flush_interval_ms);
+
+    if (log_config.output == "file")
+    {
+        logger.RemoveSink(console_sink_);
+        console_sink_ = nullptr;
+    }
+    else if (log_config.output == "console")
+    {
+        logger.RemoveSink(file_sink_);
+        file_sink_ = nullptr;
+    }
+}
+
 int main(int argc, char const *argv[])
 {
     signal(SIGINT, signalHandle);
@@ -72,14 +104,33 @@ int main(int argc, char const *argv[])
     InitLogger();
     //TestLogger();
 
+    // 加载本程序的调优配置，缺失时使用默认值
+    AppConfig::getInstance().load("/home/cat/robot_avvtn/robot.cfg");
+
+    // 运动控制指令客户端，须在其他线程使用curl前启动
+    CommandClient::getInstance().start();
+    MotionScheduler::getInstance().setMergeEnabled(AppConfig::getInstance().robot_command.merge_motion);
+
+    ApplyLogConfig();
+
+    // 日志发布到ROS话题，与原来一样ROS初始化前的日志不发布
+    const AppConfig::RosLogConfig &ros_log = AppConfig::getInstance().ros_log;
+    RosLogSink *ros_log_sink = nullptr;
+    if (ros_log.enable)
+    {
+        ros_log_sink = new RosLogSink(Logger::LevelFromString(ros_log.min_level, Logger::LogLevel::LOG_INFO), ros_log.max_lines_per_sec,
+                                      ros_log.batch_ms, ros_log.queue_size);
+        Logger::Logger::GetInstance().AddSink(std::unique_ptr<Logger::LogSink>(ros_log_sink));
+    }
+
     // 2. 初始化ROS管理器
     ROSManager::getInstance().init(argc, argv);
 
     // 3. 可以在这里订阅话题
     ROSManager::getInstance().subscribeTopic("robot_avvtn_log", 
         [](const std_msgs::msg::String::SharedPtr msg) {
-            std::cout << "收到消息: " << msg->data << std::endl;
-            LOG_INFO("收到ROS2消息: {}", msg->data);
+            // 订阅的是本程序发布日志的话题，用DEBUG级别，否则收到的日志又被发布出去
+            LOG_DEBUG("收到ROS2消息: %s", msg->data.c_str());
         });
 
     ROSManager::getInstance().publishStatus("STATUS_WAITING_CONNECTION");
@@ -93,6 +144,8 @@ int main(int argc, char const *argv[])
     {
         LOG_FATAL("Avvtn capture init Error");
         capture.Destory();
+        CommandClient::getInstance().stop();
+        if (ros_log_sink) ros_log_sink->Stop();
         ROSManager::getInstance().shutdown();
         return -1;
     }
@@ -103,7 +156,9 @@ int main(int argc, char const *argv[])
 
     // 7. 清理
     capture.Destory();
+    CommandClient::getInstance().stop();
     ROSManager::getInstance().publishStatus("STATUS_WAITING_CONNECTION");
+    if (ros_log_sink) ros_log_sink->Stop();
     ROSManager::getInstance().shutdown();
     LOG_INFO("结束程序");
     return 0;
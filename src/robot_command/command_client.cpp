@@ -0,0 +1,507 @@
+#include "robot_command/command_client.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+
+#include "utils/AppConfig.h"
+#include "utils/Logger.hpp"
+
+CommandClient &CommandClient::getInstance()
+{
+    static CommandClient instance;
+    return instance;
+}
+
+CommandClient::~CommandClient()
+{
+    stop();
+}
+
+bool CommandClient::start()
+{
+    if (thread_.joinable())
+    {
+        return true;
+    }
+
+    const AppConfig::RobotCommandConfig &config = AppConfig::getInstance().robot_command;
+    base_url_           = config.base_url;
+    deadline_ms_        = config.deadline_ms;
+    connect_timeout_ms_ = config.connect_timeout_ms;
+    breaker_failures_   = (std::max)(config.breaker_failures, 1);
+    breaker_open_ms_    = config.breaker_open_ms;
+
+    // curl_global_init不是线程安全的，必须在其他线程使用curl之前调用一次
+    if (curl_global_init(CURL_GLOBAL_ALL) != CURLE_OK)
+    {
+        LOG_ERROR("指令客户端: curl_global_init失败");
+        return false;
+    }
+    multi_ = curl_multi_init();
+    if (multi_ == nullptr)
+    {
+        LOG_ERROR("指令客户端: curl_multi_init失败");
+        curl_global_cleanup();
+        return false;
+    }
+    long max_connections = (std::max)(config.max_connections, 1);
+    curl_multi_setopt(multi_, CURLMOPT_MAXCONNECTS, max_connections);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, max_connections);
+    headers_ = curl_slist_append(nullptr, "Content-Type: application/json");
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = false;
+        running_  = true;
+    }
+    thread_ = std::thread(&CommandClient::run, this);
+    LOG_INFO("指令客户端: %s, 截止时间 %d ms, 连接超时 %d ms, 最多 %ld 条连接, 连续失败 %d 次熔断 %d ms", base_url_.c_str(), deadline_ms_,
+             connect_timeout_ms_, max_connections, breaker_failures_, breaker_open_ms_);
+    return true;
+}
+
+void CommandClient::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        stopping_ = true;
+        running_  = false;
+        curl_multi_wakeup(multi_);
+    }
+    thread_.join();
+
+    // 线程已退出，剩下的请求在这里按失败回调
+    std::deque<std::unique_ptr<Request>> queued;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queued.swap(queue_);
+    }
+    for (auto &entry : inflight_)
+    {
+        curl_multi_remove_handle(multi_, entry.first);
+        curl_easy_cleanup(entry.first);
+        Result result;
+        result.error = "客户端已停止";
+        finish(std::move(entry.second), result, true);
+    }
+    inflight_.clear();
+    for (auto &request : queued)
+    {
+        Result result;
+        result.error = "客户端已停止";
+        finish(std::move(request), result, false);
+    }
+
+    for (void *easy : idle_handles_)
+    {
+        curl_easy_cleanup(easy);
+    }
+    idle_handles_.clear();
+    curl_multi_cleanup(multi_);
+    multi_ = nullptr;
+    curl_slist_free_all(headers_);
+    headers_ = nullptr;
+    curl_global_cleanup();
+    logStats();
+}
+
+uint64_t CommandClient::reserve()
+{
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (!running_)
+    {
+        return 0;
+    }
+    uint64_t id = ++next_id_;
+    reserved_.insert(id);
+    return id;
+}
+
+void CommandClient::release(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    reserved_.erase(id);
+    withdrawn_.erase(id);
+}
+
+uint64_t CommandClient::post(const std::string &endpoint, const std::string &body, int deadline_ms, bool bypass_breaker, const Callback &callback,
+                             uint64_t reserved)
+{
+    std::unique_ptr<Request> request(new Request());
+    request->url            = base_url_ + endpoint;
+    request->body           = body;
+    request->bypass_breaker = bypass_breaker;
+    request->callback       = callback;
+    request->posted         = Clock::now();
+    request->deadline       = request->posted + std::chrono::milliseconds(deadline_ms > 0 ? deadline_ms : deadline_ms_);
+
+    bool withdrawn = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (reserved != 0)
+        {
+            reserved_.erase(reserved);
+            withdrawn = withdrawn_.erase(reserved) != 0;
+        }
+        if (running_ && !withdrawn)
+        {
+            uint64_t id = reserved != 0 ? reserved : ++next_id_;
+            request->id = id;
+            queue_.push_back(std::move(request));
+            // 在锁内唤醒，stop()要先拿到锁才会释放multi句柄
+            curl_multi_wakeup(multi_);
+            return id;
+        }
+    }
+    Result result;
+    if (withdrawn)
+    {
+        // 预留的编号在post()之前已被撤回，不发出
+        result.error     = "已取消";
+        result.cancelled = true;
+        finish(std::move(request), result, false);
+        return reserved;
+    }
+    result.error = "客户端未启动";
+    finish(std::move(request), result, false);
+    return 0;
+}
+
+void CommandClient::cancel(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (reserved_.erase(id) != 0)
+    {
+        // 还没post()，等post()时撤回
+        withdrawn_.insert(id);
+        return;
+    }
+    if (running_ && id != 0)
+    {
+        cancels_.push_back(id);
+        curl_multi_wakeup(multi_);
+    }
+}
+
+CommandClient::Stats CommandClient::getStats() const
+{
+    Stats stats;
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats.sent            = sent_;
+    stats.ok              = ok_;
+    stats.failed          = failed_;
+    stats.timeouts        = timeouts_;
+    stats.rejected        = rejected_;
+    stats.cancelled       = cancelled_;
+    stats.new_connections = new_connections_;
+    stats.avg_latency_ms  = sent_ > 0 ? total_latency_ms_ / sent_ : 0;
+    stats.max_latency_ms  = max_latency_ms_;
+    stats.breaker         = breakerName(breaker_);
+    return stats;
+}
+
+void CommandClient::run()
+{
+    while (true)
+    {
+        std::deque<std::unique_ptr<Request>> incoming;
+        std::vector<uint64_t> cancels;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (stopping_)
+            {
+                break;
+            }
+            incoming.swap(queue_);
+            cancels.swap(cancels_);
+        }
+        // 先撤回再发新请求，停止指令发出时被它撤回的移动已经断开
+        for (uint64_t id : cancels)
+        {
+            abort(id, incoming);
+        }
+        for (auto &request : incoming)
+        {
+            if (request)
+            {
+                dispatch(std::move(request));
+            }
+        }
+
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+        int left = 0;
+        CURLMsg *msg;
+        while ((msg = curl_multi_info_read(multi_, &left)) != nullptr)
+        {
+            if (msg->msg == CURLMSG_DONE)
+            {
+                complete(msg->easy_handle, msg->data.result);
+            }
+        }
+
+        // 有连接可读写、curl内部定时器到期或post()唤醒时返回
+        curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+    }
+}
+
+void CommandClient::dispatch(std::unique_ptr<Request> request)
+{
+    const char *rejected = admit(*request);
+    if (rejected != nullptr)
+    {
+        Result result;
+        result.error = rejected;
+        finish(std::move(request), result, false);
+        return;
+    }
+
+    long remaining_ms = (long)std::chrono::duration_cast<std::chrono::milliseconds>(request->deadline - Clock::now()).count();
+    CURL *easy        = nullptr;
+    if (!idle_handles_.empty())
+    {
+        easy = idle_handles_.back();
+        idle_handles_.pop_back();
+        curl_easy_reset(easy);
+    }
+    else
+    {
+        easy = curl_easy_init();
+    }
+    if (easy == nullptr)
+    {
+        // 本地分配失败不说明控制器状态，只归还探测名额，否则半开状态再也放不出探测请求
+        if (request->probe)
+        {
+            probe_inflight_ = false;
+        }
+        Result result;
+        result.error = "curl_easy_init失败";
+        finish(std::move(request), result, false);
+        return;
+    }
+
+    curl_easy_setopt(easy, CURLOPT_URL, request->url.c_str());
+    curl_easy_setopt(easy, CURLOPT_POST, 1L);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request->body.c_str());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, (long)request->body.size());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headers_);
+    // 截止时间覆盖排队和传输，连接超时不超过剩余时间
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, (std::max)(remaining_ms, 1L));
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, (std::max)((std::min)((long)connect_timeout_ms_, remaining_ms), 1L));
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, onWrite);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &request->response);
+    // 禁用SSL验证（仅用于测试环境）
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 0L);
+
+    curl_multi_add_handle(multi_, easy);
+    inflight_[easy] = std::move(request);
+}
+
+void CommandClient::abort(uint64_t id, std::deque<std::unique_ptr<Request>> &incoming)
+{
+    Result result;
+    result.error     = "已取消";
+    result.cancelled = true;
+    for (auto &request : incoming)
+    {
+        if (request && request->id == id)
+        {
+            finish(std::move(request), result, false);
+            return;
+        }
+    }
+
+    for (auto it = inflight_.begin(); it != inflight_.end(); ++it)
+    {
+        if (it->second->id != id)
+        {
+            continue;
+        }
+        std::unique_ptr<Request> request = std::move(it->second);
+        CURL *easy                       = it->first;
+        inflight_.erase(it);
+        // 传输中途移除，curl会关掉这条连接而不是放回连接池
+        curl_multi_remove_handle(multi_, easy);
+        idle_handles_.push_back(easy);
+        if (request->probe)
+        {
+            probe_inflight_ = false;
+        }
+        LOG_INFO("指令客户端: 撤回正在传输的请求 %s", request->url.c_str());
+        finish(std::move(request), result, true);
+        return;
+    }
+}
+
+void CommandClient::complete(void *easy, int code)
+{
+    auto it = inflight_.find(easy);
+    if (it == inflight_.end())
+    {
+        return;
+    }
+    std::unique_ptr<Request> request = std::move(it->second);
+    inflight_.erase(it);
+    curl_multi_remove_handle(multi_, easy);
+
+    Result result;
+    long connects = 0;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &result.http_code);
+    curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+    idle_handles_.push_back(easy);
+
+    result.ok   = code == CURLE_OK && result.http_code >= 200 && result.http_code < 300;
+    result.body = std::move(request->response);
+    if (code != CURLE_OK)
+    {
+        result.error = curl_easy_strerror((CURLcode)code);
+    }
+    else if (!result.ok)
+    {
+        result.error = "HTTP " + std::to_string(result.http_code);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        new_connections_ += (int)connects;
+        if (code == CURLE_OPERATION_TIMEDOUT)
+        {
+            timeouts_++;
+        }
+    }
+    // 4xx是请求本身的问题，不说明控制器不可用
+    onOutcome(code == CURLE_OK && result.http_code < 500, request->probe);
+    finish(std::move(request), result, true);
+}
+
+void CommandClient::finish(std::unique_ptr<Request> request, Result &result, bool sent)
+{
+    result.latency_ms = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - request->posted).count() / 1000.0;
+
+    int total = 0;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        if (result.cancelled)
+        {
+            cancelled_++;
+        }
+        else if (!sent)
+        {
+            rejected_++;
+        }
+        else
+        {
+            sent_++;
+            total_latency_ms_ += result.latency_ms;
+            max_latency_ms_ = (std::max)(max_latency_ms_, result.latency_ms);
+            if (result.ok)
+            {
+                ok_++;
+            }
+            else
+            {
+                failed_++;
+            }
+        }
+        total = sent_ + rejected_ + cancelled_;
+    }
+
+    if (request->callback)
+    {
+        request->callback(result);
+    }
+    if (total % 20 == 0)
+    {
+        logStats();
+    }
+}
+
+const char *CommandClient::admit(Request &request)
+{
+    Clock::time_point now = Clock::now();
+    if (request.deadline <= now)
+    {
+        return "发送前已过截止时间";
+    }
+
+    if (breaker_ == BREAKER_OPEN && now >= open_until_)
+    {
+        breaker_ = BREAKER_HALF_OPEN;
+        LOG_INFO("指令客户端: 熔断时间到，放行一个探测请求");
+    }
+    if (breaker_ == BREAKER_CLOSED || request.bypass_breaker)
+    {
+        return nullptr;
+    }
+    if (breaker_ == BREAKER_HALF_OPEN && !probe_inflight_)
+    {
+        probe_inflight_ = true;
+        request.probe   = true;
+        return nullptr;
+    }
+    return "控制器熔断中";
+}
+
+void CommandClient::onOutcome(bool success, bool probe)
+{
+    if (probe)
+    {
+        probe_inflight_ = false;
+    }
+    if (success)
+    {
+        if (breaker_ != BREAKER_CLOSED)
+        {
+            LOG_INFO("指令客户端: 控制器恢复，结束熔断");
+        }
+        breaker_              = BREAKER_CLOSED;
+        consecutive_failures_ = 0;
+        return;
+    }
+
+    consecutive_failures_++;
+    if ((breaker_ == BREAKER_HALF_OPEN && probe) || (breaker_ == BREAKER_CLOSED && consecutive_failures_ >= breaker_failures_))
+    {
+        breaker_    = BREAKER_OPEN;
+        open_until_ = Clock::now() + std::chrono::milliseconds(breaker_open_ms_);
+        LOG_WARN("指令客户端: 连续失败 %d 次，熔断 %d ms", consecutive_failures_, breaker_open_ms_);
+    }
+}
+
+void CommandClient::logStats()
+{
+    Stats stats = getStats();
+    LOG_INFO("指令客户端: 发出 %d 成功 %d 失败 %d (超时 %d) 拒绝 %d 撤回 %d, 新建连接 %d, 平均 %.1f ms 最大 %.1f ms, 熔断 %s", stats.sent,
+             stats.ok, stats.failed, stats.timeouts, stats.rejected, stats.cancelled, stats.new_connections, stats.avg_latency_ms,
+             stats.max_latency_ms, stats.breaker);
+}
+
+size_t CommandClient::onWrite(void *contents, size_t size, size_t nmemb, void *userp)
+{
+    size_t total_size     = size * nmemb;
+    std::string *response = static_cast<std::string *>(userp);
+    response->append(static_cast<char *>(contents), total_size);
+    return total_size;
+}
+
+const char *CommandClient::breakerName(int state)
+{
+    switch (state)
+    {
+        case BREAKER_OPEN:
+            return "open";
+        case BREAKER_HALF_OPEN:
+            return "half_open";
+        default:
+            return "closed";
+    }
+}
@@ -0,0 +1,181 @@
+/**
+ * @file command_client.h
+ * @brief 机器人运动控制器的HTTP指令客户端
+ * @details 原来每条指令在AIUI回调线程里curl_easy_perform同步请求、每次新建连接，控制器一慢整个AIUI事件处理都卡住。
+ *          这里由专门的线程用curl multi收发：post()只把请求放进队列并唤醒线程，结果在客户端线程中回调；
+ *          连接保持长连接复用，同一控制器最多max_connections条。
+ *          每个请求带截止时间，排队和传输都算在内，到时按超时失败。
+ *          熔断：连续breaker_failures次失败（传输错误或5xx）后断开breaker_open_ms，期间请求直接失败不再发出；
+ *          之后放行一个探测请求，成功则恢复。停止指令可以绕过熔断，始终尝试发送。
+ *          cancel()可以撤回排队中或正在传输的请求，传输中的会直接断开所在连接。
+ *          调用方需要在post()之前就能撤回时，先用reserve()拿到编号，post()时带上。
+ */
+#ifndef COMMAND_CLIENT_H
+#define COMMAND_CLIENT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct curl_slist;
+
+class CommandClient
+{
+public:
+    struct Result
+    {
+        bool ok           = false;    // 传输成功且状态码为2xx
+        long http_code    = 0;
+        std::string body;
+        std::string error;            // 失败原因
+        bool cancelled    = false;    // 被cancel()撤回
+        double latency_ms = 0;        // post()到收到响应的耗时
+    };
+
+    typedef std::function<void(const Result &result)> Callback;
+
+    struct Stats
+    {
+        int sent              = 0;    // 实际发出的请求
+        int ok                = 0;
+        int failed            = 0;    // 发出后失败，含超时
+        int timeouts          = 0;
+        int rejected          = 0;    // 熔断或已过截止时间，没有发出
+        int cancelled         = 0;    // 被cancel()撤回，不计入发出和失败
+        int new_connections   = 0;    // 新建的连接数，其余请求复用已有连接
+        double avg_latency_ms = 0;
+        double max_latency_ms = 0;
+        const char *breaker   = "closed";
+    };
+
+    static CommandClient &getInstance();
+
+    /**
+     * @brief 按robot.cfg的robot_command配置启动客户端线程，在main中其他线程启动前调用
+     */
+    bool start();
+
+    /**
+     * @brief 停止线程，未完成的请求按失败回调
+     */
+    void stop();
+
+    /**
+     * @brief 预留一个请求编号，之后post()时带上；post()之前cancel()的，post()时直接以cancelled回调，不会发出
+     * @return 客户端未启动时返回0
+     */
+    uint64_t reserve();
+
+    /**
+     * @brief 放弃reserve()预留、不再post()的编号
+     */
+    void release(uint64_t id);
+
+    /**
+     * @brief 异步POST一条JSON指令
+     * @param endpoint 接口路径，拼在base_url之后
+     * @param deadline_ms 截止时间，<=0使用配置的默认值
+     * @param bypass_breaker 熔断时也发送
+     * @param callback 在客户端线程中回调，可为空；预留编号已被撤回时在本线程回调
+     * @param reserved reserve()预留的编号，为0时新分配
+     * @return 请求编号，用于cancel()；客户端未启动时返回0，此时callback已按失败回调
+     */
+    uint64_t post(const std::string &endpoint, const std::string &body, int deadline_ms, bool bypass_breaker, const Callback &callback,
+                  uint64_t reserved = 0);
+
+    /**
+     * @brief 撤回一个请求：还在排队的不再发出，正在传输的断开连接，都以cancelled回调
+     * @details 在客户端线程中执行，早于之后post()的请求生效；预留了编号还没post()的，post()时撤回；
+     *          请求已完成时什么也不做
+     */
+    void cancel(uint64_t id);
+
+    Stats getStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    enum BreakerState
+    {
+        BREAKER_CLOSED,
+        BREAKER_OPEN,
+        BREAKER_HALF_OPEN
+    };
+
+    struct Request
+    {
+        uint64_t id = 0;
+        std::string url;
+        std::string body;
+        bool bypass_breaker = false;
+        bool probe          = false;    // 半开状态下的探测请求
+        Callback callback;
+        Clock::time_point posted;
+        Clock::time_point deadline;
+        std::string response;
+    };
+
+    CommandClient() = default;
+    ~CommandClient();
+
+    void run();
+    void dispatch(std::unique_ptr<Request> request);
+    void abort(uint64_t id, std::deque<std::unique_ptr<Request>> &incoming);
+    void complete(void *easy, int code);
+    void finish(std::unique_ptr<Request> request, Result &result, bool sent);
+    const char *admit(Request &request);    // 返回不能发出的原因，可以发出时返回nullptr
+    void onOutcome(bool success, bool probe);
+    void logStats();
+
+    static size_t onWrite(void *contents, size_t size, size_t nmemb, void *userp);
+    static const char *breakerName(int state);
+
+    std::string base_url_;
+    int deadline_ms_        = 3000;
+    int connect_timeout_ms_ = 500;
+    int breaker_failures_   = 3;
+    int breaker_open_ms_    = 5000;
+
+    std::thread thread_;
+    bool running_        = false;    // 受queue_mutex_保护
+    void *multi_         = nullptr;    // CURLM
+    curl_slist *headers_ = nullptr;
+
+    std::mutex queue_mutex_;
+    std::deque<std::unique_ptr<Request>> queue_;
+    std::vector<uint64_t> cancels_;
+    std::unordered_set<uint64_t> reserved_;     // 预留了还没post()的编号
+    std::unordered_set<uint64_t> withdrawn_;    // 其中post()之前已被撤回的
+    uint64_t next_id_ = 0;
+    bool stopping_    = false;
+
+    // 以下只在客户端线程中访问
+    std::unordered_map<void *, std::unique_ptr<Request>> inflight_;    // easy句柄 -> 请求
+    std::vector<void *> idle_handles_;    // 用过的easy句柄，复用省去重新初始化
+    int consecutive_failures_ = 0;
+    Clock::time_point open_until_;
+    bool probe_inflight_ = false;
+
+    std::atomic<int> breaker_{ BREAKER_CLOSED };
+    mutable std::mutex stats_mutex_;
+    int sent_            = 0;
+    int ok_              = 0;
+    int failed_          = 0;
+    int timeouts_        = 0;
+    int rejected_        = 0;
+    int cancelled_       = 0;
+    int new_connections_     = 0;
+    double total_latency_ms_ = 0;
+    double max_latency_ms_   = 0;
+};
+
+#endif    // COMMAND_CLIENT_H
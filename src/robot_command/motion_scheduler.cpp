@@ -0,0 +1,348 @@
+#include "robot_command/motion_scheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "robot_avvtn_msgs/msg/motion_command.hpp"
+#include "ros2/ros_manager.hpp"
+#include "utils/AppConfig.h"
+#include "utils/JsonDocument.h"
+#include "utils/Logger.hpp"
+
+// 距离是否为完整的数字
+static bool parseNumber(const std::string &text, double &value)
+{
+    if (text.empty())
+    {
+        return false;
+    }
+    char *end = nullptr;
+    value     = strtod(text.c_str(), &end);
+    return end != nullptr && *end == '\0';
+}
+
+// robot_avvtn_cmd_*话题的消息，字段与HTTP接口body的data对应
+static std::unique_ptr<robot_avvtn_msgs::msg::MotionCommand> buildMessage(const MotionScheduler::Command &command)
+{
+    std::unique_ptr<robot_avvtn_msgs::msg::MotionCommand> message(new robot_avvtn_msgs::msg::MotionCommand());
+    message->distance = std::numeric_limits<double>::quiet_NaN();
+    if (command.type == MotionScheduler::STOP)
+    {
+        return message;
+    }
+    message->id          = command.id;
+    message->intent_name = command.intent_name;
+    if (command.type != MotionScheduler::ACTION)
+    {
+        double distance = 0;
+        message->unit   = command.unit;
+        if (parseNumber(command.distance, distance))
+        {
+            message->distance = distance;
+        }
+    }
+    return message;
+}
+
+MotionScheduler &MotionScheduler::getInstance()
+{
+    static MotionScheduler instance;
+    return instance;
+}
+
+void MotionScheduler::submit(const Command &command, const CommandClient::Callback &on_ack)
+{
+    Entry entry;
+    entry.command   = command;
+    entry.on_ack    = on_ack;
+    entry.submitted = Clock::now();
+
+    if (command.type == STOP)
+    {
+        // 停止不排队，也不等正在执行的指令应答
+        size_t cancelled = 0;
+        uint64_t unacked = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cancelled = pending_.size();
+            pending_.clear();
+            cancelled_ += (int)cancelled;
+            stop_generation_++;
+            unacked           = inflight_request_;
+            inflight_request_ = 0;
+        }
+        if (cancelled > 0)
+        {
+            LOG_INFO("运动调度: 停止指令取消排队中的 %zu 条指令", cancelled);
+        }
+        // 客户端先处理撤回再发出停止，两者不会在两条连接上赛跑
+        if (unacked != 0)
+        {
+            CommandClient::getInstance().cancel(unacked);
+        }
+        dispatch(entry);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pending_.empty() && tryMerge(pending_.back(), command))
+        {
+            merged_++;
+            return;
+        }
+        if (busy_)
+        {
+            pending_.push_back(entry);
+            LOG_INFO("运动调度: 上一条指令还没应答，%s指令排队，前面 %zu 条", nameOf(command.type), pending_.size() - 1);
+            return;
+        }
+        busy_ = true;
+        reserve(entry);
+    }
+    // 发送不在锁内，客户端未启动时回调会在本线程直接执行
+    dispatch(entry);
+}
+
+MotionScheduler::Stats MotionScheduler::getStats() const
+{
+    Stats stats;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.dispatched = dispatched_;
+    stats.acked      = acked_;
+    stats.failed     = failed_;
+    stats.merged     = merged_;
+    stats.cancelled  = cancelled_;
+    for (int type = 0; type < TYPE_COUNT; type++)
+    {
+        stats.avg_ack_ms[type] = ack_count_[type] > 0 ? ack_total_ms_[type] / ack_count_[type] : 0;
+        stats.max_ack_ms[type] = ack_max_ms_[type];
+    }
+    return stats;
+}
+
+void MotionScheduler::reserve(Entry &entry)
+{
+    entry.generation = stop_generation_;
+    if (AppConfig::getInstance().robot_command.via_http)
+    {
+        entry.request     = CommandClient::getInstance().reserve();
+        inflight_request_ = entry.request;
+    }
+}
+
+bool MotionScheduler::tryMerge(Entry &pending, const Command &command)
+{
+    const Command &last = pending.command;
+    if (!merge_enabled_ || (command.type != MOVE && command.type != TURN) || last.type != command.type ||
+        last.intent_name != command.intent_name || last.unit != command.unit)
+    {
+        return false;
+    }
+
+    double last_distance = 0;
+    double distance      = 0;
+    if (!parseNumber(last.distance, last_distance) || !parseNumber(command.distance, distance))
+    {
+        return false;
+    }
+
+    char merged[32];
+    snprintf(merged, sizeof(merged), "%g", last_distance + distance);
+    LOG_INFO("运动调度: 合并两条未发出的%s指令 %s: %s + %s = %s %s", nameOf(command.type), command.intent_name.c_str(), last.distance.c_str(),
+             command.distance.c_str(), merged, command.unit.c_str());
+    pending.command.distance = merged;
+    pending.command.id       = command.id;
+    pending.merged++;
+    return true;
+}
+
+void MotionScheduler::dispatch(const Entry &entry)
+{
+    const AppConfig::RobotCommandConfig &config = AppConfig::getInstance().robot_command;
+    bool is_stop                                = entry.command.type == STOP;
+    double waited_ms = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - entry.submitted).count() / 1000.0;
+    std::string body = buildBody(entry.command);
+    bool stopped     = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped = !is_stop && entry.generation != stop_generation_;
+        if (!stopped)
+        {
+            dispatched_++;
+        }
+    }
+    if (stopped)
+    {
+        // 决定发出之后、开始发送之前来了停止，不再发出
+        CommandClient::getInstance().release(entry.request);
+        CommandClient::Result result;
+        result.error     = "已取消";
+        result.cancelled = true;
+        onAck(entry, result);
+        return;
+    }
+
+    LOG_INFO("运动调度: 发送%s指令, 排队 %.1f ms, 合并 %d 条, body: %s", nameOf(entry.command.type), waited_ms, entry.merged, body.c_str());
+    const char *command = commandOf(entry.command.type);
+    CommandClient::Result published;
+    if (config.via_ros)
+    {
+        Clock::time_point start = Clock::now();
+        published.ok            = ROSManager::getInstance().publishRobotCommand(command, buildMessage(entry.command));
+        published.latency_ms    = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count() / 1000.0;
+        if (!published.ok)
+        {
+            published.error = "ROS未初始化";
+            LOG_WARN("运动调度: %s指令发布到ROS话题失败: ROS未初始化", nameOf(entry.command.type));
+        }
+    }
+
+    if (config.via_http)
+    {
+        // 停止指令截止时间更短，熔断时也要尝试发送
+        // 非停止指令用决定发出时预留的编号，其间的停止已把它撤回的话客户端不会发出
+        CommandClient::getInstance().post(std::string("/webrtc/") + command, body, is_stop ? config.stop_deadline_ms : config.deadline_ms,
+                                          is_stop, [this, entry](const CommandClient::Result &result) { onAck(entry, result); },
+                                          entry.request);
+    }
+    else
+    {
+        // 话题没有应答，发布完成即视为应答
+        onAck(entry, published);
+    }
+}
+
+void MotionScheduler::onAck(const Entry &entry, const CommandClient::Result &result)
+{
+    Type type = entry.command.type;
+    if (result.ok)
+    {
+        LOG_INFO("运动调度: %s指令应答, 发出到应答 %.1f ms, 状态码: %ld, 响应内容: %s", nameOf(type), result.latency_ms, result.http_code,
+                 result.body.c_str());
+    }
+    else if (result.cancelled)
+    {
+        LOG_INFO("运动调度: %s指令被停止撤回, 已等待 %.1f ms", nameOf(type), result.latency_ms);
+    }
+    else
+    {
+        LOG_ERROR("运动调度: %s指令失败: %s, 耗时 %.1f ms", nameOf(type), result.error.c_str(), result.latency_ms);
+    }
+
+    bool has_next = false;
+    Entry next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (result.ok)
+        {
+            acked_++;
+            ack_count_[type]++;
+            ack_total_ms_[type] += result.latency_ms;
+            ack_max_ms_[type] = (std::max)(ack_max_ms_[type], result.latency_ms);
+        }
+        else if (result.cancelled)
+        {
+            cancelled_++;
+        }
+        else
+        {
+            failed_++;
+        }
+
+        // 停止不占用发送顺序
+        if (type != STOP)
+        {
+            inflight_request_ = 0;
+            has_next = !pending_.empty();
+            if (has_next)
+            {
+                next = pending_.front();
+                pending_.pop_front();
+                reserve(next);
+            }
+            busy_ = has_next;
+        }
+    }
+
+    if (entry.on_ack)
+    {
+        entry.on_ack(result);
+    }
+    if (type == STOP)
+    {
+        logStats();
+    }
+    if (has_next)
+    {
+        dispatch(next);
+    }
+}
+
+void MotionScheduler::logStats()
+{
+    Stats stats = getStats();
+    LOG_INFO("运动调度: 发出 %d 应答 %d 失败 %d 合并 %d 取消 %d; 发出到应答平均/最大(ms) 移动 %.1f/%.1f 转向 %.1f/%.1f 动作 %.1f/%.1f 停止 %.1f/%.1f",
+             stats.dispatched, stats.acked, stats.failed, stats.merged, stats.cancelled, stats.avg_ack_ms[MOVE], stats.max_ack_ms[MOVE],
+             stats.avg_ack_ms[TURN], stats.max_ack_ms[TURN], stats.avg_ack_ms[ACTION], stats.max_ack_ms[ACTION], stats.avg_ack_ms[STOP],
+             stats.max_ack_ms[STOP]);
+}
+
+std::string MotionScheduler::buildBody(const Command &command)
+{
+    std::string body;
+    JsonWriter writer(body);
+    writer.StartObject().Key("data");
+    switch (command.type)
+    {
+        case MOVE:
+        case TURN:
+            writer.StartObject()
+                .Key("distance").String(command.distance)
+                .Key("id").String(command.id)
+                .Key("intent_name").String(command.intent_name)
+                .Key(command.type == MOVE ? "move_unit" : "turn_unit").String(command.unit)
+                .EndObject();
+            break;
+        case ACTION:
+            writer.StartObject().Key("id").String(command.id).Key("intent_name").String(command.intent_name).EndObject();
+            break;
+        default:
+            writer.Null();
+            break;
+    }
+    writer.EndObject();
+    return body;
+}
+
+const char *MotionScheduler::commandOf(Type type)
+{
+    switch (type)
+    {
+        case MOVE:
+            return "move";
+        case TURN:
+            return "turn";
+        case ACTION:
+            return "action";
+        default:
+            return "stop";
+    }
+}
+
+const char *MotionScheduler::nameOf(Type type)
+{
+    switch (type)
+    {
+        case MOVE:
+            return "移动";
+        case TURN:
+            return "转向";
+        case ACTION:
+            return "动作";
+        default:
+            return "停止";
+    }
+}
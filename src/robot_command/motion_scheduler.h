@@ -0,0 +1,113 @@
+/**
+ * @file motion_scheduler.h
+ * @brief 运动指令调度
+ * @details 移动、转向、动作指令逐条发给控制器：前一条收到应答后才发下一条，其间到达的指令排队。
+ *          排队中相邻的同类移动或转向（意图和单位相同、距离是数字）合并成一条，距离相加。
+ *          停止指令不排队，立即发出并取消排队中的指令，控制器那边正在执行的由停止本身打断。
+ *          还没应答的那条HTTP请求在停止发出前撤回：停止绕过排队走另一条连接，不撤回的话它可能晚于停止到达控制器。
+ *          决定发出某条指令时就在锁内预留好请求编号，停止总能撤回它，哪怕它还没交给指令客户端；
+ *          已决定发出但还没开始发送时遇到停止的指令不再发出。
+ *          每条指令记录从发出到应答的耗时，按类型统计。
+ *          按robot.cfg的robot_command.transport走HTTP接口、robot_avvtn_cmd_*话题（robot_avvtn_msgs/MotionCommand）或两者都发；
+ *          只走话题时没有应答，发布完成即视为应答，排队的指令随即发出。
+ *          submit()可在任意线程调用，应答在指令客户端线程中处理。
+ */
+#ifndef MOTION_SCHEDULER_H
+#define MOTION_SCHEDULER_H
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "robot_command/command_client.h"
+
+class MotionScheduler
+{
+public:
+    enum Type
+    {
+        MOVE,
+        TURN,
+        ACTION,
+        STOP,
+        TYPE_COUNT
+    };
+
+    struct Command
+    {
+        Type type = MOVE;
+        std::string intent_name;
+        std::string id;
+        std::string distance;    // 移动和转向
+        std::string unit;        // move_unit或turn_unit
+    };
+
+    struct Stats
+    {
+        int dispatched = 0;
+        int acked      = 0;
+        int failed     = 0;
+        int merged     = 0;    // 合并掉的指令条数
+        int cancelled  = 0;    // 被停止取消的排队指令和撤回的未应答指令
+        double avg_ack_ms[TYPE_COUNT] = {};    // 各类指令发出到应答的平均耗时
+        double max_ack_ms[TYPE_COUNT] = {};
+    };
+
+    static MotionScheduler &getInstance();
+
+    void setMergeEnabled(bool enabled) { merge_enabled_ = enabled; }
+
+    /**
+     * @brief 提交一条指令
+     * @param on_ack 收到应答或失败时在指令客户端线程中回调，result.latency_ms为发出到应答的耗时；
+     *               排队中被取消的指令不回调，发出后被停止撤回的以result.cancelled回调
+     */
+    void submit(const Command &command, const CommandClient::Callback &on_ack = nullptr);
+
+    Stats getStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        Command command;
+        CommandClient::Callback on_ack;
+        Clock::time_point submitted;
+        int merged = 0;    // 合并进来的指令条数
+        uint64_t request    = 0;    // 预留的HTTP请求编号
+        uint64_t generation = 0;    // 决定发出时的停止次数
+    };
+
+    MotionScheduler() = default;
+
+    bool tryMerge(Entry &pending, const Command &command);
+    void reserve(Entry &entry);    // 持有mutex_时调用
+    void dispatch(const Entry &entry);
+    void onAck(const Entry &entry, const CommandClient::Result &result);
+    void logStats();
+
+    static std::string buildBody(const Command &command);
+    static const char *commandOf(Type type);    // HTTP接口路径和ROS话题中的指令名
+    static const char *nameOf(Type type);
+
+    bool merge_enabled_ = true;
+
+    mutable std::mutex mutex_;
+    std::deque<Entry> pending_;
+    bool busy_ = false;    // 有移动、转向或动作指令在等应答
+    uint64_t inflight_request_ = 0;    // 等应答的那条指令的HTTP请求编号，停止时撤回
+    uint64_t stop_generation_  = 0;    // 停止指令的次数
+
+    int dispatched_ = 0;
+    int acked_      = 0;
+    int failed_     = 0;
+    int merged_     = 0;
+    int cancelled_  = 0;
+    int ack_count_[TYPE_COUNT]       = {};
+    double ack_total_ms_[TYPE_COUNT] = {};
+    double ack_max_ms_[TYPE_COUNT]   = {};
+};
+
+#endif    // MOTION_SCHEDULER_H
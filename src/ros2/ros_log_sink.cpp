@@ -0,0 +1,118 @@
+#include "ros_log_sink.hpp"
+
+#include <chrono>
+
+#include "ros_manager.hpp"
+
+RosLogSink::RosLogSink(Logger::LogLevel min_level, int max_lines_per_sec, int batch_ms, size_t queue_size)
+    : min_level_(min_level), max_lines_per_sec_(max_lines_per_sec), batch_ms_(batch_ms > 0 ? batch_ms : 200),
+      queue_size_(queue_size > 0 ? queue_size : 1024) {
+    worker_ = std::thread(&RosLogSink::Run, this);
+    worker_id_ = worker_.get_id();
+}
+
+RosLogSink::~RosLogSink() {
+    Stop();
+}
+
+void RosLogSink::Write(const Logger::LogEntry& entry, const std::string& formatted) {
+    (void)formatted;
+    if (static_cast<int>(entry.level) < static_cast<int>(min_level_)) return;
+    if (entry.threadId == worker_id_.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (max_lines_per_sec_ > 0) {
+        long long now_sec = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        if (window_sec_ != now_sec) {
+            window_sec_ = now_sec;
+            window_count_ = 0;
+        }
+        if (window_count_++ >= max_lines_per_sec_) {
+            stats_.dropped_rate++;
+            return;
+        }
+    }
+    if (pending_lines_ >= queue_size_) {
+        stats_.dropped_full++;
+        return;
+    }
+
+    // 与原来一样只发布消息正文
+    pending_.append(entry.message);
+    pending_.push_back('\n');
+    pending_lines_++;
+}
+
+void RosLogSink::Flush() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_requested_ = true;
+    }
+    cv_.notify_one();
+}
+
+void RosLogSink::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+RosLogSink::Stats RosLogSink::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void RosLogSink::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        cv_.wait_for(lock, std::chrono::milliseconds(batch_ms_), [this] { return !running_ || flush_requested_; });
+        flush_requested_ = false;
+        lock.unlock();
+        PublishBatch();
+        lock.lock();
+    }
+    lock.unlock();
+    PublishBatch();
+}
+
+void RosLogSink::PublishBatch() {
+    uint64_t lines = 0;
+    Stats snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch_.clear();
+        batch_.swap(pending_);
+        lines = pending_lines_;
+        pending_lines_ = 0;
+        snapshot = stats_;
+    }
+
+    uint64_t dropped = snapshot.dropped_rate + snapshot.dropped_full + snapshot.dropped_offline;
+    if (!batch_.empty()) batch_.pop_back();    // 去掉最后一行的换行
+    if (dropped > reported_dropped_) {
+        if (!batch_.empty()) batch_ += '\n';
+        batch_ += "[robot_avvtn_log] 丢弃 " + std::to_string(dropped - reported_dropped_) +
+                  " 行 (累计超限 " + std::to_string(snapshot.dropped_rate) + " 行, 缓冲满 " +
+                  std::to_string(snapshot.dropped_full) + " 行, ROS未初始化 " +
+                  std::to_string(snapshot.dropped_offline) + " 行)";
+    }
+    if (batch_.empty()) return;
+
+    bool published = ROSManager::getInstance().publishLog(batch_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (published) {
+        reported_dropped_ = dropped;
+        stats_.published_lines += lines;
+        stats_.batches++;
+    } else {
+        // 这批没有发出去，丢弃说明留到下一次
+        stats_.dropped_offline += lines;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef ROS_LOG_SINK_HPP
+#define ROS_LOG_SINK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "utils/Logger.hpp"
+
+/**
+ * 日志通过ROS话题robot_avvtn_log发布的输出目标。
+ * 原来每行日志在调用线程里同步publish一次，音频线程的日志也要等DDS；这里写日志只把消息追加到待发缓冲，
+ * 后台线程每batch_ms与之交换，多行用换行拼成一条消息发布。两块缓冲轮流使用，容量保留，稳定后不再分配。
+ * Write由Logger在其锁内调用，同一时刻只有一个写入方，缓冲用一把短锁和后台线程交换即可。
+ * 有自己的最低级别和每秒行数上限，超限、缓冲满或ROS未初始化的行丢弃并计数，下一条消息末尾注明丢了多少。
+ * 后台线程自己产生的日志不再回送，避免发布时打日志形成循环。
+ */
+class RosLogSink : public Logger::LogSink {
+public:
+    struct Stats {
+        uint64_t published_lines = 0;
+        uint64_t batches = 0;
+        uint64_t dropped_rate = 0;    // 超过每秒行数上限丢弃
+        uint64_t dropped_full = 0;    // 缓冲满丢弃
+        uint64_t dropped_offline = 0; // ROS未初始化，发布失败丢弃
+    };
+
+    /**
+     * @param min_level 低于该级别的日志不发布
+     * @param max_lines_per_sec 每秒最多发布的行数，<=0不限
+     * @param batch_ms 发布间隔
+     * @param queue_size 一个发布间隔内最多积攒的行数
+     */
+    RosLogSink(Logger::LogLevel min_level, int max_lines_per_sec, int batch_ms, size_t queue_size);
+    ~RosLogSink();
+
+    void Write(const Logger::LogEntry& entry, const std::string& formatted) override;
+
+    // 唤醒后台线程立即发布当前积攒的日志
+    void Flush() override;
+
+    // 发布剩余日志后停止后台线程，须在ROSManager::shutdown()之前调用
+    void Stop();
+
+    Stats GetStats() const;
+
+private:
+    void Run();
+    void PublishBatch();
+
+    Logger::LogLevel min_level_;
+    int max_lines_per_sec_;
+    int batch_ms_;
+
+    size_t queue_size_;
+
+    // 以下受mutex_保护
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string pending_;                      // 待发布的行，每行以'\n'结尾
+    size_t pending_lines_ = 0;
+    long long window_sec_ = 0;                 // 限速的当前秒
+    int window_count_ = 0;                     // 当前秒已接收的行数
+    Stats stats_;
+    bool running_ = true;
+    bool flush_requested_ = false;
+
+    // 以下只在后台线程访问
+    std::string batch_;                        // 与pending_交换后发布
+    uint64_t reported_dropped_ = 0;            // 已在消息中注明过的丢弃行数
+
+    std::thread worker_;
+    std::atomic<std::thread::id> worker_id_;
+};
+
+#endif // ROS_LOG_SINK_HPP
@@ -1,4 +1,5 @@
 #include "ros_manager.hpp"
+#include "utils/AppConfig.h"
 #include "utils/Logger.hpp"
 
 ROSManager& ROSManager::getInstance() {
@@ -12,8 +13,10 @@ void ROSManager::init(int argc, char const *argv[]) {
     // 初始化ROS2
     rclcpp::init(argc, argv);
 
-    // 创建节点
-    node_ = std::make_shared<rclcpp::Node>("robot_avvtn_node");
+    // 创建节点，同进程内的控制器可以走进程内通信，不经过DDS序列化
+    const AppConfig::RobotCommandConfig& command_config = AppConfig::getInstance().robot_command;
+    node_ = std::make_shared<rclcpp::Node>("robot_avvtn_node",
+        rclcpp::NodeOptions().use_intra_process_comms(command_config.ros_intra_process));
 
     // 创建发布器
     log_publisher_ = node_->create_publisher<std_msgs::msg::String>("robot_avvtn_log", 10);
@@ -21,6 +24,15 @@ void ROSManager::init(int argc, char const *argv[]) {
     status_publisher_ = node_->create_publisher<std_msgs::msg::String>("robot_avvtn_status", 10);
     chat_history_nostream_publisher_ = node_->create_publisher<std_msgs::msg::String>("robot_avvtn_chat_history_nostream", 10);
     wakeup_detail_publisher_ = node_->create_publisher<std_msgs::msg::String>("avvtn_wake", 10);
+    chat_partial_publisher_ = node_->create_publisher<std_msgs::msg::String>("robot_avvtn_chat_partial", 10);
+
+    // 运动指令不能丢，使用可靠传输
+    rclcpp::QoS command_qos = rclcpp::QoS(10).reliable();
+    using robot_avvtn_msgs::msg::MotionCommand;
+    cmd_move_publisher_ = node_->create_publisher<MotionCommand>("robot_avvtn_cmd_move", command_qos);
+    cmd_turn_publisher_ = node_->create_publisher<MotionCommand>("robot_avvtn_cmd_turn", command_qos);
+    cmd_action_publisher_ = node_->create_publisher<MotionCommand>("robot_avvtn_cmd_action", command_qos);
+    cmd_stop_publisher_ = node_->create_publisher<MotionCommand>("robot_avvtn_cmd_stop", command_qos);
 
     LOG_INFO("ROS管理器初始化成功");
     initialized_ = true;
@@ -37,12 +49,13 @@ std::shared_ptr<rclcpp::Node> ROSManager::getNode() {
     return node_;
 }
 
-void ROSManager::publishLog(const std::string& log_msg) {
-    if (!initialized_) return;
+bool ROSManager::publishLog(const std::string& log_msg) {
+    if (!initialized_) return false;
 
     auto message = std_msgs::msg::String();
     message.data = log_msg;
     log_publisher_->publish(message);
+    return true;
 }
 
 void ROSManager::publishChatHistory(const std::string& chat_msg) {
@@ -74,6 +87,14 @@ void ROSManager::publishChatHistoryNoStream(const std::string& status_msg) {
     chat_history_nostream_publisher_->publish(message);
 }
 
+void ROSManager::publishChatPartial(const std::string& partial_msg) {
+    if (!initialized_) return;
+
+    auto message = std_msgs::msg::String();
+    message.data = partial_msg;
+    chat_partial_publisher_->publish(message);
+}
+
 void ROSManager::publishWakeupDetail(const std::string& status_msg) {
     if (!initialized_) return;
 
@@ -82,6 +103,28 @@ void ROSManager::publishWakeupDetail(const std::string& status_msg) {
     wakeup_detail_publisher_->publish(message);
 }
 
+bool ROSManager::publishRobotCommand(const std::string& command, std::unique_ptr<robot_avvtn_msgs::msg::MotionCommand> message) {
+    if (!initialized_) return false;
+
+    rclcpp::Publisher<robot_avvtn_msgs::msg::MotionCommand>::SharedPtr publisher;
+    if (command == "move") {
+        publisher = cmd_move_publisher_;
+    } else if (command == "turn") {
+        publisher = cmd_turn_publisher_;
+    } else if (command == "action") {
+        publisher = cmd_action_publisher_;
+    } else if (command == "stop") {
+        publisher = cmd_stop_publisher_;
+    } else {
+        return false;
+    }
+
+    // 以unique_ptr发布，进程内通信时直接转交消息不拷贝
+    message->stamp = node_->now();
+    publisher->publish(std::move(message));
+    return true;
+}
+
 void ROSManager::subscribeTopic(const std::string& topic_name,
                                std::function<void(const std_msgs::msg::String::SharedPtr)> callback) {
     if (!initialized_) return;
@@ -5,6 +5,7 @@
 #include <string>
 #include <rclcpp/rclcpp.hpp>
 #include <std_msgs/msg/string.hpp>
+#include <robot_avvtn_msgs/msg/motion_command.hpp>
 
 class ROSManager {
 public:
@@ -17,8 +18,8 @@ public:
     // 获取节点
     std::shared_ptr<rclcpp::Node> getNode();
     
-    // 发布日志
-    void publishLog(const std::string& log_msg);
+    // 发布日志，ROS未初始化时返回false
+    bool publishLog(const std::string& log_msg);
     
     // 发布聊天历史
     void publishChatHistory(const std::string& chat_msg);
@@ -29,8 +30,14 @@ public:
     // 发布聊天历史(非流式文本)
     void publishChatHistoryNoStream(const std::string& chat_msg);
 
+    // 发布识别中间结果（用户说话过程中的实时字幕）
+    void publishChatPartial(const std::string& partial_msg);
+
     // 发布带角度的唤醒消息给PC2做转向动作
     void publishWakeupDetail(const std::string& chat_msg);
+
+    // 发布运动指令，command为move/turn/action/stop，stamp在这里填写；未初始化或未知指令返回false
+    bool publishRobotCommand(const std::string& command, std::unique_ptr<robot_avvtn_msgs::msg::MotionCommand> message);
     
     // 订阅话题
     void subscribeTopic(const std::string& topic_name, 
@@ -53,6 +60,11 @@ private:
     rclcpp::Publisher<std_msgs::msg::String>::SharedPtr status_publisher_;
     rclcpp::Publisher<std_msgs::msg::String>::SharedPtr chat_history_nostream_publisher_;
     rclcpp::Publisher<std_msgs::msg::String>::SharedPtr wakeup_detail_publisher_;
+    rclcpp::Publisher<std_msgs::msg::String>::SharedPtr chat_partial_publisher_;
+    rclcpp::Publisher<robot_avvtn_msgs::msg::MotionCommand>::SharedPtr cmd_move_publisher_;
+    rclcpp::Publisher<robot_avvtn_msgs::msg::MotionCommand>::SharedPtr cmd_turn_publisher_;
+    rclcpp::Publisher<robot_avvtn_msgs::msg::MotionCommand>::SharedPtr cmd_action_publisher_;
+    rclcpp::Publisher<robot_avvtn_msgs::msg::MotionCommand>::SharedPtr cmd_stop_publisher_;
     
     bool initialized_ = false;
     std::thread ros_spin_thread_;
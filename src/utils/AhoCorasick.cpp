@@ -0,0 +1,86 @@
+#include "AhoCorasick.h"
+
+#include <algorithm>
+#include <queue>
+
+AhoCorasick::AhoCorasick() : nodes_(1)
+{
+}
+
+void AhoCorasick::add(const std::string &pattern, int id)
+{
+    if (pattern.empty())
+    {
+        return;
+    }
+
+    int node = 0;
+    for (unsigned char byte : pattern)
+    {
+        int next = child(node, byte);
+        if (next == 0)
+        {
+            next = (int)nodes_.size();
+            nodes_.push_back(Node());
+            std::vector<std::pair<unsigned char, int>> &edges = nodes_[node].next;
+            edges.insert(std::lower_bound(edges.begin(), edges.end(), std::make_pair(byte, 0)), std::make_pair(byte, next));
+        }
+        node = next;
+    }
+    if (nodes_[node].id < 0)
+    {
+        patterns_++;
+    }
+    nodes_[node].id = id;
+}
+
+void AhoCorasick::build()
+{
+    // 按层遍历，父节点的失配指针先于子节点确定
+    std::queue<int> queue;
+    for (const auto &edge : nodes_[0].next)
+    {
+        nodes_[edge.second].fail   = 0;
+        nodes_[edge.second].output = 0;
+        queue.push(edge.second);
+    }
+
+    while (!queue.empty())
+    {
+        int node = queue.front();
+        queue.pop();
+        for (const auto &edge : nodes_[node].next)
+        {
+            int fail = nodes_[node].fail;
+            while (fail != 0 && child(fail, edge.first) == 0)
+            {
+                fail = nodes_[fail].fail;
+            }
+            int target = child(fail, edge.first);
+            Node &next = nodes_[edge.second];
+            next.fail   = target != edge.second ? target : 0;
+            next.output = nodes_[next.fail].id >= 0 ? next.fail : nodes_[next.fail].output;
+            queue.push(edge.second);
+        }
+    }
+}
+
+int AhoCorasick::child(int node, unsigned char byte) const
+{
+    const std::vector<std::pair<unsigned char, int>> &edges = nodes_[node].next;
+    auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(byte, 0));
+    return it != edges.end() && it->first == byte ? it->second : 0;
+}
+
+int AhoCorasick::step(int state, unsigned char byte) const
+{
+    while (true)
+    {
+        int next = child(state, byte);
+        if (next != 0 || state == 0)
+        {
+            return next;
+        }
+        state = nodes_[state].fail;
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file AhoCorasick.h
+ * @brief 多模式串匹配自动机，按字节匹配，UTF-8文本可直接使用
+ * @details 先add()全部模式串再build()，之后只读，可在多个线程中同时scan()。
+ *          扫描状态由调用方保存，文本分多次到达时接着上次的状态扫描即可。
+ */
+#ifndef ROBOT_AHO_CORASICK_H
+#define ROBOT_AHO_CORASICK_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+class AhoCorasick
+{
+public:
+    AhoCorasick();
+
+    /**
+     * @brief 添加模式串，build()之前调用
+     * @param pattern 模式串，空串忽略
+     * @param id 命中时回报的编号
+     */
+    void add(const std::string &pattern, int id);
+
+    /**
+     * @brief 建失配指针，之后不能再add()
+     */
+    void build();
+
+    bool empty() const { return patterns_ == 0; }
+
+    /**
+     * @brief 从state开始扫描一段文本
+     * @param on_match 每次命中调用on_match(id, end)，end为命中结束位置在本段中的偏移；返回false停止扫描
+     * @return 扫描结束后的状态，下一段文本从这里接着扫
+     */
+    template <typename F>
+    int scan(int state, const char *data, size_t len, F on_match) const
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            state = step(state, (unsigned char)data[i]);
+            for (int node = nodes_[state].id >= 0 ? state : nodes_[state].output; node > 0; node = nodes_[node].output)
+            {
+                if (!on_match(nodes_[node].id, i + 1))
+                {
+                    return state;
+                }
+            }
+        }
+        return state;
+    }
+
+private:
+    struct Node
+    {
+        std::vector<std::pair<unsigned char, int>> next;    // 按字节升序
+        int fail   = 0;
+        int output = 0;     // 沿失配链最近的一个带编号的节点，0为没有
+        int id     = -1;    // 在此结束的模式串编号
+    };
+
+    int child(int node, unsigned char byte) const;
+    int step(int state, unsigned char byte) const;
+
+    std::vector<Node> nodes_;
+    int patterns_ = 0;
+};
+
+#endif    // ROBOT_AHO_CORASICK_H
@@ -0,0 +1,355 @@
+#include "AppConfig.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "utils/JsonDocument.h"
+#include "utils/Logger.hpp"
+
+namespace
+{
+
+void readBool(const JsonNode &node, const char *key, bool &value)
+{
+    const JsonNode &item = node[key];
+    if (item.isBool() || item.isNumber())
+    {
+        value = item.asBool(value);
+    }
+}
+
+void readInt(const JsonNode &node, const char *key, int &value)
+{
+    const JsonNode &item = node[key];
+    if (item.isNumber())
+    {
+        value = item.asInt(value);
+    }
+}
+
+void readString(const JsonNode &node, const char *key, std::string &value)
+{
+    const JsonNode &item = node[key];
+    if (item.isString())
+    {
+        value = item.asString();
+    }
+}
+
+void readStringArray(const JsonNode &node, const char *key, std::vector<std::string> &value)
+{
+    const JsonNode &item = node[key];
+    if (!item.isArray())
+    {
+        return;
+    }
+
+    value.clear();
+    for (const JsonNode &element : item)
+    {
+        if (element.isString() && element.length() > 0)
+        {
+            value.push_back(element.asString());
+        }
+    }
+}
+
+void readIntArray(const JsonNode &node, const char *key, std::vector<int> &value)
+{
+    const JsonNode &item = node[key];
+    if (!item.isArray())
+    {
+        return;
+    }
+
+    value.clear();
+    for (const JsonNode &element : item)
+    {
+        if (element.isNumber())
+        {
+            value.push_back(element.asInt());
+        }
+    }
+}
+
+AppConfig::SkillRoute makeRoute(const char *type, const char *handler, const char *log)
+{
+    AppConfig::SkillRoute route;
+    route.type    = type;
+    route.handler = handler;
+    route.log     = log;
+    return route;
+}
+
+}    // namespace
+
+AppConfig::AppConfig()
+{
+    // 内置路由表，与robot.cfg的skills.routes格式相同
+    SkillRoute datetime;
+    datetime.category = "IFLYTEK.datetimePro";    // 官方时间技能
+    datetime.handler  = "ignore";
+    skills.routes.push_back(datetime);
+
+    skills.routes.push_back(makeRoute("face_rec_start", "log", "执行调用人脸识别服务意图!!!"));
+
+    SkillRoute move = makeRoute("move", "motion", "执行移动意图!!!");
+    move.command    = "move";
+    move.distance   = "/slots/distance/normValue";
+    move.unit       = "/slots/move_unit/normValue";
+    skills.routes.push_back(move);
+
+    SkillRoute turn = makeRoute("turn", "motion", "执行转向意图!!!");
+    turn.command    = "turn";
+    turn.distance   = "/slots/distance/normValue";
+    turn.unit       = "/slots/turn_unit/normValue";
+    skills.routes.push_back(turn);
+
+    SkillRoute action = makeRoute("action", "motion", "执行动作意图!!!");
+    action.command    = "action";
+    skills.routes.push_back(action);
+
+    skills.routes.push_back(makeRoute("stop", "stop", "执行停止意图!!!"));
+    skills.routes.push_back(makeRoute("shut_up", "shut_up", "执行停止语音交互意图!!!"));
+    skills.routes.push_back(makeRoute("vip", "log", "执行 VIP 场景意图!!!"));
+
+    SkillRoute new_year = makeRoute("new_year", "motion", "执行新年动作意图!!!");
+    new_year.command    = "action";
+    new_year.random_ids = { 2003, 2014, 2016, 3052, 3053, 3012 };
+    skills.routes.push_back(new_year);
+}
+
+AppConfig &AppConfig::getInstance()
+{
+    static AppConfig instance;
+    return instance;
+}
+
+bool AppConfig::load(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        LOG_WARN("未找到配置文件%s，使用默认配置", path.c_str());
+        return false;
+    }
+
+    std::stringstream content;
+    content << file.rdbuf();
+
+    JsonDocument doc;
+    if (!doc.Parse(content.str()))
+    {
+        LOG_ERROR("配置文件%s解析失败: %s, offset = %zu", path.c_str(), doc.ErrorMessage(), doc.ErrorOffset());
+        return false;
+    }
+
+    loadTts(doc["tts"]);
+    loadTtsCache(doc["tts_cache"]);
+    loadBargeIn(doc["barge_in"]);
+    loadUplinkGate(doc["uplink_gate"]);
+    loadEndpointer(doc["endpointer"]);
+    loadPartialTranscript(doc["partial_transcript"]);
+    loadEarlyCommand(doc["early_command"]);
+    loadPlayer(doc["player"]);
+    loadRobotCommand(doc["robot_command"]);
+    loadLog(doc["log"]);
+    loadRosLog(doc["ros_log"]);
+    loadSkills(doc["skills"]);
+
+    LOG_INFO("加载配置文件: %s", path.c_str());
+    return true;
+}
+
+void AppConfig::loadTts(const JsonNode &node)
+{
+    readBool(node, "adaptive_segment", tts.adaptive_segment);
+    readInt(node, "first_segment_min_chars", tts.first_segment_min_chars);
+    readInt(node, "segment_min_chars", tts.segment_min_chars);
+    readInt(node, "segment_max_chars", tts.segment_max_chars);
+    readInt(node, "max_inflight_segments", tts.max_inflight_segments);
+
+    std::string mode = tts.client_stream ? "client_stream" : "post_semantic";
+    readString(node, "mode", mode);
+    if (mode != "client_stream" && mode != "post_semantic")
+    {
+        LOG_WARN("未知的合成方式tts.mode = %s，使用post_semantic", mode.c_str());
+    }
+    tts.client_stream = mode == "client_stream";
+
+    LOG_INFO("流式合成分段: adaptive = %d, first = %d, min = %d, max = %d",
+             tts.adaptive_segment, tts.first_segment_min_chars, tts.segment_min_chars, tts.segment_max_chars);
+    LOG_INFO("合成方式: %s, 同时合成段数 = %d", tts.client_stream ? "client_stream" : "post_semantic", tts.max_inflight_segments);
+}
+
+void AppConfig::loadTtsCache(const JsonNode &node)
+{
+    readBool(node, "enable", tts_cache.enable);
+    readString(node, "dir", tts_cache.dir);
+    readInt(node, "memory_entries", tts_cache.memory_entries);
+    readInt(node, "disk_max_mb", tts_cache.disk_max_mb);
+    readStringArray(node, "prewarm", tts_cache.prewarm);
+
+    LOG_INFO("合成缓存: enable = %d, dir = %s, memory = %d, disk = %d MB, prewarm = %zu",
+             tts_cache.enable, tts_cache.dir.c_str(), tts_cache.memory_entries, tts_cache.disk_max_mb, tts_cache.prewarm.size());
+}
+
+void AppConfig::loadBargeIn(const JsonNode &node)
+{
+    readBool(node, "enable", barge_in.enable);
+    readInt(node, "debounce_ms", barge_in.debounce_ms);
+
+    LOG_INFO("打断: enable = %d, debounce = %d ms", barge_in.enable, barge_in.debounce_ms);
+}
+
+void AppConfig::loadUplinkGate(const JsonNode &node)
+{
+    readBool(node, "enable", uplink_gate.enable);
+    readInt(node, "energy_threshold", uplink_gate.energy_threshold);
+    readInt(node, "open_frames", uplink_gate.open_frames);
+    readInt(node, "buffer_ms", uplink_gate.buffer_ms);
+    readInt(node, "hangover_ms", uplink_gate.hangover_ms);
+    readInt(node, "open_timeout_ms", uplink_gate.open_timeout_ms);
+
+    LOG_INFO("上行门控: enable = %d, 能量阈值 = %d, 连续帧 = %d, 缓存 = %d ms, 拖尾 = %d ms, 放行超时 = %d ms", uplink_gate.enable,
+             uplink_gate.energy_threshold, uplink_gate.open_frames, uplink_gate.buffer_ms, uplink_gate.hangover_ms, uplink_gate.open_timeout_ms);
+}
+
+void AppConfig::loadEndpointer(const JsonNode &node)
+{
+    readBool(node, "enable", endpointer.enable);
+    readInt(node, "silence_rms", endpointer.silence_rms);
+    readInt(node, "min_speech_ms", endpointer.min_speech_ms);
+    readInt(node, "final_silence_ms", endpointer.final_silence_ms);
+    readInt(node, "stable_silence_ms", endpointer.stable_silence_ms);
+    readInt(node, "stable_ms", endpointer.stable_ms);
+    readStringArray(node, "final_suffixes", endpointer.final_suffixes);
+    readStringArray(node, "continuation_suffixes", endpointer.continuation_suffixes);
+
+    LOG_INFO("端点检测: enable = %d, 静音阈值 = %d, 最短语音 = %d ms, 句末尾静音 = %d ms, 稳定尾静音 = %d ms, 稳定判定 = %d ms",
+             endpointer.enable, endpointer.silence_rms, endpointer.min_speech_ms, endpointer.final_silence_ms, endpointer.stable_silence_ms,
+             endpointer.stable_ms);
+}
+
+void AppConfig::loadPartialTranscript(const JsonNode &node)
+{
+    readBool(node, "enable", partial_transcript.enable);
+    readInt(node, "min_interval_ms", partial_transcript.min_interval_ms);
+
+    LOG_INFO("识别中间结果发布: enable = %d, 最小间隔 = %d ms", partial_transcript.enable, partial_transcript.min_interval_ms);
+}
+
+void AppConfig::loadEarlyCommand(const JsonNode &node)
+{
+    readBool(node, "enable", early_command.enable);
+    readInt(node, "unstable_confirm", early_command.unstable_confirm);
+    readStringArray(node, "stop_phrases", early_command.stop_phrases);
+    readStringArray(node, "shut_up_phrases", early_command.shut_up_phrases);
+
+    LOG_INFO("提前指令检出: enable = %d, 尾部确认 = %d 条, 停止短语 %zu 个, 闭嘴短语 %zu 个", early_command.enable,
+             early_command.unstable_confirm, early_command.stop_phrases.size(), early_command.shut_up_phrases.size());
+}
+
+void AppConfig::loadPlayer(const JsonNode &node)
+{
+    readString(node, "backend", player.backend);
+    readString(node, "device", player.device);
+    readInt(node, "period_ms", player.period_ms);
+    readInt(node, "periods", player.periods);
+    readInt(node, "ring_seconds", player.ring_seconds);
+
+    LOG_INFO("播放后端: %s, 设备 = %s, 周期 = %d ms x %d, 环形缓冲 = %d 秒", player.backend.c_str(), player.device.c_str(), player.period_ms,
+             player.periods, player.ring_seconds);
+}
+
+void AppConfig::loadRobotCommand(const JsonNode &node)
+{
+    readString(node, "base_url", robot_command.base_url);
+    readInt(node, "deadline_ms", robot_command.deadline_ms);
+    readInt(node, "stop_deadline_ms", robot_command.stop_deadline_ms);
+    readInt(node, "connect_timeout_ms", robot_command.connect_timeout_ms);
+    readInt(node, "max_connections", robot_command.max_connections);
+    readInt(node, "breaker_failures", robot_command.breaker_failures);
+    readInt(node, "breaker_open_ms", robot_command.breaker_open_ms);
+    readBool(node, "merge_motion", robot_command.merge_motion);
+    readBool(node, "ros_intra_process", robot_command.ros_intra_process);
+
+    std::string transport = robot_command.via_ros ? (robot_command.via_http ? "both" : "ros") : "http";
+    readString(node, "transport", transport);
+    if (transport != "http" && transport != "ros" && transport != "both")
+    {
+        LOG_WARN("未知的指令发送方式robot_command.transport = %s，使用http", transport.c_str());
+        transport = "http";
+    }
+    robot_command.via_http = transport != "ros";
+    robot_command.via_ros  = transport != "http";
+
+    LOG_INFO("运动控制指令: %s, 截止时间 = %d ms, 停止截止时间 = %d ms, 连接超时 = %d ms, 连接数 = %d, 熔断 = %d 次 / %d ms, 合并 = %d",
+             robot_command.base_url.c_str(), robot_command.deadline_ms, robot_command.stop_deadline_ms, robot_command.connect_timeout_ms,
+             robot_command.max_connections, robot_command.breaker_failures, robot_command.breaker_open_ms, robot_command.merge_motion);
+    LOG_INFO("运动控制指令发送方式: http = %d, ros = %d, 进程内通信 = %d", robot_command.via_http, robot_command.via_ros,
+             robot_command.ros_intra_process);
+}
+
+void AppConfig::loadLog(const JsonNode &node)
+{
+    readString(node, "overflow", log.overflow);
+    if (log.overflow != "block" && log.overflow != "drop" && log.overflow != "drop_low")
+    {
+        LOG_WARN("未知的日志队列溢出策略log.overflow = %s，使用drop_low", log.overflow.c_str());
+        log.overflow = "drop_low";
+    }
+
+    readString(node, "output", log.output);
+    if (log.output != "both" && log.output != "file" && log.output != "console")
+    {
+        LOG_WARN("未知的日志输出log.output = %s，使用both", log.output.c_str());
+        log.output = "both";
+    }
+    readInt(node, "file_buffer_kb", log.file_buffer_kb);
+    readString(node, "flush_level", log.flush_level);
+    readInt(node, "flush_interval_ms", log.flush_interval_ms);
+
+    LOG_INFO("日志: 队列满时 = %s, 输出 = %s, 文件缓冲 = %d KB, 立即写盘级别 = %s, 写盘间隔 = %d ms", log.overflow.c_str(),
+             log.output.c_str(), log.file_buffer_kb, log.flush_level.c_str(), log.flush_interval_ms);
+}
+
+void AppConfig::loadRosLog(const JsonNode &node)
+{
+    readBool(node, "enable", ros_log.enable);
+    readString(node, "min_level", ros_log.min_level);
+    readInt(node, "max_lines_per_sec", ros_log.max_lines_per_sec);
+    readInt(node, "batch_ms", ros_log.batch_ms);
+    readInt(node, "queue_size", ros_log.queue_size);
+
+    LOG_INFO("ROS日志发布: enable = %d, 最低级别 = %s, 每秒上限 = %d 行, 间隔 = %d ms, 队列 = %d 行", ros_log.enable,
+             ros_log.min_level.c_str(), ros_log.max_lines_per_sec, ros_log.batch_ms, ros_log.queue_size);
+}
+
+void AppConfig::loadSkills(const JsonNode &node)
+{
+    const JsonNode &routes = node["routes"];
+    if (!routes.isArray())
+    {
+        LOG_INFO("技能路由: 使用内置路由表, %zu 条", skills.routes.size());
+        return;
+    }
+
+    skills.routes.clear();
+    for (const JsonNode &item : routes)
+    {
+        SkillRoute route;
+        readString(item, "category", route.category);
+        readString(item, "type", route.type);
+        readString(item, "handler", route.handler);
+        readString(item, "command", route.command);
+        readString(item, "log", route.log);
+        readString(item, "intent_name", route.intent_name);
+        readString(item, "id", route.id);
+        readString(item, "distance", route.distance);
+        readString(item, "unit", route.unit);
+        readIntArray(item, "random_ids", route.random_ids);
+        skills.routes.push_back(route);
+    }
+    LOG_INFO("技能路由: %zu 条", skills.routes.size());
+}
@@ -0,0 +1,245 @@
+/**
+ * @file AppConfig.h
+ * @brief 本程序自身的调优配置（robot.cfg）
+ * @details avvtn.cfg和aiui.cfg交给引擎和SDK读取，本程序的参数单独放在robot.cfg中。
+ *          启动时在main中加载一次，之后只读；文件或字段缺失时使用下面的默认值。
+ */
+#ifndef ROBOT_APP_CONFIG_H
+#define ROBOT_APP_CONFIG_H
+
+#include <string>
+#include <vector>
+
+class JsonNode;
+
+class AppConfig
+{
+public:
+    /**
+     * @brief 流式语义合成的分段参数
+     */
+    struct TtsConfig
+    {
+        bool adaptive_segment       = true;    // 是否按实测的合成/播放速度自适应分段
+        int first_segment_min_chars = 4;       // 首段最少字数，之后遇到第一个分句符就送合成
+        int segment_min_chars       = 20;      // 不自适应或还没有测速数据时的分段字数
+        int segment_max_chars       = 120;     // 自适应分段的上限
+
+        // 合成方式："post_semantic"由AIUI平台做语义后合成（应用配置页打开"语音合成"开关时），
+        // "client_stream"由本程序把流式语义结果分段送合成
+        bool client_stream        = false;
+        int max_inflight_segments = 3;    // client_stream时同时在合成的段数，1即逐段串行
+    };
+
+    /**
+     * @brief 固定话术的合成音频缓存
+     */
+    struct TtsCacheConfig
+    {
+        bool enable        = true;
+        std::string dir    = "/home/cat/robot_avvtn/tts_cache";
+        int memory_entries = 64;    // 内存LRU条目数
+        int disk_max_mb    = 64;    // 磁盘记录文件上限
+        std::vector<std::string> prewarm{ "你好" };    // 启动后预先合成的话术
+    };
+
+    /**
+     * @brief 用户开口打断机器人说话
+     */
+    struct BargeInConfig
+    {
+        bool enable     = true;
+        int debounce_ms = 800;    // 引擎VAD和AIUI BOS对同一次开口都会触发，这段时间内只打断一次
+    };
+
+    /**
+     * @brief 机器人说话时的上行音频门控
+     */
+    struct UplinkGateConfig
+    {
+        bool enable          = false;
+        int energy_threshold = 1500;    // 单帧RMS超过它算用户在大声说话
+        int open_frames      = 3;       // 连续这么多帧超过能量阈值才放行，单帧尖峰多半是回声
+        int buffer_ms        = 1500;    // 门控期间保留的最近音频，放行时先补发
+        int hangover_ms      = 300;     // 播放停止后继续门控的时长，盖住回声拖尾
+        int open_timeout_ms  = 1500;    // 能量放行后这么久引擎VAD仍未检测到说话，按误放行收回
+    };
+
+    /**
+     * @brief 语义端点检测，一句话明显说完时提前结束识别音频上送
+     */
+    struct EndpointerConfig
+    {
+        bool enable           = false;
+        int silence_rms       = 300;    // 单帧RMS低于它算静音
+        int min_speech_ms     = 300;    // 有声音的时长不到这么久的不提前结束
+        int final_silence_ms  = 200;    // 以语气词或句末标点结尾时，尾静音达到这么久结束
+        int stable_silence_ms = 350;    // 识别文本已稳定时，尾静音达到这么久结束
+        int stable_ms         = 300;    // 文本这么久没变也算稳定
+        std::vector<std::string> final_suffixes{ "吗", "呢", "吧", "啊", "呀", "了", "。", "？", "！", "?", "!" };
+        std::vector<std::string> continuation_suffixes{ "然后", "还有", "和", "跟", "就是", "那个", "嗯", "呃", "因为", "所以", "但是", "如果", "或者", "，", "," };
+    };
+
+    /**
+     * @brief 识别中间结果的实时发布
+     */
+    struct PartialTranscriptConfig
+    {
+        bool enable         = true;
+        int min_interval_ms = 150;    // 两条消息的最小间隔，期间的中间结果只发最新的
+    };
+
+    /**
+     * @brief 在识别中间结果上提前检出停止类指令
+     */
+    struct EarlyCommandConfig
+    {
+        bool enable          = true;
+        int unstable_confirm = 2;    // 尚未稳定的文本中命中的短语要连续出现在这么多条中间结果中，0为只看稳定前缀
+        std::vector<std::string> stop_phrases{ "停下", "停止", "别动", "站住", "不要动" };    // 停止运动
+        std::vector<std::string> shut_up_phrases{ "闭嘴", "别说了", "不要说了" };            // 停止说话
+    };
+
+    /**
+     * @brief 播放后端
+     */
+    struct PlayerConfig
+    {
+        std::string backend = "aiui";       // "aiui"用SDK内置播放器，"alsa"用本程序的ALSA播放器
+        std::string device  = "default";    // alsa时的设备名
+        int period_ms       = 20;           // alsa周期时长
+        int periods         = 3;            // alsa设备缓冲的周期数
+        int ring_seconds    = 120;          // alsa环形缓冲能存的音频时长
+    };
+
+    /**
+     * @brief 运动控制器的HTTP指令接口
+     */
+    struct RobotCommandConfig
+    {
+        std::string base_url   = "http://192.168.123.164:8848";
+        int deadline_ms        = 3000;    // 移动、转向、动作指令的截止时间，含排队
+        int stop_deadline_ms   = 1000;    // 停止指令的截止时间
+        int connect_timeout_ms = 500;
+        int max_connections    = 4;       // 与控制器保持的长连接数上限
+        int breaker_failures   = 3;       // 连续失败这么多次熔断
+        int breaker_open_ms    = 5000;    // 熔断时长，之后放行一个探测请求
+        bool merge_motion      = true;    // 排队中相邻的同类移动、转向合并成一条
+
+        // 发送方式："http"只走HTTP接口，"ros"只发布robot_avvtn_cmd_*话题，"both"两者都发，应答以HTTP为准
+        bool via_http          = true;
+        bool via_ros           = false;
+        bool ros_intra_process = false;    // ROS节点开启进程内通信，同进程的控制器收指令不经过DDS
+    };
+
+    /**
+     * @brief 日志系统
+     */
+    struct LogConfig
+    {
+        // 异步日志队列满时："block"等待，"drop"丢弃，"drop_low"WARN以下丢弃、WARN及以上等待
+        std::string overflow = "drop_low";
+        // 日志写到哪里："both"控制台和app.log，"file"只写app.log，"console"只写控制台；
+        // bin/start.sh把控制台重定向到program.log，部署时用"file"避免同一行日志写两份
+        std::string output      = "both";
+        int file_buffer_kb      = 64;        // app.log的写缓冲，0为逐行写盘
+        std::string flush_level = "WARN";    // 该级别及以上的日志立即写盘
+        int flush_interval_ms   = 1000;      // 持续写日志时最长多久写盘一次，日志停下时立即写盘
+    };
+
+    /**
+     * @brief 日志发布到ROS话题robot_avvtn_log
+     */
+    struct RosLogConfig
+    {
+        bool enable           = true;
+        std::string min_level = "INFO";    // 低于该级别的日志不发布：TRACE/DEBUG/INFO/WARN/ERROR/FATAL
+        int max_lines_per_sec = 50;        // 每秒最多发布的行数，超出的丢弃并计数，<=0不限
+        int batch_ms          = 200;       // 多行合成一条消息的发布间隔
+        int queue_size        = 1024;      // 待发布的行数上限，满了丢弃并计数
+    };
+
+    /**
+     * @brief 一条技能路由：按category或type匹配技能结果，交给对应的处理方式
+     * @details 路径为相对技能结果（data.result[0]）的JSON Pointer，加载时编译一次
+     */
+    struct SkillRoute
+    {
+        std::string category;    // 匹配技能的category，与type二选一
+        std::string type;        // 匹配data.result[0].type
+        std::string handler = "log";    // "ignore"整条结果不处理，"log"只记日志，"motion"发运动指令，"stop"，"shut_up"
+        std::string command;     // motion时的指令：move/turn/action
+        std::string log;         // 命中时的日志
+        std::string intent_name = "/intentName";
+        std::string id          = "/id";
+        std::string distance;    // move/turn的距离
+        std::string unit;        // move/turn的单位
+        std::vector<int> random_ids;    // 非空时不取id，从中随机选一个
+    };
+
+    /**
+     * @brief 技能路由表，新技能只要能归到已有的处理方式，加配置即可，不用重新编译
+     */
+    struct SkillsConfig
+    {
+        std::vector<SkillRoute> routes;    // 缺省为内置的路由表
+    };
+
+    static AppConfig &getInstance();
+
+    /**
+     * @brief 加载配置文件
+     * @param path robot.cfg路径
+     * @return 成功返回true；失败时保留默认值
+     */
+    bool load(const std::string &path);
+
+    TtsConfig tts;
+
+    TtsCacheConfig tts_cache;
+
+    BargeInConfig barge_in;
+    UplinkGateConfig uplink_gate;
+    EndpointerConfig endpointer;
+
+    PartialTranscriptConfig partial_transcript;
+    EarlyCommandConfig early_command;
+
+    PlayerConfig player;
+
+    RobotCommandConfig robot_command;
+
+    LogConfig log;
+    RosLogConfig ros_log;
+
+    SkillsConfig skills;
+
+private:
+    AppConfig();
+
+    void loadTts(const JsonNode &node);
+
+    void loadTtsCache(const JsonNode &node);
+
+    void loadBargeIn(const JsonNode &node);
+
+    void loadUplinkGate(const JsonNode &node);
+
+    void loadEndpointer(const JsonNode &node);
+
+    void loadPartialTranscript(const JsonNode &node);
+
+    void loadEarlyCommand(const JsonNode &node);
+
+    void loadPlayer(const JsonNode &node);
+
+    void loadRobotCommand(const JsonNode &node);
+
+    void loadLog(const JsonNode &node);
+
+    void loadRosLog(const JsonNode &node);
+
+    void loadSkills(const JsonNode &node);
+};
+
+#endif    // ROBOT_APP_CONFIG_H
@@ -5,48 +5,129 @@
 #include "IatResultUtil.h"
 #include "ConvertUtil.h"
 
-std::map<int, std::string> IatResultUtil::sPgsResult;
+#include <algorithm>
+#include <cstring>
 
-std::string IatResultUtil::parsePgsIatText(const Json::Value& textJson)
+void IatResultUtil::appendIatResult(const Json::Value& textJson, std::string& out)
 {
-    int sn = textJson["sn"].asInt();
-    std::string pgs = textJson["pgs"].asString();
-    Json::Value rgArray = textJson["rg"];
-    bool ls = textJson["ls"].asBool();
-
-    if ("rpl" == pgs) {
-        int begin = rgArray[0].asInt();
-        int end = rgArray[1].asInt();
-        for (int i = begin; i <= end; i++) {
-            sPgsResult.erase(i);
+    const Json::Value& wordsArray = textJson["ws"];
+    for (Json::ArrayIndex i = 0; i < wordsArray.size(); i++) {
+        // 转写结果词，默认使用第一个结果
+        const Json::Value& w = (wordsArray[i])["cw"][0]["w"];
+        if (w.isString()) {
+            out.append(w.asCString());
         }
     }
+}
 
-    sPgsResult[sn] = parseIatResult(textJson);
+std::string IatResultUtil::parseIatResult(const Json::Value& textJson)
+{
+    std::string ret;
+    appendIatResult(textJson, ret);
+    return ret;
+}
 
-    std::string builder;
-    for (auto& it : sPgsResult) {
-        builder.append(it.second);
+void IatPgsAssembler::reset()
+{
+    segments_.clear();
+    text_.clear();
+    stable_sn_       = 0;
+    stable_len_      = 0;
+    finished_        = false;
+    stable_rewrites_ = 0;
+}
+
+bool IatPgsAssembler::apply(const Json::Value& textJson)
+{
+    int sn = textJson["sn"].asInt();
+    const Json::Value& pgsJson = textJson["pgs"];
+    bool wpgs = pgsJson.isString();
+    bool replace = wpgs && strcmp(pgsJson.asCString(), "rpl") == 0;
+
+    // 本条结果替换sn在[low, high]内的段；apd时只会顶替同sn的重复结果
+    int low = sn;
+    int high = sn;
+    if (replace) {
+        const Json::Value& rgArray = textJson["rg"];
+        low = rgArray[0].asInt();
+        high = rgArray[1].asInt();
+    }
+    if (wpgs && low < stable_sn_) {
+        stable_rewrites_++;
+        stable_sn_ = low;
     }
 
-    if (ls) {
-        sPgsResult.clear();
+    auto first = std::lower_bound(segments_.begin(), segments_.end(), low,
+                                  [](const Segment& segment, int value) { return segment.sn < value; });
+    size_t index = first - segments_.begin();
+
+    // 替换范围之后已有的段先取出来，追加新段后再按sn顺序放回；正常的wpgs结果这里为空
+    std::vector<std::pair<int, std::string>> kept;
+    for (size_t i = index; i < segments_.size(); i++) {
+        size_t end = i + 1 < segments_.size() ? segments_[i + 1].offset : text_.size();
+        if (segments_[i].sn > high && segments_[i].sn != sn) {
+            kept.emplace_back(segments_[i].sn, text_.substr(segments_[i].offset, end - segments_[i].offset));
+        }
+    }
+    if (index < segments_.size()) {
+        text_.resize(segments_[index].offset);
+        segments_.resize(index);
     }
 
-    return builder;
+    bool inserted = false;
+    for (auto& segment : kept) {
+        if (!inserted && sn < segment.first) {
+            segments_.push_back({sn, text_.size()});
+            IatResultUtil::appendIatResult(textJson, text_);
+            inserted = true;
+        }
+        segments_.push_back({segment.first, text_.size()});
+        text_.append(segment.second);
+    }
+    if (!inserted) {
+        segments_.push_back({sn, text_.size()});
+        IatResultUtil::appendIatResult(textJson, text_);
+    }
+
+    // 非wpgs结果每条都是最终结果；apd之前的段不会再被修正
+    if (!wpgs) {
+        stable_sn_ = sn + 1;
+    } else if (!replace) {
+        stable_sn_ = (std::max)(stable_sn_, sn);
+    }
+
+    finished_ = textJson["ls"].asBool();
+    if (finished_) {
+        stable_len_ = text_.size();
+    } else {
+        auto boundary = std::lower_bound(segments_.begin(), segments_.end(), stable_sn_,
+                                         [](const Segment& segment, int value) { return segment.sn < value; });
+        stable_len_ = boundary == segments_.end() ? text_.size() : boundary->offset;
+    }
+    return finished_;
 }
 
-std::string IatResultUtil::parseIatResult(const Json::Value& textJson)
+IatPgsAssembler& IatSessions::get(const std::string& sid)
 {
-    std::string ret;
-    Json::Value wordsArray = textJson["ws"];
-    for (int i = 0; i < wordsArray.size(); i++) {
-        // 转写结果词，默认使用第一个结果
-        Json::Value defVal;
-        Json::Value itemsArray = (wordsArray[i])["cw"];
-        std::string w = (itemsArray[0])["w"].asString();
-        ret.append(w);
+    for (auto& session : sessions_) {
+        if (session.first == sid) {
+            return session.second;
+        }
     }
 
-    return ret;
-}
\ No newline at end of file
+    if (sessions_.size() >= kMaxSessions) {
+        sessions_.erase(sessions_.begin());
+    }
+    sessions_.emplace_back(sid, IatPgsAssembler());
+    return sessions_.back().second;
+}
+
+void IatSessions::release(const std::string& sid)
+{
+    for (auto it = sessions_.begin(); it != sessions_.end(); ++it) {
+        if (it->first == sid) {
+            sessions_.erase(it);
+            return;
+        }
+    }
+}
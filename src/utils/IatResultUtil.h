@@ -8,21 +8,92 @@
 #include "json/json.h"
 
 #include <string>
-#include <map>
+#include <utility>
+#include <vector>
 
 using namespace aiui_va;
 
 class IatResultUtil
 {
+public:
+    /**
+     * 把一条识别结果的词拼接到out后面，不复制JSON节点。
+     */
+    static void appendIatResult(const Json::Value& textJson, std::string& out);
+
+    static std::string parseIatResult(const Json::Value& textJson);
+};
+
+/**
+ * 一次识别会话(sid)的结果拼装。
+ *
+ * 每条结果按sn记为一段，文本连续存放，段只记起始偏移。wpgs的rpl只替换末尾几段，
+ * 此时截掉被替换的部分再追加新段即可，不重新拼接整句。
+ *
+ * 稳定前缀：最近一次apd的那段之前、且不在rpl替换范围内的文本视为不会再变，
+ * 之后的部分为可能被修正的尾巴；收到最后一条结果时整句都稳定。
+ * 这是按云端修正规律做的判断，修正落进稳定前缀时计数，稳定长度随之回退。
+ */
+class IatPgsAssembler
+{
+public:
+    void reset();
+
+    /**
+     * 应用一条识别结果（text字段），wpgs和非wpgs结果都可以。
+     * @return 是否是该次会话最后一条结果
+     */
+    bool apply(const Json::Value& textJson);
+
+    const std::string& text() const { return text_; }
+
+    /**
+     * 稳定前缀的字节数，总在UTF-8字符边界上。
+     */
+    size_t stableLength() const { return stable_len_; }
+
+    std::string stableText() const { return text_.substr(0, stable_len_); }
+
+    std::string unstableText() const { return text_.substr(stable_len_); }
+
+    bool isFinished() const { return finished_; }
+
+    /**
+     * rpl修正落进已判为稳定的前缀的次数。
+     */
+    int stableRewrites() const { return stable_rewrites_; }
+
 private:
-    static std::map<int, std::string> sPgsResult;
+    struct Segment
+    {
+        int sn;
+        size_t offset;
+    };
+
+    std::vector<Segment> segments_;    // 按sn升序
+    std::string text_;
+    int stable_sn_       = 0;          // sn小于它的段为稳定前缀
+    size_t stable_len_   = 0;
+    bool finished_       = false;
+    int stable_rewrites_ = 0;
+};
 
+/**
+ * 按sid保存进行中的识别会话。新会话开始后旧会话的最后几条结果仍可能到达，
+ * 所以同时保留最近几个会话，超过上限时丢掉最早的。
+ * 只在AIUI回调线程中使用，不加锁。
+ */
+class IatSessions
+{
 public:
-    static void clearPgsResult() { sPgsResult.clear(); }
+    IatPgsAssembler& get(const std::string& sid);
 
-    static std::string parsePgsIatText(const Json::Value& textJson);
+    void release(const std::string& sid);
 
-    static std::string parseIatResult(const Json::Value& textJson);
+private:
+    static const size_t kMaxSessions = 4;
+
+    std::vector<std::pair<std::string, IatPgsAssembler>> sessions_;    // 按创建先后
 };
 
 #endif    //AIUI_SDK_IATRESULTUTIL_H
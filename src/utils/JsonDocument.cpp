@@ -0,0 +1,740 @@
+#include "JsonDocument.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/*********************JsonNode************************/
+const JsonNode &JsonNode::Null()
+{
+    static const JsonNode null_node;
+    return null_node;
+}
+
+const JsonNode *JsonNode::find(const char *key, size_t key_len) const
+{
+    if (type_ != TYPE_OBJECT)
+    {
+        return nullptr;
+    }
+    for (const JsonNode *it = child_; it != nullptr; it = it->next_)
+    {
+        if (it->key_len_ == key_len && memcmp(it->key_, key, key_len) == 0)
+        {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+bool JsonNode::contains(const char *key) const
+{
+    return find(key, strlen(key)) != nullptr;
+}
+
+const JsonNode &JsonNode::operator[](const char *key) const
+{
+    const JsonNode *node = find(key, strlen(key));
+    return node ? *node : Null();
+}
+
+const JsonNode &JsonNode::operator[](const std::string &key) const
+{
+    const JsonNode *node = find(key.data(), key.size());
+    return node ? *node : Null();
+}
+
+const JsonNode &JsonNode::operator[](int index) const
+{
+    if (type_ != TYPE_ARRAY || index < 0 || (uint32_t)index >= size_)
+    {
+        return Null();
+    }
+    const JsonNode *it = child_;
+    while (index-- > 0)
+    {
+        it = it->next_;
+    }
+    return *it;
+}
+
+std::string JsonNode::asString(const std::string &def) const
+{
+    return type_ == TYPE_STRING ? std::string(str_, size_) : def;
+}
+
+int JsonNode::asInt(int def) const
+{
+    if (type_ != TYPE_NUMBER)
+    {
+        return def;
+    }
+    return integer_ ? (int)int_ : (int)num_;
+}
+
+int64_t JsonNode::asInt64(int64_t def) const
+{
+    if (type_ != TYPE_NUMBER)
+    {
+        return def;
+    }
+    return integer_ ? int_ : (int64_t)num_;
+}
+
+double JsonNode::asDouble(double def) const
+{
+    return type_ == TYPE_NUMBER ? num_ : def;
+}
+
+bool JsonNode::asBool(bool def) const
+{
+    return type_ == TYPE_BOOL ? bool_ : def;
+}
+
+bool JsonNode::equals(const char *text) const
+{
+    if (type_ != TYPE_STRING)
+    {
+        return false;
+    }
+    size_t len = strlen(text);
+    return len == size_ && memcmp(str_, text, len) == 0;
+}
+
+/*********************JsonDocument************************/
+JsonDocument::JsonDocument()
+{
+    blocks_.emplace_back(new JsonNode[kNodesPerBlock]);
+}
+
+void JsonDocument::Clear()
+{
+    block_index_  = 0;
+    block_used_   = 0;
+    node_count_   = 0;
+    root_         = nullptr;
+    error_        = "";
+    error_offset_ = 0;
+}
+
+JsonNode *JsonDocument::newNode()
+{
+    if (block_used_ == kNodesPerBlock)
+    {
+        block_index_++;
+        block_used_ = 0;
+        if (block_index_ == blocks_.size())
+        {
+            blocks_.emplace_back(new JsonNode[kNodesPerBlock]);
+        }
+    }
+    JsonNode *node = &blocks_[block_index_][block_used_++];
+    *node          = JsonNode();
+    node_count_++;
+    return node;
+}
+
+bool JsonDocument::fail(const char *message, const char *pos)
+{
+    error_        = message;
+    error_offset_ = pos - begin_;
+    root_         = nullptr;
+    return false;
+}
+
+bool JsonDocument::Parse(const char *data, size_t len)
+{
+    buffer_.assign(data, len);
+    return ParseInSitu(&buffer_[0], len);
+}
+
+bool JsonDocument::ParseInSitu(char *buffer, size_t len)
+{
+    Clear();
+    begin_ = buffer;
+    cur_   = buffer;
+    end_   = buffer + len;
+
+    JsonNode *root = newNode();
+    skipSpace();
+    if (!parseValue(root, 0))
+    {
+        return false;
+    }
+    skipSpace();
+    if (cur_ != end_ && *cur_ != '\0')
+    {
+        return fail("unexpected trailing characters", cur_);
+    }
+    root_ = root;
+    return true;
+}
+
+void JsonDocument::skipSpace()
+{
+    while (cur_ < end_ && (*cur_ == ' ' || *cur_ == '\n' || *cur_ == '\r' || *cur_ == '\t'))
+    {
+        cur_++;
+    }
+}
+
+bool JsonDocument::parseValue(JsonNode *node, int depth)
+{
+    if (cur_ >= end_)
+    {
+        return fail("unexpected end of input", cur_);
+    }
+    if (depth > kMaxDepth)
+    {
+        return fail("nesting too deep", cur_);
+    }
+    switch (*cur_)
+    {
+        case '{':
+            return parseObject(node, depth + 1);
+        case '[':
+            return parseArray(node, depth + 1);
+        case '"':
+            node->type_ = JsonNode::TYPE_STRING;
+            return parseString(&node->str_, &node->size_);
+        case 't':
+            node->type_ = JsonNode::TYPE_BOOL;
+            node->bool_ = true;
+            return parseLiteral("true", 4);
+        case 'f':
+            node->type_ = JsonNode::TYPE_BOOL;
+            node->bool_ = false;
+            return parseLiteral("false", 5);
+        case 'n':
+            node->type_ = JsonNode::TYPE_NULL;
+            return parseLiteral("null", 4);
+        default:
+            return parseNumber(node);
+    }
+}
+
+bool JsonDocument::parseLiteral(const char *literal, size_t len)
+{
+    if ((size_t)(end_ - cur_) < len || memcmp(cur_, literal, len) != 0)
+    {
+        return fail("invalid literal", cur_);
+    }
+    cur_ += len;
+    return true;
+}
+
+bool JsonDocument::parseObject(JsonNode *node, int depth)
+{
+    node->type_ = JsonNode::TYPE_OBJECT;
+    cur_++;    // '{'
+    skipSpace();
+    if (cur_ < end_ && *cur_ == '}')
+    {
+        cur_++;
+        return true;
+    }
+
+    JsonNode *tail = nullptr;
+    while (true)
+    {
+        skipSpace();
+        if (cur_ >= end_ || *cur_ != '"')
+        {
+            return fail("expected object key", cur_);
+        }
+        JsonNode *member = newNode();
+        if (!parseString(&member->key_, &member->key_len_))
+        {
+            return false;
+        }
+        skipSpace();
+        if (cur_ >= end_ || *cur_ != ':')
+        {
+            return fail("expected ':'", cur_);
+        }
+        cur_++;
+        skipSpace();
+        if (!parseValue(member, depth))
+        {
+            return false;
+        }
+
+        if (tail)
+        {
+            tail->next_ = member;
+        }
+        else
+        {
+            node->child_ = member;
+        }
+        tail = member;
+        node->size_++;
+
+        skipSpace();
+        if (cur_ >= end_)
+        {
+            return fail("unterminated object", cur_);
+        }
+        if (*cur_ == ',')
+        {
+            cur_++;
+            continue;
+        }
+        if (*cur_ == '}')
+        {
+            cur_++;
+            return true;
+        }
+        return fail("expected ',' or '}'", cur_);
+    }
+}
+
+bool JsonDocument::parseArray(JsonNode *node, int depth)
+{
+    node->type_ = JsonNode::TYPE_ARRAY;
+    cur_++;    // '['
+    skipSpace();
+    if (cur_ < end_ && *cur_ == ']')
+    {
+        cur_++;
+        return true;
+    }
+
+    JsonNode *tail = nullptr;
+    while (true)
+    {
+        skipSpace();
+        JsonNode *item = newNode();
+        if (!parseValue(item, depth))
+        {
+            return false;
+        }
+
+        if (tail)
+        {
+            tail->next_ = item;
+        }
+        else
+        {
+            node->child_ = item;
+        }
+        tail = item;
+        node->size_++;
+
+        skipSpace();
+        if (cur_ >= end_)
+        {
+            return fail("unterminated array", cur_);
+        }
+        if (*cur_ == ',')
+        {
+            cur_++;
+            continue;
+        }
+        if (*cur_ == ']')
+        {
+            cur_++;
+            return true;
+        }
+        return fail("expected ',' or ']'", cur_);
+    }
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool parseHex4(const char *p, unsigned *out)
+{
+    unsigned value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int h = hexValue(p[i]);
+        if (h < 0)
+        {
+            return false;
+        }
+        value = (value << 4) | (unsigned)h;
+    }
+    *out = value;
+    return true;
+}
+
+static char *writeUtf8(char *w, unsigned cp)
+{
+    if (cp < 0x80)
+    {
+        *w++ = (char)cp;
+    }
+    else if (cp < 0x800)
+    {
+        *w++ = (char)(0xC0 | (cp >> 6));
+        *w++ = (char)(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        *w++ = (char)(0xE0 | (cp >> 12));
+        *w++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *w++ = (char)(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        *w++ = (char)(0xF0 | (cp >> 18));
+        *w++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *w++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *w++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return w;
+}
+
+bool JsonDocument::parseString(const char **out, uint32_t *out_len)
+{
+    cur_++;    // 开头的'"'
+    char *start = cur_;
+
+    // 快速路径：没有转义字符时只需要找到结尾引号
+    while (cur_ < end_ && *cur_ != '"' && *cur_ != '\\')
+    {
+        cur_++;
+    }
+    if (cur_ >= end_)
+    {
+        return fail("unterminated string", start);
+    }
+
+    // 转义还原后的内容不会比原文长，直接写回原位置
+    char *w = cur_;
+    while (cur_ < end_ && *cur_ != '"')
+    {
+        if (*cur_ != '\\')
+        {
+            *w++ = *cur_++;
+            continue;
+        }
+        if (end_ - cur_ < 2)
+        {
+            return fail("unterminated escape", cur_);
+        }
+        char esc = cur_[1];
+        cur_ += 2;
+        switch (esc)
+        {
+            case '"': *w++ = '"'; break;
+            case '\\': *w++ = '\\'; break;
+            case '/': *w++ = '/'; break;
+            case 'b': *w++ = '\b'; break;
+            case 'f': *w++ = '\f'; break;
+            case 'n': *w++ = '\n'; break;
+            case 'r': *w++ = '\r'; break;
+            case 't': *w++ = '\t'; break;
+            case 'u':
+            {
+                unsigned cp = 0;
+                if (end_ - cur_ < 4 || !parseHex4(cur_, &cp))
+                {
+                    return fail("invalid \\u escape", cur_);
+                }
+                cur_ += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF)
+                {
+                    unsigned low = 0;
+                    if (end_ - cur_ >= 6 && cur_[0] == '\\' && cur_[1] == 'u' && parseHex4(cur_ + 2, &low) && low >= 0xDC00 && low <= 0xDFFF)
+                    {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        cur_ += 6;
+                    }
+                }
+                w = writeUtf8(w, cp);
+            }
+            break;
+            default:
+                return fail("invalid escape", cur_ - 1);
+        }
+    }
+    if (cur_ >= end_)
+    {
+        return fail("unterminated string", start);
+    }
+
+    *out     = start;
+    *out_len = (uint32_t)(w - start);
+    *w       = '\0';    // 结尾引号（或其之前的空位）改写成'\0'，方便直接当C字符串使用
+    cur_++;             // 结尾的'"'
+    return true;
+}
+
+bool JsonDocument::parseNumber(JsonNode *node)
+{
+    const char *start = cur_;
+    bool negative     = false;
+    if (cur_ < end_ && *cur_ == '-')
+    {
+        negative = true;
+        cur_++;
+    }
+    if (cur_ >= end_ || *cur_ < '0' || *cur_ > '9')
+    {
+        return fail("invalid value", start);
+    }
+
+    uint64_t mantissa = 0;
+    bool overflow     = false;
+    while (cur_ < end_ && *cur_ >= '0' && *cur_ <= '9')
+    {
+        unsigned digit = (unsigned)(*cur_ - '0');
+        if (mantissa > (UINT64_MAX - digit) / 10)
+        {
+            overflow = true;
+        }
+        mantissa = mantissa * 10 + digit;
+        cur_++;
+    }
+
+    bool is_integer = true;
+    if (cur_ < end_ && *cur_ == '.')
+    {
+        is_integer = false;
+        cur_++;
+        if (cur_ >= end_ || *cur_ < '0' || *cur_ > '9')
+        {
+            return fail("invalid number", start);
+        }
+        while (cur_ < end_ && *cur_ >= '0' && *cur_ <= '9')
+        {
+            cur_++;
+        }
+    }
+    if (cur_ < end_ && (*cur_ == 'e' || *cur_ == 'E'))
+    {
+        is_integer = false;
+        cur_++;
+        if (cur_ < end_ && (*cur_ == '+' || *cur_ == '-'))
+        {
+            cur_++;
+        }
+        if (cur_ >= end_ || *cur_ < '0' || *cur_ > '9')
+        {
+            return fail("invalid number", start);
+        }
+        while (cur_ < end_ && *cur_ >= '0' && *cur_ <= '9')
+        {
+            cur_++;
+        }
+    }
+
+    node->type_ = JsonNode::TYPE_NUMBER;
+    if (is_integer && !overflow && mantissa <= (uint64_t)INT64_MAX + (negative ? 1 : 0))
+    {
+        node->integer_ = true;
+        node->int_     = negative ? (int64_t)(0 - mantissa) : (int64_t)mantissa;
+        node->num_     = (double)node->int_;
+        return true;
+    }
+
+    // 小数、指数或者超出int64范围：拷到栈上交给strtod（缓冲区不保证以'\0'结尾）
+    char tmp[64];
+    size_t len = cur_ - start;
+    if (len >= sizeof(tmp))
+    {
+        return fail("number too long", start);
+    }
+    memcpy(tmp, start, len);
+    tmp[len]       = '\0';
+    node->num_     = strtod(tmp, nullptr);
+    node->int_     = (int64_t)node->num_;
+    node->integer_ = false;
+    return true;
+}
+
+/*********************JsonWriter************************/
+void JsonWriter::prefix()
+{
+    if (after_key_)
+    {
+        after_key_ = false;
+        return;
+    }
+    if (!has_item_.empty())
+    {
+        if (has_item_.back())
+        {
+            out_.push_back(',');
+        }
+        has_item_.back() = 1;
+    }
+}
+
+void JsonWriter::escape(const char *value, size_t len)
+{
+    static const char kHex[] = "0123456789abcdef";
+    out_.push_back('"');
+    const char *run = value;
+    const char *end = value + len;
+    for (const char *p = value; p < end; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        out_.append(run, p - run);
+        run = p + 1;
+        switch (c)
+        {
+            case '"': out_.append("\\\""); break;
+            case '\\': out_.append("\\\\"); break;
+            case '\b': out_.append("\\b"); break;
+            case '\f': out_.append("\\f"); break;
+            case '\n': out_.append("\\n"); break;
+            case '\r': out_.append("\\r"); break;
+            case '\t': out_.append("\\t"); break;
+            default:
+            {
+                char buf[6] = { '\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF] };
+                out_.append(buf, sizeof(buf));
+            }
+            break;
+        }
+    }
+    out_.append(run, end - run);
+    out_.push_back('"');
+}
+
+void JsonWriter::open(char bracket)
+{
+    prefix();
+    out_.push_back(bracket);
+    has_item_.push_back(0);
+}
+
+void JsonWriter::close(char bracket)
+{
+    // 多余的End*说明调用方嵌套不匹配，继续输出只会得到非法JSON
+    assert(!has_item_.empty());
+    if (!has_item_.empty())
+    {
+        has_item_.pop_back();
+    }
+    out_.push_back(bracket);
+}
+
+JsonWriter &JsonWriter::StartObject()
+{
+    open('{');
+    return *this;
+}
+
+JsonWriter &JsonWriter::EndObject()
+{
+    close('}');
+    return *this;
+}
+
+JsonWriter &JsonWriter::StartArray()
+{
+    open('[');
+    return *this;
+}
+
+JsonWriter &JsonWriter::EndArray()
+{
+    close(']');
+    return *this;
+}
+
+JsonWriter &JsonWriter::Key(const char *key, size_t len)
+{
+    prefix();
+    escape(key, len);
+    out_.push_back(':');
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::Key(const char *key)
+{
+    return Key(key, strlen(key));
+}
+
+JsonWriter &JsonWriter::String(const char *value, size_t len)
+{
+    prefix();
+    escape(value, len);
+    return *this;
+}
+
+JsonWriter &JsonWriter::String(const char *value)
+{
+    return String(value, strlen(value));
+}
+
+JsonWriter &JsonWriter::Int(int64_t value)
+{
+    prefix();
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), "%lld", (long long)value);
+    out_.append(buf, n);
+    return *this;
+}
+
+JsonWriter &JsonWriter::Double(double value)
+{
+    prefix();
+    if (!std::isfinite(value))
+    {
+        out_.append("null");
+        return *this;
+    }
+    char buf[32];
+    int n = 0;
+    // 整数值直接按整数输出，省掉下面的多次格式化
+    if (std::fabs(value) < 1e15 && value == (double)(int64_t)value && !(value == 0 && std::signbit(value)))
+    {
+        n = snprintf(buf, sizeof(buf), "%lld.0", (long long)value);
+        out_.append(buf, n);
+        return *this;
+    }
+    // 取能精确还原的最短表示，避免0.1被写成0.10000000000000001
+    for (int precision = 15; precision <= 17; precision++)
+    {
+        n = snprintf(buf, sizeof(buf), "%.*g", precision, value);
+        if (strtod(buf, nullptr) == value)
+        {
+            break;
+        }
+    }
+    out_.append(buf, n);
+    // 与nlohmann一致，整数值的浮点数保留".0"以免被读回成整数
+    if (strpbrk(buf, ".eE") == nullptr)
+    {
+        out_.append(".0");
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::Bool(bool value)
+{
+    prefix();
+    out_.append(value ? "true" : "false");
+    return *this;
+}
+
+JsonWriter &JsonWriter::Null()
+{
+    prefix();
+    out_.append("null");
+    return *this;
+}
+
+JsonWriter &JsonWriter::Raw(const char *json, size_t len)
+{
+    prefix();
+    out_.append(json, len);
+    return *this;
+}
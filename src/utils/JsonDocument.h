@@ -0,0 +1,268 @@
+/**
+ * @file JsonDocument.h
+ * @brief 项目统一的JSON读写层
+ * @details JsonDocument 在自有缓冲区上原位（in-situ）解析，字符串转义直接在缓冲区内还原，
+ *          节点从按块分配的arena中取用，Clear/重新Parse时只复位游标不释放内存，
+ *          同一个文档对象反复解析时稳态下不再产生堆分配。
+ *          JsonWriter 直接向调用者提供的std::string追加序列化结果。
+ */
+#ifndef ROBOT_JSON_DOCUMENT_H
+#define ROBOT_JSON_DOCUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 只读JSON节点
+ * @details 节点及其字符串都属于所在的JsonDocument，文档重新解析或销毁后节点失效。
+ *          访问不存在的成员或下标时返回空节点（isNull()为true），可以放心链式访问。
+ */
+class JsonNode
+{
+public:
+    enum Type : uint8_t
+    {
+        TYPE_NULL,
+        TYPE_BOOL,
+        TYPE_NUMBER,
+        TYPE_STRING,
+        TYPE_ARRAY,
+        TYPE_OBJECT
+    };
+
+    /**
+     * @brief 子节点前向迭代器，用于 for (const JsonNode &item : node)
+     */
+    class Iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef JsonNode value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const JsonNode *pointer;
+        typedef const JsonNode &reference;
+
+        explicit Iterator(const JsonNode *node) : node_(node) {}
+
+        reference operator*() const { return *node_; }
+        pointer operator->() const { return node_; }
+        Iterator &operator++()
+        {
+            node_ = node_->next_;
+            return *this;
+        }
+        bool operator==(const Iterator &other) const { return node_ == other.node_; }
+        bool operator!=(const Iterator &other) const { return node_ != other.node_; }
+
+    private:
+        const JsonNode *node_;
+    };
+
+    JsonNode() = default;
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == TYPE_NULL; }
+    bool isBool() const { return type_ == TYPE_BOOL; }
+    bool isNumber() const { return type_ == TYPE_NUMBER; }
+    bool isInteger() const { return type_ == TYPE_NUMBER && integer_; }
+    bool isString() const { return type_ == TYPE_STRING; }
+    bool isArray() const { return type_ == TYPE_ARRAY; }
+    bool isObject() const { return type_ == TYPE_OBJECT; }
+
+    /**
+     * @brief 数组/对象的子节点个数，其他类型返回0
+     */
+    size_t size() const { return (type_ == TYPE_ARRAY || type_ == TYPE_OBJECT) ? size_ : 0; }
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief 对象是否包含指定成员
+     */
+    bool contains(const char *key) const;
+    bool contains(const std::string &key) const { return find(key.data(), key.size()) != nullptr; }
+
+    /**
+     * @brief 按成员名查找，不存在时返回nullptr
+     */
+    const JsonNode *find(const char *key, size_t key_len) const;
+
+    const JsonNode &operator[](const char *key) const;
+    const JsonNode &operator[](const std::string &key) const;
+    const JsonNode &operator[](int index) const;
+
+    /**
+     * @brief 字符串值（以'\0'结尾，指向文档缓冲区），非字符串返回""
+     */
+    const char *c_str() const { return type_ == TYPE_STRING ? str_ : ""; }
+    size_t length() const { return type_ == TYPE_STRING ? size_ : 0; }
+
+    std::string asString(const std::string &def = "") const;
+    int asInt(int def = 0) const;
+    int64_t asInt64(int64_t def = 0) const;
+    double asDouble(double def = 0.0) const;
+    bool asBool(bool def = false) const;
+
+    /**
+     * @brief 比较字符串值，非字符串节点返回false
+     */
+    bool equals(const char *text) const;
+
+    /**
+     * @brief 对象成员的名字，非对象成员返回""
+     */
+    const char *key() const { return key_ ? key_ : ""; }
+    size_t keyLength() const { return key_len_; }
+
+    Iterator begin() const { return Iterator(size() ? child_ : nullptr); }
+    Iterator end() const { return Iterator(nullptr); }
+
+    /**
+     * @brief 共享的空节点
+     */
+    static const JsonNode &Null();
+
+private:
+    friend class JsonDocument;
+
+    Type type_     = TYPE_NULL;
+    bool integer_  = false;
+    bool bool_     = false;
+    uint32_t size_ = 0;    // 字符串字节数或子节点个数
+    uint32_t key_len_ = 0;
+    const char *key_  = nullptr;
+    const char *str_  = nullptr;
+    int64_t int_      = 0;
+    double num_       = 0.0;
+    JsonNode *child_  = nullptr;
+    JsonNode *next_   = nullptr;
+};
+
+/**
+ * @brief 原位解析的JSON文档
+ * @details 不抛异常，解析失败返回false并可通过ErrorMessage/ErrorOffset定位。
+ *          一个文档对象不是线程安全的，多线程请各自持有。
+ */
+class JsonDocument
+{
+public:
+    JsonDocument();
+    ~JsonDocument() = default;
+
+    JsonDocument(const JsonDocument &) = delete;
+    JsonDocument &operator=(const JsonDocument &) = delete;
+
+    /**
+     * @brief 复制数据到内部缓冲区后原位解析，内部缓冲区容量会被复用
+     * @param data JSON文本，不要求以'\0'结尾
+     * @param len 文本长度
+     * @return 解析成功返回true
+     */
+    bool Parse(const char *data, size_t len);
+    bool Parse(const std::string &text) { return Parse(text.data(), text.size()); }
+
+    /**
+     * @brief 直接在调用者的缓冲区上解析，缓冲区会被改写且必须比文档活得更久
+     * @param buffer JSON文本
+     * @param len 文本长度
+     * @return 解析成功返回true
+     */
+    bool ParseInSitu(char *buffer, size_t len);
+
+    const JsonNode &Root() const { return root_ ? *root_ : JsonNode::Null(); }
+    const JsonNode &operator[](const char *key) const { return Root()[key]; }
+
+    /**
+     * @brief 丢弃当前解析结果，保留缓冲区和arena以便复用
+     */
+    void Clear();
+
+    const char *ErrorMessage() const { return error_; }
+    size_t ErrorOffset() const { return error_offset_; }
+
+    /**
+     * @brief 当前文档占用的节点数
+     */
+    size_t NodeCount() const { return node_count_; }
+
+    /**
+     * @brief arena已分配的节点块数（只增不减，用于观察稳态下是否还在分配）
+     */
+    size_t ArenaBlockCount() const { return blocks_.size(); }
+
+private:
+    static const size_t kNodesPerBlock = 256;
+    static const int kMaxDepth         = 256;
+
+    JsonNode *newNode();
+    bool fail(const char *message, const char *pos);
+
+    void skipSpace();
+    bool parseValue(JsonNode *node, int depth);
+    bool parseObject(JsonNode *node, int depth);
+    bool parseArray(JsonNode *node, int depth);
+    bool parseString(const char **out, uint32_t *out_len);
+    bool parseNumber(JsonNode *node);
+    bool parseLiteral(const char *literal, size_t len);
+
+    std::string buffer_;                                 // Parse()复制进来的文本
+    std::vector<std::unique_ptr<JsonNode[]>> blocks_;    // 节点arena
+    size_t block_index_ = 0;                             // 当前使用的块
+    size_t block_used_  = 0;                             // 当前块已用节点数
+    size_t node_count_  = 0;
+
+    char *begin_      = nullptr;
+    char *cur_        = nullptr;
+    char *end_        = nullptr;
+    JsonNode *root_   = nullptr;
+    const char *error_ = "";
+    size_t error_offset_ = 0;
+};
+
+/**
+ * @brief 流式JSON序列化器，直接向目标字符串追加
+ * @details 输出格式与nlohmann::json::dump()一致：紧凑格式，非ASCII的UTF-8原样输出。
+ *          用法：JsonWriter(out).StartObject().Key("a").Int(1).EndObject();
+ */
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string &out) : out_(out) {}
+
+    JsonWriter &StartObject();
+    JsonWriter &EndObject();
+    JsonWriter &StartArray();
+    JsonWriter &EndArray();
+
+    JsonWriter &Key(const char *key, size_t len);
+    JsonWriter &Key(const char *key);
+    JsonWriter &Key(const std::string &key) { return Key(key.data(), key.size()); }
+
+    JsonWriter &String(const char *value, size_t len);
+    JsonWriter &String(const char *value);
+    JsonWriter &String(const std::string &value) { return String(value.data(), value.size()); }
+    JsonWriter &Int(int64_t value);
+    JsonWriter &Double(double value);
+    JsonWriter &Bool(bool value);
+    JsonWriter &Null();
+
+    /**
+     * @brief 原样写入一段已序列化好的JSON值
+     */
+    JsonWriter &Raw(const char *json, size_t len);
+
+private:
+    void prefix();
+    void escape(const char *value, size_t len);
+    void open(char bracket);
+    void close(char bracket);
+
+    std::string &out_;
+    std::string has_item_;    // 每层容器是否已有元素，按嵌套深度增长，15层以内不分配
+    bool after_key_ = false;
+};
+
+#endif    // ROBOT_JSON_DOCUMENT_H
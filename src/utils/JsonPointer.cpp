@@ -0,0 +1,80 @@
+#include "JsonPointer.h"
+
+#include <cstdlib>
+
+#include "utils/JsonDocument.h"
+
+bool JsonPointer::compile(const std::string &path)
+{
+    path_.clear();
+    tokens_.clear();
+    if (path.empty())
+    {
+        return true;
+    }
+    if (path[0] != '/')
+    {
+        return false;
+    }
+
+    path_ = path;
+    size_t begin = 1;
+    while (true)
+    {
+        size_t end = path.find('/', begin);
+        std::string segment = path.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+
+        Token token;
+        for (size_t i = 0; i < segment.size(); i++)
+        {
+            if (segment[i] == '~' && i + 1 < segment.size() && (segment[i + 1] == '0' || segment[i + 1] == '1'))
+            {
+                token.key += segment[i + 1] == '0' ? '~' : '/';
+                i++;
+            }
+            else
+            {
+                token.key += segment[i];
+            }
+        }
+        // 下标不能有前导0（"0"本身除外）
+        if (!token.key.empty() && token.key.size() < 10 && token.key.find_first_not_of("0123456789") == std::string::npos &&
+            (token.key[0] != '0' || token.key.size() == 1))
+        {
+            token.index = atoi(token.key.c_str());
+        }
+        tokens_.push_back(token);
+
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+const JsonNode &JsonPointer::resolve(const JsonNode &root) const
+{
+    const JsonNode *node = &root;
+    for (const Token &token : tokens_)
+    {
+        if (node->isArray())
+        {
+            if (token.index < 0)
+            {
+                return JsonNode::Null();
+            }
+            node = &(*node)[token.index];
+        }
+        else
+        {
+            node = node->find(token.key.data(), token.key.size());
+            if (node == nullptr)
+            {
+                return JsonNode::Null();
+            }
+        }
+    }
+    return *node;
+}
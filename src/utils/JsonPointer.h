@@ -0,0 +1,47 @@
+/**
+ * @file JsonPointer.h
+ * @brief 预编译的JSON Pointer（RFC 6901）访问器
+ * @details 路径如"/data/result/0/type"在配置加载时拆成各级成员名或下标，之后每次访问只按段查找，
+ *          不再解析路径字符串，也不分配内存。数字段在数组上按下标、在对象上按成员名访问。
+ *          路径不存在时返回JsonNode::Null()。
+ */
+#ifndef ROBOT_JSON_POINTER_H
+#define ROBOT_JSON_POINTER_H
+
+#include <string>
+#include <vector>
+
+class JsonNode;
+
+class JsonPointer
+{
+public:
+    JsonPointer() = default;
+
+    /**
+     * @brief 编译路径，空串指向根节点
+     * @return 路径格式错误（非空且不以'/'开头）返回false，此时指向根节点
+     */
+    bool compile(const std::string &path);
+
+    const JsonNode &resolve(const JsonNode &root) const;
+
+    const std::string &path() const { return path_; }
+
+    /**
+     * @brief 是否设置过非空路径
+     */
+    bool valid() const { return !path_.empty(); }
+
+private:
+    struct Token
+    {
+        std::string key;    // 已还原~0、~1转义
+        int index = -1;     // 段是非负整数时的下标
+    };
+
+    std::string path_;
+    std::vector<Token> tokens_;
+};
+
+#endif    // ROBOT_JSON_POINTER_H
@@ -1,58 +1,289 @@
 #include "Logger.hpp"
-#include "ros2/ros_manager.hpp"
+
+#include <algorithm>
+#include <cstring>
 
 namespace Logger {
 
-// 静态成员变量定义（只有一个.cpp文件包含这些定义）
-std::shared_ptr<Logger> Logger::instance_ = nullptr;
-std::mutex Logger::instanceMutex_;
+// 类内初始化的静态常量被std::min等按引用使用时需要定义
+const size_t LogRecord::kTextSize;
+const size_t AsyncWriter::kMaxBatch;
+const size_t Logger::kAsyncCapacity;
+
+AsyncWriter::AsyncWriter(size_t capacity, OverflowPolicy policy, Output output, Idle idle)
+    : ring_(capacity), policy_(static_cast<int>(policy)), output_(std::move(output)), idle_(std::move(idle)) {
+    // 一条消息最多占四分之一队列，避免一条超长日志把队列占满
+    maxSlots_ = std::min<size_t>(ring_.capacity() / 4, UINT16_MAX);
+    message_.reserve(1024);
+}
+
+AsyncWriter::~AsyncWriter() {
+    Stop();
+}
+
+void AsyncWriter::Start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    lastReport_ = std::chrono::steady_clock::now();
+    worker_ = std::thread(&AsyncWriter::Run, this);
+    workerId_ = worker_.get_id();
+}
+
+void AsyncWriter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    workerId_ = std::thread::id();
+}
+
+bool AsyncWriter::Push(LogLevel level, const std::string& message, const char* file, int line) {
+    auto timestamp = std::chrono::system_clock::now();
+    size_t length = message.size();
+    size_t slots = std::max<size_t>(1, (length + LogRecord::kTextSize - 1) / LogRecord::kTextSize);
+    if (slots > maxSlots_) {
+        slots = maxSlots_;
+        length = slots * LogRecord::kTextSize;
+        truncated_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t pos = 0;
+    if (!ring_.tryClaim(slots, pos) && !WaitForSpace(level, slots, pos)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    LogRecord& head = ring_.at(pos);
+    head.timestamp = timestamp;
+    head.threadId = std::this_thread::get_id();
+    head.file = file ? file : "";
+    head.line = line;
+    head.level = level;
+    head.slots = static_cast<uint16_t>(slots);
+    for (size_t i = 0; i < slots; ++i) {
+        LogRecord& record = ring_.at(pos + i);
+        size_t offset = i * LogRecord::kTextSize;
+        size_t count = std::min(LogRecord::kTextSize, length - offset);
+        memcpy(record.text, message.data() + offset, count);
+        record.length = static_cast<uint16_t>(count);
+        ring_.publish(pos + i);
+    }
+
+    WakeConsumer();
+    return true;
+}
+
+void AsyncWriter::Flush(int timeoutMs) {
+    if (!running_ || IsWorkerThread()) return;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    // 队列空并且后台线程回到等待，说明取出的日志都已写出
+    while (!(ring_.sizeApprox() == 0 && waiting_.load()) && std::chrono::steady_clock::now() < deadline) {
+        WakeConsumer();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+AsyncWriter::Stats AsyncWriter::GetStats() const {
+    Stats stats;
+    stats.written = written_.load();
+    stats.batches = batches_.load();
+    stats.dropped = dropped_.load();
+    stats.blocked = blocked_.load();
+    stats.truncated = truncated_.load();
+    return stats;
+}
+
+void AsyncWriter::Run() {
+    bool written = false;
+    while (true) {
+        size_t count = Drain();
+        ReportDropped();
+        if (count == kMaxBatch) {
+            written = true;
+            continue;    // 队列里还有
+        }
+        // 一阵日志写完再统一刷出，连续写日志时由输出目标自己的缓冲上限和间隔决定
+        if (written || count > 0) {
+            idle_();
+            written = false;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!running_) break;
+        waiting_.store(true, std::memory_order_relaxed);
+        // 与WakeConsumer()中的fence配对：要么这里看到新日志，要么写日志的线程看到waiting_
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring_.front() == nullptr) {
+            cv_.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        waiting_.store(false, std::memory_order_relaxed);
+    }
+    // 停止前写出剩余的日志
+    while (Drain() > 0) {}
+    ReportDropped();
+    idle_();
+}
+
+size_t AsyncWriter::Drain() {
+    size_t count = 0;
+    LogRecord* record;
+    while (count < kMaxBatch && (record = ring_.front()) != nullptr) {
+        LogEntry entry(record->level, std::string(), record->file, record->line);
+        entry.timestamp = record->timestamp;
+        entry.threadId = record->threadId;
+        message_.assign(record->text, record->length);
+        size_t slots = record->slots;
+        ring_.popFront();
+        // 后面的记录已被同一个线程占用，可能还没写完
+        for (size_t i = 1; i < slots; ++i) {
+            while ((record = ring_.front()) == nullptr) {
+                std::this_thread::yield();
+            }
+            message_.append(record->text, record->length);
+            ring_.popFront();
+        }
+        entry.message.swap(message_);
+        output_(entry);
+        entry.message.swap(message_);
+        ++count;
+    }
+    if (count > 0) {
+        written_.fetch_add(count, std::memory_order_relaxed);
+        batches_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+void AsyncWriter::ReportDropped() {
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped == reportedDropped_) return;
+    auto now = std::chrono::steady_clock::now();
+    if (running_ && now - lastReport_ < std::chrono::seconds(1)) return;
+
+    LogEntry entry(LogLevel::LOG_WARN, "日志队列满，丢弃 " + std::to_string(dropped - reportedDropped_) +
+                   " 条 (累计 " + std::to_string(dropped) + " 条, 等待 " +
+                   std::to_string(blocked_.load(std::memory_order_relaxed)) + " 次)", Basename(__FILE__), __LINE__);
+    output_(entry);
+    reportedDropped_ = dropped;
+    lastReport_ = now;
+}
+
+bool AsyncWriter::WaitForSpace(LogLevel level, size_t slots, size_t& pos) {
+    OverflowPolicy policy = static_cast<OverflowPolicy>(policy_.load(std::memory_order_relaxed));
+    if (policy == OverflowPolicy::DROP) return false;
+    if (policy == OverflowPolicy::DROP_LOW && static_cast<int>(level) < static_cast<int>(LogLevel::LOG_WARN)) return false;
+
+    blocked_.fetch_add(1, std::memory_order_relaxed);
+    for (int spin = 0; running_; ++spin) {
+        WakeConsumer();
+        if (spin < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        if (ring_.tryClaim(slots, pos)) return true;
+    }
+    return false;
+}
+
+void AsyncWriter::WakeConsumer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+    }
+}
 
 // 构造函数定义
-Logger::Logger() : level_(LogLevel::LOG_INFO), asyncMode_(false) {
+Logger::Logger() : level_(static_cast<int>(LogLevel::LOG_INFO)), asyncMode_(false),
+                   overflowPolicy_(OverflowPolicy::DROP_LOW), asyncWriter_(nullptr) {
     formatter_ = std::unique_ptr<DefaultFormatter>(new DefaultFormatter());
     // 默认不添加控制台输出
     //AddSink(std::unique_ptr<ConsoleSink>(new ConsoleSink(true)));
 }
 
+Logger::~Logger() {
+    // 先停后台线程再析构输出目标
+    SetAsyncMode(false);
+}
+
 // 获取单例实例
 Logger& Logger::GetInstance() {
-    std::lock_guard<std::mutex> lock(instanceMutex_);
-    if (!instance_) {
-        instance_ = std::shared_ptr<Logger>(new Logger());
-    }
-    return *instance_;
+    // C++11保证局部静态变量只初始化一次，之后每次调用只是一次判断
+    static Logger instance;
+    return instance;
 }
 
 // 设置日志级别
 void Logger::SetLevel(LogLevel level) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    level_ = level;
+    level_.store(static_cast<int>(level), std::memory_order_relaxed);
 }
 
 LogLevel Logger::GetLevel() const {
-    return level_;
+    return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
 }
 
 // 添加输出目标
 void Logger::AddSink(std::unique_ptr<LogSink> sink) {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (asyncMode_) {
-        sinks_.push_back(std::unique_ptr<AsyncSink>(new AsyncSink(std::move(sink))));
-    } else {
-        sinks_.push_back(std::move(sink));
+    sinks_.push_back(std::move(sink));
+}
+
+void Logger::RemoveSink(LogSink* sink) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = sinks_.begin(); it != sinks_.end(); ++it) {
+        if (it->get() == sink) {
+            sink->Flush();
+            sinks_.erase(it);
+            return;
+        }
     }
 }
 
 // 设置异步模式
 void Logger::SetAsyncMode(bool enable) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (asyncMode_ != enable) {
+    AsyncWriter* writer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (asyncMode_ == enable) return;
         asyncMode_ = enable;
-        // 重新创建sinks（实际应用中需要更复杂的处理）
-        // 这里简化处理，建议在添加所有sink前设置async模式
+        if (!asyncOwner_) {
+            asyncOwner_.reset(new AsyncWriter(kAsyncCapacity, overflowPolicy_,
+                                              [this](const LogEntry& entry) { WriteSinks(entry); },
+                                              [this]() { FlushSinks(); }));
+        }
+        writer = asyncOwner_.get();
+    }
+
+    // 后台线程写日志时要拿mutex_，启停不能在锁内
+    if (enable) {
+        writer->Start();
+        asyncWriter_.store(writer, std::memory_order_release);
+    } else {
+        asyncWriter_.store(nullptr, std::memory_order_release);
+        writer->Stop();
     }
 }
 
+void Logger::SetOverflowPolicy(OverflowPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    overflowPolicy_ = policy;
+    if (asyncOwner_) {
+        asyncOwner_->SetPolicy(policy);
+    }
+}
+
+AsyncWriter::Stats Logger::GetAsyncStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return asyncOwner_ ? asyncOwner_->GetStats() : AsyncWriter::Stats();
+}
+
 // 设置格式化器
 void Logger::SetFormatter(std::unique_ptr<LogFormatter> formatter) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -61,32 +292,47 @@ void Logger::SetFormatter(std::unique_ptr<LogFormatter> formatter) {
 
 // 日志记录主函数
 void Logger::Log(LogLevel level, const std::string& message,
-                 const std::string& file, int line) {
-    if (static_cast<int>(level) < static_cast<int>(level_)) return;
+                 const char* file, int line) {
+    if (!ShouldLog(level)) return;
 
-    /*通过ROS话题robot_avvtn_log发布出去*/
-    ROSManager::getInstance().publishLog(message);
-
-    LogEntry entry(level, message, file, line);
-    std::string formatted;
-
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        formatted = formatter_->Format(entry);
+    AsyncWriter* writer = asyncWriter_.load(std::memory_order_acquire);
+    if (writer != nullptr && !writer->IsWorkerThread()) {
+        writer->Push(level, message, file, line);
+        return;
     }
+    WriteSinks(LogEntry(level, message, file ? file : "", line));
+}
 
-    // 遍历所有输出目标
+void Logger::WriteSinks(const LogEntry& entry) {
+    // 持锁遍历，输出目标可以在其他线程写日志时添加；输出目标的Write()里不能再写日志
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t length = formatter_->FormatTo(entry, formatBuffer_, sizeof(formatBuffer_));
+    if (length <= sizeof(formatBuffer_)) {
+        // formatted_的容量反复使用，一般不再分配
+        formatted_.assign(formatBuffer_, length);
+    } else {
+        formatted_.assign(length, '\0');
+        formatter_->FormatTo(entry, &formatted_[0], length);
+    }
     for (auto& sink : sinks_) {
-        sink->Write(entry, formatted);
+        sink->Write(entry, formatted_);
     }
 }
 
-// 刷新所有输出
-void Logger::Flush() {
+void Logger::FlushSinks() {
     std::lock_guard<std::mutex> lock(mutex_);
     for (auto& sink : sinks_) {
         sink->Flush();
     }
 }
 
+// 刷新所有输出
+void Logger::Flush() {
+    AsyncWriter* writer = asyncWriter_.load(std::memory_order_acquire);
+    if (writer != nullptr) {
+        writer->Flush();
+    }
+    FlushSinks();
+}
+
 } // namespace Logger
\ No newline at end of file
@@ -14,6 +14,12 @@
 #include <thread>
 #include <condition_variable>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <functional>
+
+#include "MpscRing.h"
 
 namespace Logger {
 
@@ -41,6 +47,18 @@ inline const char* LevelToString(LogLevel level) {
     }
 }
 
+// 字符串转日志级别，不认识的返回defaultLevel
+inline LogLevel LevelFromString(const std::string& name, LogLevel defaultLevel) {
+    if (name == "TRACE") return LogLevel::LOG_TRACE;
+    if (name == "DEBUG") return LogLevel::LOG_DEBUG;
+    if (name == "INFO")  return LogLevel::LOG_INFO;
+    if (name == "WARN")  return LogLevel::LOG_WARN;
+    if (name == "ERROR") return LogLevel::LOG_ERROR;
+    if (name == "FATAL") return LogLevel::LOG_FATAL;
+    if (name == "OFF")   return LogLevel::LOG_OFF;
+    return defaultLevel;
+}
+
 // 日志级别颜色（控制台输出）
 inline const char* LevelToColor(LogLevel level) {
     switch (level) {
@@ -54,6 +72,15 @@ inline const char* LevelToColor(LogLevel level) {
     }
 }
 
+// 去掉路径只留文件名，日志宏中在编译期求值
+constexpr const char* Basename(const char* path) {
+    const char* name = path;
+    for (const char* p = path; *p != '\0'; ++p) {
+        if (*p == '/' || *p == '\\') name = p + 1;
+    }
+    return name;
+}
+
 // 日志条目
 struct LogEntry {
     std::chrono::system_clock::time_point timestamp;
@@ -76,32 +103,132 @@ class LogFormatter {
 public:
     virtual ~LogFormatter() = default;
     virtual std::string Format(const LogEntry& entry) = 0;
+
+    // 格式化到调用方提供的缓冲，返回完整结果的长度；返回值大于size时缓冲中的结果不完整，
+    // 调用方应换一个足够大的缓冲再调用。默认实现经过Format(entry)，子类可以直接写缓冲省去分配
+    virtual size_t FormatTo(const LogEntry& entry, char* buffer, size_t size) {
+        std::string text = Format(entry);
+        memcpy(buffer, text.data(), text.size() < size ? text.size() : size);
+        return text.size();
+    }
 };
 
-// 默认日志格式化器
+// 默认日志格式化器：2024-01-01 12:00:00.123 [INFO ] [thread:...] [file.cpp:10] message
+// 直接写进调用方的缓冲，不用stringstream也不分配内存；同一秒内的日期时间只格式化一次（每个线程缓存一份），
+// 只追加毫秒；线程号也按线程缓存。文件名由日志宏在编译期去掉路径
 class DefaultFormatter : public LogFormatter {
 public:
     std::string Format(const LogEntry& entry) override {
-        auto time = std::chrono::system_clock::to_time_t(entry.timestamp);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            entry.timestamp.time_since_epoch()).count() % 1000;
-        
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S")
-           << "." << std::setfill('0') << std::setw(3) << ms
-           << " [" << LevelToString(entry.level) << "]"
-           << " [thread:" << entry.threadId << "]";
-        
+        char buffer[1024];
+        size_t length = FormatTo(entry, buffer, sizeof(buffer));
+        if (length <= sizeof(buffer)) {
+            return std::string(buffer, length);
+        }
+        std::string text(length, '\0');
+        FormatTo(entry, &text[0], length);
+        return text;
+    }
+
+    size_t FormatTo(const LogEntry& entry, char* buffer, size_t size) override {
+        Output out{buffer, size, 0};
+
+        long long msTotal = std::chrono::duration_cast<std::chrono::milliseconds>(
+            entry.timestamp.time_since_epoch()).count();
+        const SecondText& second = SecondOf(static_cast<time_t>(msTotal / 1000));
+        out.Append(second.text, second.length);
+        int ms = static_cast<int>(msTotal % 1000);
+        char msText[4] = {'.', static_cast<char>('0' + ms / 100), static_cast<char>('0' + ms / 10 % 10),
+                          static_cast<char>('0' + ms % 10)};
+        out.Append(msText, sizeof(msText));
+
+        out.Append(" [", 2);
+        out.Append(LevelToString(entry.level));
+        out.Append("] [thread:", 10);
+        const ThreadText& thread = ThreadOf(entry.threadId);
+        out.Append(thread.text, thread.length);
+        out.Append("]", 1);
+
         if (!entry.file.empty()) {
-            // 提取文件名（不含路径）
-            size_t pos = entry.file.find_last_of("/\\");
-            std::string filename = (pos != std::string::npos) ? 
-                                  entry.file.substr(pos + 1) : entry.file;
-            ss << " [" << filename << ":" << entry.line << "]";
+            out.Append(" [", 2);
+            out.Append(entry.file.data(), entry.file.size());
+            out.Append(":", 1);
+            out.AppendInt(entry.line);
+            out.Append("]", 1);
         }
-        
-        ss << " " << entry.message;
-        return ss.str();
+
+        out.Append(" ", 1);
+        out.Append(entry.message.data(), entry.message.size());
+        return out.length;
+    }
+
+private:
+    // 写满后继续累计长度，不再写入
+    struct Output {
+        char* buffer;
+        size_t size;
+        size_t length;
+
+        void Append(const char* text, size_t count) {
+            if (length < size) {
+                memcpy(buffer + length, text, count < size - length ? count : size - length);
+            }
+            length += count;
+        }
+
+        void Append(const char* text) {
+            Append(text, strlen(text));
+        }
+
+        void AppendInt(int value) {
+            char digits[12];
+            int pos = sizeof(digits);
+            unsigned int magnitude = value < 0 ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+            do {
+                digits[--pos] = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude > 0);
+            if (value < 0) digits[--pos] = '-';
+            Append(digits + pos, sizeof(digits) - pos);
+        }
+    };
+
+    struct SecondText {
+        time_t second = -1;
+        char text[32];
+        size_t length = 0;
+    };
+
+    struct ThreadText {
+        std::thread::id id;
+        char text[24];
+        size_t length = 0;
+    };
+
+    // localtime_r只在秒变化时调用
+    static const SecondText& SecondOf(time_t second) {
+        static thread_local SecondText cache;
+        if (cache.second != second) {
+            struct tm local;
+            localtime_r(&second, &local);
+            cache.length = strftime(cache.text, sizeof(cache.text), "%Y-%m-%d %H:%M:%S", &local);
+            cache.second = second;
+        }
+        return cache;
+    }
+
+    // 异步模式下一个线程格式化所有线程的日志，按线程号散列缓存几份
+    static const ThreadText& ThreadOf(std::thread::id id) {
+        static thread_local ThreadText cache[8];
+        ThreadText& slot = cache[std::hash<std::thread::id>()(id) % 8];
+        if (slot.length == 0 || slot.id != id) {
+            std::ostringstream os;
+            os << id;
+            std::string text = os.str();
+            slot.length = text.size() < sizeof(slot.text) ? text.size() : sizeof(slot.text);
+            memcpy(slot.text, text.data(), slot.length);
+            slot.id = id;
+        }
+        return slot;
     }
 };
 
@@ -122,13 +249,17 @@ private:
 public:
     explicit ConsoleSink(bool useColors = true) : useColors_(useColors) {}
 
+    // 不逐行flush，由Flush()或WARN及以上的日志刷出；输出到终端时stdio本身按行缓冲
     void Write(const LogEntry& entry, const std::string& formatted) override {
         std::lock_guard<std::mutex> lock(mutex_);
         if (useColors_) {
             std::cout << LevelToColor(entry.level) << formatted 
-                     << "\033[0m" << std::endl;
+                     << "\033[0m\n";
         } else {
-            std::cout << formatted << std::endl;
+            std::cout << formatted << '\n';
+        }
+        if (static_cast<int>(entry.level) >= static_cast<int>(LogLevel::LOG_WARN)) {
+            std::cout.flush();
         }
     }
 
@@ -138,6 +269,9 @@ public:
 };
 
 // 文件输出
+// 格式化结果本身不带颜色（颜色只由ConsoleSink加），直接写入；先写进内存缓冲，
+// 缓冲满、日志级别达到flushLevel、距上次写盘超过flushIntervalMs或调用Flush()时一次写盘
+// 文件大小在内存中累计，不再每行seekp/tellp
 class FileSink : public LogSink {
 private:
     std::ofstream file_;
@@ -146,48 +280,43 @@ private:
     size_t maxSize_;          // 最大文件大小（字节）
     int maxFiles_;           // 最大文件数量
     bool dailyRolling_;      // 是否按天滚动
-    
-    // 移除ANSI颜色代码的辅助函数
-
-    std::string StripANSICodes(const std::string& input) {
-        std::string result;
-        bool inEscape = false;
-        
-        for (size_t i = 0; i < input.size(); ++i) {
-            if (inEscape) {
-                // 如果在ANSI转义序列中，继续直到找到'm'
-                if (input[i] == 'm') {
-                    inEscape = false;
-                }
-                continue;
-            }
-            
-            // 检查是否开始ANSI转义序列
-            if (input[i] == '\033' && i + 1 < input.size() && input[i+1] == '[') {
-                inEscape = true;
-                i++; // 跳过'['字符
-                continue;
-            }
-            
-            result.push_back(input[i]);
-        }
-        
-        return result;
-    }
+    size_t size_;            // 当前文件大小，含缓冲中未写盘的部分
+    std::string buffer_;
+    size_t bufferSize_;      // 缓冲达到这么多字节写盘
+    LogLevel flushLevel_;    // 该级别及以上的日志立即写盘
+    std::chrono::milliseconds flushInterval_;
+    std::chrono::steady_clock::time_point lastFlush_;
 
 public:
     FileSink(const std::string& filename, size_t maxSize = 10 * 1024 * 1024,
-             int maxFiles = 5, bool dailyRolling = false)
+             int maxFiles = 5, bool dailyRolling = false,
+             size_t bufferSize = 64 * 1024, LogLevel flushLevel = LogLevel::LOG_WARN,
+             int flushIntervalMs = 1000)
         : filename_(filename), maxSize_(maxSize), 
-          maxFiles_(maxFiles), dailyRolling_(dailyRolling) {
+          maxFiles_(maxFiles), dailyRolling_(dailyRolling), size_(0),
+          bufferSize_(bufferSize), flushLevel_(flushLevel),
+          flushInterval_(flushIntervalMs), lastFlush_(std::chrono::steady_clock::now()) {
+        buffer_.reserve(bufferSize_);
         OpenFile();
     }
     
     ~FileSink() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        WriteBuffer();
         if (file_.is_open()) {
             file_.close();
         }
     }
+
+    // 运行中调整缓冲，bufferSize为0时逐行写盘
+    void SetBuffering(size_t bufferSize, LogLevel flushLevel, int flushIntervalMs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        WriteBuffer();
+        bufferSize_ = bufferSize;
+        flushLevel_ = flushLevel;
+        flushInterval_ = std::chrono::milliseconds(flushIntervalMs);
+        buffer_.reserve(bufferSize_);
+    }
     
     void Write(const LogEntry& entry, const std::string& formatted) override {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -196,16 +325,20 @@ public:
         CheckRollover();
         
         if (file_.is_open()) {
-            // 移除颜色代码后写入
-            std::string clean_text = StripANSICodes(formatted);
-            file_ << clean_text << std::endl;
+            buffer_.append(formatted);
+            buffer_.push_back('\n');
+            size_ += formatted.size() + 1;
+            if (buffer_.size() >= bufferSize_ ||
+                static_cast<int>(entry.level) >= static_cast<int>(flushLevel_) ||
+                std::chrono::steady_clock::now() - lastFlush_ >= flushInterval_) {
+                WriteBuffer();
+            }
         }
     }
 
     void Flush() override {
-        if (file_.is_open()) {
-            file_.flush();
-        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        WriteBuffer();
     }
     
 private:
@@ -213,20 +346,30 @@ private:
         file_.open(filename_, std::ios::app);
         if (!file_.is_open()) {
             std::cerr << "Failed to open log file: " << filename_ << std::endl;
+            return;
         }
+        // 只在打开时取一次文件大小
+        file_.seekp(0, std::ios::end);
+        std::streamoff end = file_.tellp();
+        size_ = end > 0 ? static_cast<size_t>(end) : 0;
+    }
+
+    void WriteBuffer() {
+        if (!buffer_.empty() && file_.is_open()) {
+            file_.write(buffer_.data(), buffer_.size());
+            file_.flush();
+        }
+        buffer_.clear();
+        lastFlush_ = std::chrono::steady_clock::now();
     }
     
     void CheckRollover() {
         if (!file_.is_open()) return;
         
-        // 检查文件大小
-        file_.seekp(0, std::ios::end);
-        size_t currentSize = file_.tellp();
-        
         bool shouldRoll = false;
         
         // 文件大小检查
-        if (currentSize >= maxSize_) {
+        if (size_ >= maxSize_) {
             shouldRoll = true;
         }
         
@@ -253,6 +396,8 @@ private:
     }
     
     void RolloverFiles() {
+        // 缓冲中的日志属于当前文件
+        WriteBuffer();
         file_.close();
         
         // 删除最旧的文件
@@ -274,107 +419,180 @@ private:
     }
 };
 
-// 异步日志输出
-class AsyncSink : public LogSink {
+// 异步模式下队列满时的处理方式
+enum class OverflowPolicy {
+    BLOCK,      // 等到有空位
+    DROP,       // 丢弃
+    DROP_LOW    // WARN以下丢弃，WARN及以上等到有空位
+};
+
+// 字符串转溢出策略："block"、"drop"、"drop_low"，不认识的返回defaultPolicy
+inline OverflowPolicy OverflowPolicyFromString(const std::string& name, OverflowPolicy defaultPolicy) {
+    if (name == "block") return OverflowPolicy::BLOCK;
+    if (name == "drop") return OverflowPolicy::DROP;
+    if (name == "drop_low") return OverflowPolicy::DROP_LOW;
+    return defaultPolicy;
+}
+
+// 异步队列中的一条定长记录，超过kTextSize的消息占用多个连续记录，头部字段只在第一个记录中有效
+struct LogRecord {
+    static const size_t kTextSize = 200;
+
+    std::chrono::system_clock::time_point timestamp;
+    std::thread::id threadId;
+    const char* file;         // 静态存储的文件名
+    int line;
+    LogLevel level;
+    uint16_t slots;           // 整条消息占用的记录数
+    uint16_t length;          // 本记录text中的字节数
+    char text[kTextSize];
+};
+
+// 异步日志：所有线程的日志写进同一个预分配的无锁环形队列，一个后台线程成批取出，交给output写到所有输出目标
+// 写日志的线程不加锁不分配内存，只在后台线程空闲等待时通知一次
+class AsyncWriter {
+public:
+    struct Stats {
+        uint64_t written = 0;      // 已写出的日志条数
+        uint64_t batches = 0;      // 后台线程取出的批数
+        uint64_t dropped = 0;      // 队列满丢弃的条数
+        uint64_t blocked = 0;      // 队列满等待的次数
+        uint64_t truncated = 0;    // 超长截断的条数
+    };
+
+    typedef std::function<void(const LogEntry&)> Output;
+    typedef std::function<void()> Idle;
+
+    // 后台线程一批最多取出的日志条数
+    static const size_t kMaxBatch = 256;
+
+    // capacity为记录数，向上取整到2的幂
+    // idle在队列取空、后台线程准备等待前调用，用于把输出目标的缓冲写出
+    AsyncWriter(size_t capacity, OverflowPolicy policy, Output output, Idle idle);
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    void Start();
+
+    // 写出队列中剩余的日志后停止后台线程
+    void Stop();
+
+    // 入队；丢弃时返回false
+    bool Push(LogLevel level, const std::string& message, const char* file, int line);
+
+    // 等待队列中的日志写出，最多等timeoutMs
+    void Flush(int timeoutMs = 1000);
+
+    void SetPolicy(OverflowPolicy policy) { policy_.store(static_cast<int>(policy), std::memory_order_relaxed); }
+
+    // 后台线程自己打的日志不能入队，队列满时会等死自己
+    bool IsWorkerThread() const { return std::this_thread::get_id() == workerId_.load(std::memory_order_relaxed); }
+
+    Stats GetStats() const;
+
 private:
-    std::unique_ptr<LogSink> sink_;
-    std::queue<std::pair<LogEntry, std::string>> queue_;
-    std::mutex queueMutex_;
+    void Run();
+    size_t Drain();
+    void ReportDropped();
+    bool WaitForSpace(LogLevel level, size_t slots, size_t& pos);
+    void WakeConsumer();
+
+    MpscRing<LogRecord> ring_;
+    size_t maxSlots_;                       // 一条消息最多占用的记录数，超出截断
+    std::atomic<int> policy_;
+    Output output_;
+    Idle idle_;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> blocked_{0};
+    std::atomic<uint64_t> truncated_{0};
+    uint64_t reportedDropped_ = 0;          // 只在后台线程访问
+    std::chrono::steady_clock::time_point lastReport_;
+
+    std::mutex mutex_;
     std::condition_variable cv_;
-    std::atomic<bool> running_;
+    std::atomic<bool> waiting_{false};      // 后台线程正在等待，写日志的线程需要通知
+    std::atomic<bool> running_{false};
     std::thread worker_;
-    
-public:
-    explicit AsyncSink(std::unique_ptr<LogSink> sink)
-        : sink_(std::move(sink)), running_(true) {
-        worker_ = std::thread(&AsyncSink::ProcessQueue, this);
-    }
-    
-    ~AsyncSink() {
-        Stop();
-    }
-    
-    void Write(const LogEntry& entry, const std::string& formatted) override {
-        {
-            std::lock_guard<std::mutex> lock(queueMutex_);
-            queue_.emplace(entry, formatted);
-        }
-        cv_.notify_one();
-    }
-    
-    void Flush() override {
-        sink_->Flush();
-    }
-    
-    void Stop() {
-        running_ = false;
-        cv_.notify_one();
-        if (worker_.joinable()) {
-            worker_.join();
-        }
-    }
-    
-private:
-    void ProcessQueue() {
-        while (running_ || !queue_.empty()) {
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            cv_.wait(lock, [this] { 
-                return !queue_.empty() || !running_; 
-            });
-            
-            if (!queue_.empty()) {
-                auto item = queue_.front();
-                queue_.pop();
-                lock.unlock();
-                
-                sink_->Write(item.first, item.second);
-            }
-        }
-    }
+    std::atomic<std::thread::id> workerId_;
+    std::string message_;                   // 后台线程拼接消息用，复用内存
 };
 
 // 主日志器类
 class Logger {
 private:
-    // 静态成员声明（在头文件中只有声明，没有定义）
-    static std::shared_ptr<Logger> instance_;
-    static std::mutex instanceMutex_;
-    
-    LogLevel level_;
+    // 级别单独用原子变量，宏里判断级别不加锁
+    std::atomic<int> level_;
     std::vector<std::unique_ptr<LogSink>> sinks_;
     std::unique_ptr<LogFormatter> formatter_;
     std::mutex mutex_;
     bool asyncMode_;
+    OverflowPolicy overflowPolicy_;
+    std::unique_ptr<AsyncWriter> asyncOwner_;
+    std::atomic<AsyncWriter*> asyncWriter_;     // 异步模式下非空，Log()不加锁读取
+
+    // 异步队列的记录数，每条记录256字节左右
+    static const size_t kAsyncCapacity = 4096;
     
     // 私有构造函数
     Logger();
+    ~Logger();
+
+    // 格式化后写到所有输出目标
+    void WriteSinks(const LogEntry& entry);
+
+    // 格式化缓冲，在mutex_内使用；超长的日志改用formatted_分配
+    char formatBuffer_[4096];
+    std::string formatted_;
+
+    void FlushSinks();
     
 public:
     // 删除拷贝构造函数和赋值运算符
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
     
+    // 局部静态变量，初始化之后取实例不加锁
     static Logger& GetInstance();
     
     // 设置日志级别
     void SetLevel(LogLevel level);
     
     LogLevel GetLevel() const;
+
+    // 该级别是否输出，宏在求值参数之前先调用
+    bool ShouldLog(LogLevel level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
     
     // 添加输出目标
     void AddSink(std::unique_ptr<LogSink> sink);
+
+    // 移除并析构输出目标，移除前先刷出
+    void RemoveSink(LogSink* sink);
     
-    // 设置异步模式
+    // 设置异步模式：所有输出目标共用一个后台线程
     void SetAsyncMode(bool enable);
+
+    // 异步模式下队列满时的处理方式，默认DROP_LOW
+    void SetOverflowPolicy(OverflowPolicy policy);
+
+    // 异步队列统计，未开启过异步模式时全为0
+    AsyncWriter::Stats GetAsyncStats();
     
     // 设置格式化器
     void SetFormatter(std::unique_ptr<LogFormatter> formatter);
     
     // 日志记录主函数
+    // file须为静态存储的字符串（__FILE__或Basename(__FILE__)），异步模式下只保存指针
     void Log(LogLevel level, const std::string& message,
-             const std::string& file = "", int line = 0);
+             const char* file = "", int line = 0);
     
-    // 刷新所有输出
+    // 刷新所有输出，异步模式下先等队列中的日志写出
     void Flush();
 };
 
@@ -404,12 +622,30 @@ namespace fmt {
     }
 }
 
+// 编译期最低级别，低于它的日志调用在编译时去掉，参数也不求值；取值同LogLevel（0为TRACE，6全部去掉）
+// 由src/CMakeLists.txt的LOG_MIN_LEVEL传入
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+// 先判断级别再格式化，被过滤的日志不调用snprintf也不分配内存
+#define LOG_AT_LEVEL(level, ...) \
+    do { \
+        if (static_cast<int>(level) >= LOG_MIN_LEVEL) { \
+            Logger::Logger& log_instance = Logger::Logger::GetInstance(); \
+            if (log_instance.ShouldLog(level)) { \
+                constexpr const char* log_basename = Logger::Basename(__FILE__); \
+                log_instance.Log(level, Logger::fmt::format(__VA_ARGS__), log_basename, __LINE__); \
+            } \
+        } \
+    } while (0)
+
 // 便捷宏定义
-#define LOG_TRACE(...)  Logger::Logger::GetInstance().Log(Logger::LogLevel::LOG_TRACE, Logger::fmt::format(__VA_ARGS__), __FILE__, __LINE__)
-#define LOG_DEBUG(...)  Logger::Logger::GetInstance().Log(Logger::LogLevel::LOG_DEBUG, Logger::fmt::format(__VA_ARGS__), __FILE__, __LINE__)
-#define LOG_INFO(...)   Logger::Logger::GetInstance().Log(Logger::LogLevel::LOG_INFO,  Logger::fmt::format(__VA_ARGS__), __FILE__, __LINE__)
-#define LOG_WARN(...)   Logger::Logger::GetInstance().Log(Logger::LogLevel::LOG_WARN,  Logger::fmt::format(__VA_ARGS__), __FILE__, __LINE__)
-#define LOG_ERROR(...)  Logger::Logger::GetInstance().Log(Logger::LogLevel::LOG_ERROR, Logger::fmt::format(__VA_ARGS__), __FILE__, __LINE__)
-#define LOG_FATAL(...)  Logger::Logger::GetInstance().Log(Logger::LogLevel::LOG_FATAL, Logger::fmt::format(__VA_ARGS__), __FILE__, __LINE__)
+#define LOG_TRACE(...)  LOG_AT_LEVEL(Logger::LogLevel::LOG_TRACE, __VA_ARGS__)
+#define LOG_DEBUG(...)  LOG_AT_LEVEL(Logger::LogLevel::LOG_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)   LOG_AT_LEVEL(Logger::LogLevel::LOG_INFO,  __VA_ARGS__)
+#define LOG_WARN(...)   LOG_AT_LEVEL(Logger::LogLevel::LOG_WARN,  __VA_ARGS__)
+#define LOG_ERROR(...)  LOG_AT_LEVEL(Logger::LogLevel::LOG_ERROR, __VA_ARGS__)
+#define LOG_FATAL(...)  LOG_AT_LEVEL(Logger::LogLevel::LOG_FATAL, __VA_ARGS__)
 
 } // namespace Logger
\ No newline at end of file
@@ -0,0 +1,171 @@
+/**
+ * @file MpscRing.h
+ * @brief 定长无锁环形队列，多生产者单消费者
+ * @details 每个格子带序号（Vyukov有界队列）：生产者用CAS抢写入位置，写完后发布序号，消费者按序号判断格子是否可读。
+ *          格子在构造时一次分配，之后入队出队不加锁也不分配内存；队列满时tryPush()立即返回false，由调用方决定丢弃还是重试。
+ *          大的数据可以用tryClaim()一次占用多个连续位置，原地写入后逐个发布，消费者用front()/popFront()原地读取。
+ *          只能有一个线程调用tryPop()、front()和popFront()。
+ */
+#ifndef ROBOT_MPSC_RING_H
+#define ROBOT_MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+template <typename T>
+class MpscRing
+{
+public:
+    /**
+     * @param capacity 容量，向上取整到2的幂
+     */
+    explicit MpscRing(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing &) = delete;
+    MpscRing &operator=(const MpscRing &) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * @brief 入队，队列满时返回false
+     */
+    template <typename U>
+    bool tryPush(U &&value)
+    {
+        size_t pos = 0;
+        if (!tryClaim(1, pos))
+        {
+            return false;
+        }
+        at(pos) = std::forward<U>(value);
+        publish(pos);
+        return true;
+    }
+
+    /**
+     * @brief 出队，队列空时返回false；只能在消费者线程调用
+     */
+    bool tryPop(T &value)
+    {
+        T *item = front();
+        if (item == nullptr)
+        {
+            return false;
+        }
+        value = std::move(*item);
+        popFront();
+        return true;
+    }
+
+    /**
+     * @brief 一次占用count个连续位置，供一条数据跨多个格子时使用；空位不足返回false
+     * @param pos 成功时为第一个位置，用at(pos + i)原地写入，再逐个publish()
+     */
+    bool tryClaim(size_t count, size_t &pos)
+    {
+        if (count == 0 || count > capacity())
+        {
+            return false;
+        }
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            // 消费者按顺序释放格子，最后一个位置空出来，前面的也一定空出来了
+            size_t last     = pos + count - 1;
+            size_t sequence = cells_[last & mask_].sequence.load(std::memory_order_acquire);
+            intptr_t diff   = (intptr_t)sequence - (intptr_t)last;
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // 这个格子上一轮的数据还没被取走，队列满
+                return false;
+            }
+            else
+            {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief 已占用位置上的格子，写完后publish()
+     */
+    T &at(size_t pos) { return cells_[pos & mask_].value; }
+
+    /**
+     * @brief 发布一个已写好的位置，消费者随后可以读到
+     */
+    void publish(size_t pos) { cells_[pos & mask_].sequence.store(pos + 1, std::memory_order_release); }
+
+    /**
+     * @brief 队首已发布的格子，原地读取后调用popFront()；没有返回nullptr。只能在消费者线程调用
+     */
+    T *front()
+    {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell *cell = &cells_[pos & mask_];
+        if (cell->sequence.load(std::memory_order_acquire) != pos + 1)
+        {
+            return nullptr;
+        }
+        return &cell->value;
+    }
+
+    /**
+     * @brief 释放队首格子，只能在front()返回非空之后调用
+     */
+    void popFront()
+    {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        cells_[pos & mask_].sequence.store(pos + mask_ + 1, std::memory_order_release);
+        dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 大致的元素个数，仅用于统计
+     */
+    size_t sizeApprox() const
+    {
+        size_t enqueue = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t dequeue = dequeue_pos_.load(std::memory_order_relaxed);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    char pad0_[64];    // 写入和读取位置分在不同的缓存行，生产者之间的竞争不波及消费者
+    std::atomic<size_t> enqueue_pos_{ 0 };
+    char pad1_[64];
+    std::atomic<size_t> dequeue_pos_{ 0 };    // 只有消费者写
+};
+
+#endif    // ROBOT_MPSC_RING_H
@@ -5,18 +5,19 @@
 #ifndef AIUI_SDK_STREAMNLPTTSHELPER_H
 #define AIUI_SDK_STREAMNLPTTSHELPER_H
 
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
 #include <iostream>
 #include <memory>
-#include <regex>
 #include <string>
 #include <utility>
 #include <vector>
 
 #if defined(__ANDROID__) || defined(USE_SELF_CONVERT)
 #include "ConvertUtil.h"
-#else
-#include <codecvt>
 #endif
 
 #include "json/json.h"
@@ -37,35 +38,126 @@ public:
 
     static const int STATUS_ALLONE = 3;
 
+    /**
+     * 合成标签前缀，完整标签为"stream_nlp_tts-<会话号>-<分段序号>"。
+     */
+    static const char TAG_PREFIX[16];
+
 private:
-    static const std::wstring REGEX_SENTENCE_DIVIDER;
+    /**
+     * UTF-8首字节分类表，分隔符为",.;，。；"。
+     * 0：普通字节；1：ASCII分隔符；2：可能是三字节全角分隔符的首字节，需要再比对后两个字节。
+     */
+    static const unsigned char SENTENCE_DIVIDER_LEAD[256];
+
+    /**
+     * UTF-8首字节对应的字符字节数，非法首字节（孤立的后续字节）按1字节处理。
+     */
+    static int utf8CharLen(unsigned char lead)
+    {
+        if (lead < 0x80)
+        {
+            return 1;
+        }
+        if ((lead & 0xE0) == 0xC0)
+        {
+            return 2;
+        }
+        if ((lead & 0xF0) == 0xE0)
+        {
+            return 3;
+        }
+        if ((lead & 0xF8) == 0xF0)
+        {
+            return 4;
+        }
+        return 1;
+    }
+
+    /**
+     * 统计UTF-8文本的字符数（按Unicode码点计，与原先转成wstring后的长度一致）。
+     */
+    static int utf8Length(const char *text, size_t len)
+    {
+        int count = 0;
+        for (size_t i = 0; i < len; i += utf8CharLen((unsigned char)text[i]))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * 从字节位置pos开始向后跳过count个字符，返回新的字节位置（不超过文本末尾）。
+     */
+    static size_t utf8Advance(const std::string &text, size_t pos, int count)
+    {
+        while (count-- > 0 && pos < text.size())
+        {
+            pos += utf8CharLen((unsigned char)text[pos]);
+        }
+        return pos < text.size() ? pos : text.size();
+    }
+
+    /**
+     * pos处的字符是否为句子分隔符。
+     */
+    static bool isSentenceDivider(const std::string &text, size_t pos)
+    {
+        unsigned char kind = SENTENCE_DIVIDER_LEAD[(unsigned char)text[pos]];
+        if (kind != 2)
+        {
+            return kind == 1;
+        }
+        if (pos + 2 >= text.size())
+        {
+            return false;
+        }
+
+        unsigned char b1 = (unsigned char)text[pos + 1];
+        unsigned char b2 = (unsigned char)text[pos + 2];
+        if ((unsigned char)text[pos] == 0xE3)
+        {
+            // 。U+3002
+            return b1 == 0x80 && b2 == 0x82;
+        }
+        // ，U+FF0C  ；U+FF1B
+        return b1 == 0xBC && (b2 == 0x8C || b2 == 0x9B);
+    }
 
     class InTextSeg
     {
     public:
-        // 都得用宽字符
-        std::wstring mText;
+        // UTF-8文本
+        std::string mText;
+
+        // 字符数，按Unicode码点计
+        int mTextLen;
 
         int mIndex;
 
         int mStatus;
 
     public:
+        // 重排窗口中尚未收到的空位
+        InTextSeg() : mTextLen(0), mIndex(-1), mStatus(STATUS_CONTINUE) {}
+
         InTextSeg(const std::string &text, int index, int status)
         {
-#if defined(__ANDROID__) || defined(USE_SELF_CONVERT)
-            mText = ConvertUtil::utf8ToWstring(text);
-#else
-            std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-            mText = converter.from_bytes(text);
-#endif
-            mIndex  = index;
-            mStatus = status;
+            mText    = text;
+            mTextLen = utf8Length(text.data(), text.size());
+            mIndex   = index;
+            mStatus  = status;
         }
 
         int getTextLen() const
         {
-            return mText.length();
+            return mTextLen;
+        }
+
+        bool isReceived() const
+        {
+            return mIndex >= 0;
         }
 
         bool isBegin() const
@@ -85,6 +177,22 @@ private:
     };
 
 public:
+    /**
+     * 流水线模式下已收到、还没轮到送给播放器的一帧合成结果，只保留改写全局进度要用的字段。
+     */
+    struct PendingFrame
+    {
+        int mDts;
+
+        int mTextStart;
+
+        int mTextEnd;
+
+        int mTextPercent;
+
+        std::string mAudio;
+    };
+
     class OutTextSeg
     {
     public:
@@ -98,17 +206,29 @@ public:
 
         int mOffset{};
 
+        // 以下用于测速：字数（按码点计）、送合成时间、首包音频时间(ms)、已收到的音频字节数
+        int mCharLen{};
+
+        long long mRequestMs{};
+
+        long long mFirstAudioMs{};
+
+        int mAudioBytes{};
+
+        // 合成结果是否已收全（收到了原始dts为结束的帧）
+        bool mSynthDone{};
+
+        // 前面的段还没播完时先缓存在这里，按段序送出
+        std::deque<PendingFrame> mPendingFrames;
+
     public:
         OutTextSeg() = default;
 
-        OutTextSeg(int index, const std::string &text, int status, int offset)
+        OutTextSeg(int session, int index, const std::string &text, int status, int offset)
         {
-            long long timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-#if defined(__ANDROID__) || defined(USE_SELF_CONVERT)
-            mTag = "stream_nlp_tts-" + ConvertUtil::toString(timeMs) + "-" + ConvertUtil::toString(index);
-#else
-            mTag  = "stream_nlp_tts-" + std::to_string(timeMs) + "-" + std::to_string(index);
-#endif
+            char tag[48];
+            snprintf(tag, sizeof(tag), "%s%d-%d", TAG_PREFIX, session, index);
+            mTag = tag;
 
             mIndex  = index;
             mText   = text;
@@ -164,30 +284,84 @@ public:
     };
 
 private:
-#if defined(__ANDROID__) || defined(USE_SELF_CONVERT)
+    // 乱序到达的文本段重排窗口，第0个位置对应序号mOrderedEndSegIndex + 1
+    std::deque<InTextSeg> mReorderWindow;
 
-#else
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> mStrConverter;
-#endif
+    // 已收到的最大序号，以及该段是否为结束段
+    int mMaxInSegIndex = -1;
 
-    std::vector<InTextSeg> mInTextSegList;
+    bool mMaxInSegIsEnd = false;
 
+    // 下标即分段序号
     std::vector<std::shared_ptr<OutTextSeg>> mOutTextSegList;
 
+    // 会话号，clear()时递增，使上一轮残留的合成结果对不上标签
+    int mSession = 0;
+
     int mTextMinLimit = 100;
 
+    // 首段的最少字数，<=0时首段也用mTextMinLimit
+    int mFirstTextMinLimit = 0;
+
+    // 自适应分段的上限，<=0时不限制
+    int mTextMaxLimit = 0;
+
+    bool mAdaptiveSegment = false;
+
+    // 上一段取文本时用的最少字数
+    int mLastTextLimit = 0;
+
+    // 合成音频格式，默认16k 16bit单声道
+    int mAudioBytesPerSec = 32000;
+
+    // 实测值（指数平均，跨回答保留）：合成速度(字/秒)、播放速度(字/秒)、送合成到首包音频的延迟(ms)
+    double mSynthCharsPerSec = 0;
+
+    double mPlaybackCharsPerSec = 0;
+
+    double mSynthLatencyMs = 0;
+
+    // 播放时间线估计：从mPlayStartMs开始连续写入了mQueuedAudioMs时长的音频
+    long long mPlayStartMs = 0;
+
+    long long mQueuedAudioMs = 0;
+
+    // 同时在合成的段数上限，1即合成完一段再送下一段
+    int mMaxInFlight = 1;
+
+    int mInFlightCount = 0;
+
+    // 下一帧要送给播放器的段序号，音频严格按段序送出
+    int mReleaseSegIndex = 0;
+
+    // 本次回答中播放器播空后才等到下一帧音频的次数、累计和最长断档时长(ms)
+    int mGapCount = 0;
+
+    long long mGapTotalMs = 0;
+
+    long long mGapMaxMs = 0;
+
     int mOrderedEndSegIndex = -1;
 
     int mTotalOrderedTextLen = 0;
 
     int mFetchedTextLen = 0;
 
-    // 这里要用宽字符
-    std::wstring mOrderedTextBuffer;
+    // 已取文本在mOrderedTextBuffer中的字节位置，对应mFetchedTextLen
+    size_t mFetchedTextByte = 0;
 
-    std::shared_ptr<Listener> m_pOutListener;
+    // 有序文本，UTF-8
+    std::string mOrderedTextBuffer;
+
+    // 增量查找分隔符的游标：从字符位置mScanStartLen开始查找时，
+    // [mScanStartLen, mScanLen)内已确认没有分隔符，mScanByte为mScanLen对应的字节位置
+    int mScanStartLen = -1;
 
-    std::shared_ptr<OutTextSeg> m_pCurOutTextSeg;
+    int mScanLen = 0;
+
+    size_t mScanByte = 0;
+
+    std::shared_ptr<Listener> m_pOutListener;
 
     enum FetchStatus
     {
@@ -215,21 +389,84 @@ public:
         mTextMinLimit = limit;
     }
 
-    bool isAddCompleted()
+    /**
+     * 首段的最少字数。首段越短首包音频越快，之后的分段再按速度放大。
+     */
+    void setFirstTextMinLimit(int limit)
     {
-        if (mInTextSegList.empty())
-        {
-            return false;
-        }
+        mFirstTextMinLimit = limit;
+    }
 
-        int size              = mInTextSegList.size();
-        const InTextSeg &last = mInTextSegList[size - 1];
-        if (last.isEnd() && size == last.mIndex + 1)
-        {
-            return true;
-        }
+    void setTextMaxLimit(int limit)
+    {
+        mTextMaxLimit = limit;
+    }
+
+    /**
+     * 是否按实测的合成速度和播放速度决定后续分段大小，关闭时后续分段都用mTextMinLimit。
+     */
+    void setAdaptiveSegment(bool adaptive)
+    {
+        mAdaptiveSegment = adaptive;
+    }
+
+    void setAudioBytesPerSec(int bytesPerSec)
+    {
+        mAudioBytesPerSec = bytesPerSec;
+    }
+
+    /**
+     * 同时在合成的段数上限。大于1时不等上一段合成完就送下一段，
+     * 先到的后段音频缓存起来，等前面的段播完再按序送给播放器。
+     */
+    void setMaxInFlight(int count)
+    {
+        mMaxInFlight = (std::max)(1, count);
+    }
+
+    int getGapCount() const
+    {
+        return mGapCount;
+    }
 
-        return false;
+    long long getGapTotalMs() const
+    {
+        return mGapTotalMs;
+    }
+
+    long long getGapMaxMs() const
+    {
+        return mGapMaxMs;
+    }
+
+    double getSynthCharsPerSec() const
+    {
+        return mSynthCharsPerSec;
+    }
+
+    double getPlaybackCharsPerSec() const
+    {
+        return mPlaybackCharsPerSec;
+    }
+
+    double getSynthLatencyMs() const
+    {
+        return mSynthLatencyMs;
+    }
+
+    /**
+     * 估计的播放器中还没播完的音频时长(ms)。
+     */
+    long long getQueuedAudioMs() const
+    {
+        long long left = mPlayStartMs + mQueuedAudioMs - nowMs();
+        return left > 0 ? left : 0;
+    }
+
+    bool isAddCompleted()
+    {
+        // 结束段是序号最大的一段，且之前的段都已按序拼接
+        return mMaxInSegIsEnd && mOrderedEndSegIndex == mMaxInSegIndex;
     }
 
     /**
@@ -246,52 +483,40 @@ public:
             return;
         }
 
-        InTextSeg seg(text, index, status);
-
-        int begin = mInTextSegList.size() - 1;
-        int pos   = begin;
-        while (pos >= 0)
+        if (index <= mOrderedEndSegIndex)
         {
-            InTextSeg cur = mInTextSegList[pos];
-            if (index < cur.mIndex)
-            {
-                pos--;
-            }
-            else
-            {
-                break;
-            }
+            // 已经拼接过的序号，重复结果丢弃
+            return;
         }
 
-        if (pos == begin)
+        size_t slot = index - (mOrderedEndSegIndex + 1);
+        if (slot >= mReorderWindow.size())
         {
-            // list为空，或者插入位置为尾部
-            mInTextSegList.push_back(seg);
+            mReorderWindow.resize(slot + 1);
         }
-        else
+        if (mReorderWindow[slot].isReceived())
         {
-            auto it = mInTextSegList.begin();
-            mInTextSegList.insert(it + pos + 1, seg);
+            return;
         }
+        mReorderWindow[slot] = InTextSeg(text, index, status);
 
-        for (int i = mOrderedEndSegIndex + 1; i < mInTextSegList.size(); i++)
+        if (index > mMaxInSegIndex)
         {
-            InTextSeg cur = mInTextSegList[i];
-            if (i == cur.mIndex)
-            {
-                mOrderedEndSegIndex = i;
-                mTotalOrderedTextLen += cur.getTextLen();
+            mMaxInSegIndex = index;
+            mMaxInSegIsEnd = mReorderWindow[slot].isEnd();
+        }
 
-                // 把有序文本段追加到buffer
-                mOrderedTextBuffer.append(cur.mText);
-            }
-            else
-            {
-                break;
-            }
+        // 窗口头部连续到齐的段追加到buffer
+        while (!mReorderWindow.empty() && mReorderWindow.front().isReceived())
+        {
+            const InTextSeg &cur = mReorderWindow.front();
+            mOrderedEndSegIndex  = cur.mIndex;
+            mTotalOrderedTextLen += cur.getTextLen();
+            mOrderedTextBuffer.append(cur.mText);
+            mReorderWindow.pop_front();
         }
 
-        if (mFetchStatus == FetchStatus::INIT || mFetchStatus == FetchStatus::INTERRUPTED)
+        if (mFetchStatus != FetchStatus::STARTED || mInFlightCount < mMaxInFlight)
         {
             processOrderedText();
         }
@@ -301,20 +526,21 @@ public:
     {
         bool needFetch  = true;
         int tryFetchLen = 0;
+        int textLimit   = currentTextLimit();
 
         if (isAddCompleted())
         {
             // 已经接收完成，取limit和剩余长度的最小值
 #if defined(WIN32) || defined(_WIN64)
-            tryFetchLen = (std::min)(mTextMinLimit, mTotalOrderedTextLen - mFetchedTextLen);
+            tryFetchLen = (std::min)(textLimit, mTotalOrderedTextLen - mFetchedTextLen);
 #else
-            tryFetchLen = std::min(mTextMinLimit, mTotalOrderedTextLen - mFetchedTextLen);
+            tryFetchLen = std::min(textLimit, mTotalOrderedTextLen - mFetchedTextLen);
 #endif
         }
         else
         {
             // 没接收完成
-            if (mTotalOrderedTextLen - mFetchedTextLen < mTextMinLimit)
+            if (mTotalOrderedTextLen - mFetchedTextLen < textLimit)
             {
                 // 剩余的长度不够，则这次不需要取
                 needFetch = false;
@@ -322,7 +548,7 @@ public:
             else
             {
                 // 剩余长度足够，尝试取limit长度
-                tryFetchLen = mTextMinLimit;
+                tryFetchLen = textLimit;
             }
         }
 
@@ -332,15 +558,37 @@ public:
         }
 
         // 取剩余部分（这里向前取一个长度），在里面查找第一个分隔符位置
-        std::wstring leftPart = mOrderedTextBuffer.substr(mFetchedTextLen + tryFetchLen - 1);
-        std::wregex p(REGEX_SENTENCE_DIVIDER);
-        std::wsmatch m;
+        int searchStart = mFetchedTextLen + tryFetchLen - 1;
+        if (searchStart < 0)
+        {
+            searchStart = 0;
+        }
+        int leftPartLen = mTotalOrderedTextLen - searchStart;
+
+        if (searchStart != mScanStartLen)
+        {
+            // 查找起点变了，游标从起点重新开始；起点没变说明上次没找到，接着上次的位置往后找
+            mScanStartLen = searchStart;
+            mScanLen      = searchStart;
+            mScanByte     = utf8Advance(mOrderedTextBuffer, mFetchedTextByte, searchStart - mFetchedTextLen);
+        }
+
+        bool find = false;
+        while (mScanByte < mOrderedTextBuffer.size())
+        {
+            if (isSentenceDivider(mOrderedTextBuffer, mScanByte))
+            {
+                find = true;
+                break;
+            }
+            mScanByte += utf8CharLen((unsigned char)mOrderedTextBuffer[mScanByte]);
+            mScanLen++;
+        }
 
-        bool find      = std::regex_search(leftPart, m, p);
         int dividerPos = 0;
         if (find)
         {
-            dividerPos = m.position();
+            dividerPos = mScanLen - searchStart;
         }
         else
         {
@@ -351,15 +599,16 @@ public:
             }
 
             // 已接收完成，取到结尾即可
-            dividerPos = leftPart.length() - 1;
+            dividerPos = leftPartLen - 1;
         }
 
         // 得到真实的获取长度和文本
         tryFetchLen += dividerPos;
-        std::wstring fetchedText = mOrderedTextBuffer.substr(mFetchedTextLen, tryFetchLen);
+        int fetchedLen = (std::max)(0, (std::min)(tryFetchLen, mTotalOrderedTextLen - mFetchedTextLen));
+        size_t fetchedEnd = utf8Advance(mOrderedTextBuffer, mFetchedTextByte, fetchedLen);
 
         int status;
-        if (isAddCompleted() && dividerPos == leftPart.length() - 1)
+        if (isAddCompleted() && dividerPos == leftPartLen - 1)
         {
             // 这一次把文本全取完了
             status = STATUS_END;
@@ -376,13 +625,14 @@ public:
             }
         }
 
-#if defined(__ANDROID__) || defined(USE_SELF_CONVERT)
-        std::shared_ptr<OutTextSeg> outTextSeg = std::make_shared<OutTextSeg>(mOutTextSegIndex++, ConvertUtil::wstringToUtf8(fetchedText), status, mFetchedTextLen);
-#else
-        std::shared_ptr<OutTextSeg> outTextSeg = std::make_shared<OutTextSeg>(mOutTextSegIndex++, mStrConverter.to_bytes(fetchedText), status, mFetchedTextLen);
-#endif
+        std::shared_ptr<OutTextSeg> outTextSeg = std::make_shared<OutTextSeg>(
+            mSession, mOutTextSegIndex++, mOrderedTextBuffer.substr(mFetchedTextByte, fetchedEnd - mFetchedTextByte), status, mFetchedTextLen);
+
+        outTextSeg->mCharLen = fetchedLen;
+        mLastTextLimit       = textLimit;
 
-        mFetchedTextLen += fetchedText.length();
+        mFetchedTextLen += fetchedLen;
+        mFetchedTextByte = fetchedEnd;
         mOutTextSegList.push_back(outTextSeg);
 
         return outTextSeg;
@@ -398,17 +648,271 @@ public:
      */
     void onOriginTtsData(const std::string &tag, Json::Value &bizParamJson, const char *audio, int len)
     {
-        if (m_pCurOutTextSeg == nullptr || m_pCurOutTextSeg->mTag != tag)
+        OutTextSeg *curOutTextSeg = lookupTextSeg(tag);
+        if (curOutTextSeg == nullptr)
         {
-            m_pCurOutTextSeg = findTextSegByTag(tag);
+            return;
         }
 
-        if (m_pCurOutTextSeg == nullptr)
+        long long now = nowMs();
+        if (len > 0)
         {
-            return;
+            updateSynthProgress(*curOutTextSeg, len, now);
+        }
+
+        Json::Value &content = bizParamJson["data"][0]["content"][0];
+
+        // 这里要用原始的dts来判断
+        int originDts  = content["dts"].asInt();
+        bool synthDone = (originDts == STATUS_END || originDts == STATUS_ALLONE) && !curOutTextSeg->mSynthDone;
+        if (synthDone)
+        {
+            updateRates(*curOutTextSeg, now);
+            curOutTextSeg->mSynthDone = true;
+            if (!curOutTextSeg->isEmpty())
+            {
+                mInFlightCount--;
+            }
+        }
+
+        int session = mSession;
+        if (curOutTextSeg->mIndex == mReleaseSegIndex && curOutTextSeg->mPendingFrames.empty())
+        {
+            // 轮到这一段播放，直接送出
+            releaseFrame(*curOutTextSeg, bizParamJson, audio, len, now);
+            releasePendingFrames(now);
+        }
+        else
+        {
+            // 前面的段还没播完，先缓存
+            PendingFrame frame;
+            frame.mDts         = originDts;
+            frame.mTextStart   = content["text_start"].asInt();
+            frame.mTextEnd     = content["text_end"].asInt();
+            frame.mTextPercent = content["text_percent"].asInt();
+            frame.mAudio.assign(audio, len);
+            curOutTextSeg->mPendingFrames.push_back(std::move(frame));
+        }
+
+        if (synthDone && session == mSession)
+        {
+            // 合成空出一个位置，处理下一个
+            processOrderedText();
+        }
+    }
+
+    /**
+     * 获取全量文本。
+     *
+     * @return 全量文本，当没有接收完全时返回空
+     */
+    std::string getFullText()
+    {
+        if (isAddCompleted())
+        {
+            return mOrderedTextBuffer;
         }
 
-        bool isLastSeg = m_pCurOutTextSeg->isEnd();
+        return "";
+    }
+
+    /**
+     * 清除待合成文本和状态，在合成出错或者取消合成时调用。
+     */
+    void clear()
+    {
+        mReorderWindow.clear();
+        mMaxInSegIndex = -1;
+        mMaxInSegIsEnd = false;
+        mOutTextSegList.clear();
+        mSession++;
+        mOrderedEndSegIndex = -1;
+        mOrderedTextBuffer.clear();
+        mTotalOrderedTextLen = 0;
+        mFetchedTextLen      = 0;
+        mFetchedTextByte     = 0;
+        mScanStartLen        = -1;
+        mScanLen             = 0;
+        mScanByte            = 0;
+        mFetchStatus         = FetchStatus::INIT;
+        mOutTextSegIndex     = 0;
+        mFoundFirstStatusBeg = false;
+        mTtsFrameIndex       = 1;
+        mLastTextLimit       = 0;
+        mPlayStartMs         = 0;
+        mQueuedAudioMs       = 0;
+        mInFlightCount       = 0;
+        mReleaseSegIndex     = 0;
+        mGapCount            = 0;
+        mGapTotalMs          = 0;
+        mGapMaxMs            = 0;
+    }
+
+    std::shared_ptr<OutTextSeg> findTextSegByTag(const std::string &tag)
+    {
+        OutTextSeg *seg = lookupTextSeg(tag);
+        return seg != nullptr ? mOutTextSegList[seg->mIndex] : nullptr;
+    }
+
+    void processOrderedText()
+    {
+        // 合成中的段数没到上限就继续取文本送合成，结束段取出后就不再取
+        while (mInFlightCount < mMaxInFlight && (mOutTextSegList.empty() || !mOutTextSegList.back()->isEnd()))
+        {
+            auto outTextSeg = fetchOrderedText();
+            if (outTextSeg == nullptr)
+            {
+                if (mFetchStatus == FetchStatus::STARTED)
+                {
+                    mFetchStatus = FetchStatus::INTERRUPTED;
+                }
+                return;
+            }
+
+            mFetchStatus = FetchStatus::STARTED;
+
+            if (outTextSeg->isEmpty())
+            {
+                if (outTextSeg->isEnd())
+                {
+                    // 最后一段合成文本为空，直接造一个假结果
+                    mockLastOutSegTtsResult(*outTextSeg);
+                }
+                return;
+            }
+
+            outTextSeg->mRequestMs = nowMs();
+            mInFlightCount++;
+            if (m_pOutListener != nullptr)
+            {
+                m_pOutListener->onText(*outTextSeg);
+            }
+        }
+    }
+
+private:
+    /**
+     * 解析"stream_nlp_tts-<会话号>-<分段序号>"形式的标签。
+     */
+    static bool parseTag(const std::string &tag, int &session, int &index)
+    {
+        const size_t prefixLen = sizeof(TAG_PREFIX) - 1;
+        if (tag.compare(0, prefixLen, TAG_PREFIX) != 0)
+        {
+            return false;
+        }
+
+        char *end = nullptr;
+        session   = (int)strtol(tag.c_str() + prefixLen, &end, 10);
+        if (*end != '-')
+        {
+            return false;
+        }
+        index = (int)strtol(end + 1, &end, 10);
+        return *end == '\0';
+    }
+
+    /**
+     * 按标签取本会话的分段，标签中带着分段序号，直接下标访问。
+     */
+    OutTextSeg *lookupTextSeg(const std::string &tag) const
+    {
+        int session = 0;
+        int index   = 0;
+        if (!parseTag(tag, session, index) || session != mSession || index < 0 || index >= (int)mOutTextSegList.size())
+        {
+            return nullptr;
+        }
+        return mOutTextSegList[index].get();
+    }
+
+    static long long nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static double average(double old, double sample)
+    {
+        return old <= 0 ? sample : old * 0.7 + sample * 0.3;
+    }
+
+    /**
+     * 本次取文本的最少字数。
+     * 首段用mFirstTextMinLimit尽快出声；之后若开启自适应，按实测速度估算要多大的一段，
+     * 才能让这一段合成完时播放器里仍留有两倍首包延迟的音频，使合成始终跑在播放前面。
+     */
+    int currentTextLimit() const
+    {
+        if (mOutTextSegList.empty() && mFirstTextMinLimit > 0)
+        {
+            return mFirstTextMinLimit;
+        }
+        if (!mAdaptiveSegment || mSynthCharsPerSec <= 0 || mPlaybackCharsPerSec <= 0)
+        {
+            return mTextMinLimit;
+        }
+
+        int maxLimit = mTextMaxLimit > 0 ? mTextMaxLimit : 0x7fffffff;
+        int limit    = maxLimit;
+
+        // 每合成一个字，播放器里的音频净增加的秒数
+        double gainPerChar = 1.0 / mPlaybackCharsPerSec - 1.0 / mSynthCharsPerSec;
+        if (gainPerChar > 0)
+        {
+            double neededSec = (2 * mSynthLatencyMs - getQueuedAudioMs()) / 1000.0;
+            limit            = (int)(neededSec / gainPerChar + 0.5);
+        }
+
+        // 逐步放大，每段最多翻倍
+        limit = (std::min)(limit, (std::max)(mTextMinLimit, mLastTextLimit * 2));
+        return (std::max)(mTextMinLimit, (std::min)(limit, maxLimit));
+    }
+
+    /**
+     * 记录一段收到的合成音频，用于测首包延迟和速度。
+     */
+    void updateSynthProgress(OutTextSeg &seg, int len, long long now)
+    {
+        if (seg.mFirstAudioMs == 0 && seg.mRequestMs > 0)
+        {
+            seg.mFirstAudioMs = now;
+            mSynthLatencyMs   = average(mSynthLatencyMs, (double)(now - seg.mRequestMs));
+        }
+        seg.mAudioBytes += len;
+    }
+
+    /**
+     * 记录写给播放器的音频，播放器播空之后重新起算时间线，并记一次断档。
+     */
+    void updateAudioTimeline(int len, long long now)
+    {
+        if (mPlayStartMs == 0 || now > mPlayStartMs + mQueuedAudioMs)
+        {
+            if (mPlayStartMs != 0)
+            {
+                long long gap = now - (mPlayStartMs + mQueuedAudioMs);
+                mGapCount++;
+                mGapTotalMs += gap;
+                mGapMaxMs = (std::max)(mGapMaxMs, gap);
+            }
+            mPlayStartMs   = now;
+            mQueuedAudioMs = 0;
+        }
+        mQueuedAudioMs += (long long)len * 1000 / mAudioBytesPerSec;
+    }
+
+    /**
+     * 把一帧合成结果的局部dts、文本位置和进度改成全局的，送给播放器。
+     * 最后一段播完时回调onFinish并clear()，调用方之后不能再访问seg。
+     */
+    void releaseFrame(OutTextSeg &seg, Json::Value &bizParamJson, const char *audio, int len, long long now)
+    {
+        if (len > 0)
+        {
+            updateAudioTimeline(len, now);
+        }
+
+        bool isLastSeg = seg.isEnd();
 
         Json::Value &data    = bizParamJson["data"][0];
         Json::Value &content = data["content"][0];
@@ -417,8 +921,8 @@ public:
         int originDts = dts;
 
         // 修正局部文本位置为全局位置
-        int text_start = content["text_start"].asInt() + m_pCurOutTextSeg->mOffset;
-        int text_end   = content["text_end"].asInt() + m_pCurOutTextSeg->mOffset;
+        int text_start = content["text_start"].asInt() + seg.mOffset;
+        int text_end   = content["text_end"].asInt() + seg.mOffset;
 
         // 修正局部dts为全局dts
         if (dts == STATUS_CONTINUE)
@@ -485,8 +989,8 @@ public:
             }
             else
             {
-                int localOffset  = text_percent * m_pCurOutTextSeg->getTextLen() / 100;
-                int globalOffset = m_pCurOutTextSeg->mOffset + localOffset;
+                int localOffset  = text_percent * seg.getTextLen() / 100;
+                int globalOffset = seg.mOffset + localOffset;
                 text_percent     = (int)(globalOffset * 100 / (float)mTotalOrderedTextLen);
             }
         }
@@ -502,7 +1006,6 @@ public:
             m_pOutListener->onTtsData(bizParamJson, audio, len);
         }
 
-        // 这里要用原始的dts来判断
         if (originDts == STATUS_END || originDts == STATUS_ALLONE)
         {
             if (isLastSeg)
@@ -510,130 +1013,74 @@ public:
                 // 全部处理完成
                 if (m_pOutListener != nullptr)
                 {
-#if defined(__ANDROID__) || defined(USE_SELF_CONVERT)
-                    m_pOutListener->onFinish(ConvertUtil::wstringToUtf8(mOrderedTextBuffer));
-#else
-                    m_pOutListener->onFinish(mStrConverter.to_bytes(mOrderedTextBuffer));
-#endif
+                    m_pOutListener->onFinish(mOrderedTextBuffer);
                 }
 
                 clear();
             }
             else
             {
-                // 处理下一个
-                processOrderedText();
+                // 这一段播完，轮到下一段
+                mReleaseSegIndex++;
             }
         }
     }
 
     /**
-     * 获取全量文本。
-     *
-     * @return 全量文本，当没有接收完全时返回空
+     * 从当前该播放的段开始，把已缓存的帧按序送出，遇到还没收到音频的段就停下。
      */
-    std::string getFullText()
+    void releasePendingFrames(long long now)
     {
-        if (isAddCompleted())
+        while (mReleaseSegIndex < (int)mOutTextSegList.size())
         {
-#if defined(__ANDROID__) || defined(USE_SELF_CONVERT)
-            return ConvertUtil::wstringToUtf8(mOrderedTextBuffer);
-#else
-            return mStrConverter.to_bytes(mOrderedTextBuffer);
-#endif
-        }
+            OutTextSeg &seg = *mOutTextSegList[mReleaseSegIndex];
+            if (seg.mPendingFrames.empty())
+            {
+                return;
+            }
 
-        return "";
+            PendingFrame frame = std::move(seg.mPendingFrames.front());
+            seg.mPendingFrames.pop_front();
+
+            Json::Value bizParamJson;
+            makeTtsBizParam(bizParamJson, frame.mDts, frame.mTextStart, frame.mTextEnd, frame.mTextPercent);
+            releaseFrame(seg, bizParamJson, frame.mAudio.data(), (int)frame.mAudio.size(), now);
+        }
     }
 
     /**
-     * 清除待合成文本和状态，在合成出错或者取消合成时调用。
+     * 一段合成完成后更新合成速度和播放速度。
      */
-    void clear()
-    {
-        mInTextSegList.clear();
-        mOutTextSegList.clear();
-        mOrderedEndSegIndex = -1;
-        mOrderedTextBuffer.clear();
-        mTotalOrderedTextLen = 0;
-        mFetchedTextLen      = 0;
-        mFetchStatus         = FetchStatus::INIT;
-        mOutTextSegIndex     = 0;
-        mFoundFirstStatusBeg = false;
-        mTtsFrameIndex       = 1;
-    }
-
-    std::shared_ptr<OutTextSeg> findTextSegByTag(const std::string &tag)
+    void updateRates(const OutTextSeg &seg, long long now)
     {
-        for (auto &seg : mOutTextSegList)
+        if (seg.mCharLen <= 0 || seg.mAudioBytes <= 0 || seg.mRequestMs <= 0 || now <= seg.mRequestMs)
         {
-            if (seg->mTag == tag)
-            {
-                return seg;
-            }
+            return;
         }
 
-        return nullptr;
-    }
-
-    void processOrderedText()
-    {
-        auto outTextSeg = fetchOrderedText();
-        if (outTextSeg != nullptr)
-        {
-            switch (mFetchStatus)
-            {
-                case INTERRUPTED:
-                case INIT:
-                {
-                    mFetchStatus = FetchStatus::STARTED;
-                }
-                break;
-            }
-
-            if (!outTextSeg->isEmpty())
-            {
-                if (m_pOutListener != nullptr)
-                {
-                    m_pOutListener->onText(*outTextSeg);
-                }
-            }
-            else
-            {
-                if (outTextSeg->isEnd())
-                {
-                    // 最后一段合成文本为空，直接造一个假结果
-                    mockLastOutSegTtsResult(*outTextSeg);
-                }
-            }
-        }
-        else
-        {
-            switch (mFetchStatus)
-            {
-                case STARTED:
-                {
-                    mFetchStatus = FetchStatus::INTERRUPTED;
-                }
-            }
-        }
+        double synthSec = (now - seg.mRequestMs) / 1000.0;
+        double audioSec = (double)seg.mAudioBytes / mAudioBytesPerSec;
+        mSynthCharsPerSec    = average(mSynthCharsPerSec, seg.mCharLen / synthSec);
+        mPlaybackCharsPerSec = average(mPlaybackCharsPerSec, seg.mCharLen / audioSec);
     }
 
-private:
-    void mockLastOutSegTtsResult(OutTextSeg &lastSeg)
+    /**
+     * 按AIUI合成结果的格式构造结果描述。
+     */
+    static void makeTtsBizParam(Json::Value &bizParamJson, int dts, int textStart, int textEnd, int textPercent)
     {
         Json::Value contentJson;
         contentJson["cancel"]       = "0";
         contentJson["cnt_id"]       = "0";
         contentJson["dte"]          = "speex-wb;7";
         contentJson["dtf"]          = "audio/L16;rate=16000";
-        contentJson["dts"]          = STATUS_ALLONE;
+        contentJson["dts"]          = dts;
         contentJson["error"]        = "";
         contentJson["frame_id"]     = 1;
-        contentJson["text_end"]     = lastSeg.mOffset + lastSeg.getTextLen();
-        contentJson["text_percent"] = 100;
+        contentJson["text_end"]     = textEnd;
+        contentJson["text_percent"] = textPercent;
         contentJson["text_seg"]     = "";
-        contentJson["text_start"]   = lastSeg.mOffset;
+        contentJson["text_start"]   = textStart;
         contentJson["url"]          = "0";
 
         Json::Value contentArray;
@@ -652,8 +1099,13 @@ private:
         Json::Value dataArray;
         dataArray.append(dataJson);
 
-        Json::Value bizParamJson;
         bizParamJson["data"] = dataArray;
+    }
+
+    void mockLastOutSegTtsResult(OutTextSeg &lastSeg)
+    {
+        Json::Value bizParamJson;
+        makeTtsBizParam(bizParamJson, STATUS_ALLONE, lastSeg.mOffset, lastSeg.mOffset + lastSeg.getTextLen(), 100);
 
         char audio[] = { 0 };
         onOriginTtsData(lastSeg.mTag, bizParamJson, audio, 0);
@@ -0,0 +1,402 @@
+#include "TtsCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "utils/Logger.hpp"
+
+const char TtsCache::TAG_PREFIX[11] = "tts_cache-";
+
+namespace
+{
+
+const uint32_t kRecordMagic = 0x31535454;    // "TTS1"
+
+// 记录格式：RecordHeader + 键 + PCM，整条按8字节对齐
+struct RecordHeader
+{
+    uint32_t magic;
+    uint32_t key_len;
+    uint32_t pcm_len;
+    uint32_t checksum;    // PCM的FNV-1a
+};
+
+const size_t kMaxKeyLen = 4096;
+
+// 录入中的合成超过这个时间还没收完，视为被打断
+const long long kRecordTimeoutMs = 60 * 1000;
+
+size_t recordSize(size_t key_len, size_t pcm_len)
+{
+    return (sizeof(RecordHeader) + key_len + pcm_len + 7) & ~(size_t)7;
+}
+
+}    // namespace
+
+TtsCache &TtsCache::getInstance()
+{
+    static TtsCache instance;
+    return instance;
+}
+
+bool TtsCache::open(const std::string &dir, int memory_entries, int disk_max_mb)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_        = true;
+    memory_entries_ = (size_t)std::max(1, memory_entries);
+    disk_max_       = (size_t)std::max(0, disk_max_mb) * 1024 * 1024;
+
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        LOG_WARN("TTS缓存目录%s创建失败: %s，只使用内存缓存", dir.c_str(), strerror(errno));
+        return false;
+    }
+
+    path_ = dir + "/tts_cache.bin";
+    fd_   = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+    {
+        LOG_WARN("TTS缓存文件%s打开失败: %s，只使用内存缓存", path_.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || !mapFile((size_t)st.st_size))
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    file_size_ = (size_t)st.st_size;
+    scanFile();
+
+    LOG_INFO("TTS缓存: %s, 磁盘 %zu 条 %zu 字节, 内存LRU %zu 条", path_.c_str(), disk_index_.size(), file_size_, memory_entries_);
+    return true;
+}
+
+void TtsCache::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_ != nullptr)
+    {
+        munmap(const_cast<char *>(base_), mapped_size_);
+        base_        = nullptr;
+        mapped_size_ = 0;
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    file_size_ = 0;
+    disk_full_ = false;
+    disk_index_.clear();
+    lru_.clear();
+    lru_index_.clear();
+    recordings_.clear();
+    enabled_ = false;
+}
+
+std::string TtsCache::makeKey(const std::string &voice, const std::string &params, const std::string &text)
+{
+    std::string key;
+    key.reserve(voice.size() + params.size() + text.size() + 2);
+    key.append(voice).append(1, '\n').append(params).append(1, '\n').append(text);
+    return key;
+}
+
+std::shared_ptr<const std::string> TtsCache::lookup(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = lru_index_.find(key);
+    if (it != lru_index_.end())
+    {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+
+    auto disk = disk_index_.find(key);
+    if (disk == disk_index_.end() || base_ == nullptr || disk->second.offset + disk->second.length > mapped_size_)
+    {
+        return nullptr;
+    }
+
+    const char *data = base_ + disk->second.offset;
+    if (checksum(data, disk->second.length) != disk->second.checksum)
+    {
+        LOG_WARN("TTS缓存记录校验失败，丢弃: %s", key.c_str() + key.rfind('\n') + 1);
+        disk_index_.erase(disk);
+        return nullptr;
+    }
+
+    std::shared_ptr<const std::string> pcm = std::make_shared<std::string>(data, disk->second.length);
+    putMemory(key, pcm);
+    return pcm;
+}
+
+bool TtsCache::contains(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_index_.count(key) != 0 || disk_index_.count(key) != 0;
+}
+
+std::string TtsCache::beginRecord(const std::string &key, bool audible, const std::string &tag)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    long long now = nowMs();
+    for (auto it = recordings_.begin(); it != recordings_.end();)
+    {
+        if (now - it->second.start_ms > kRecordTimeoutMs)
+        {
+            it = recordings_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    std::string record_tag = tag.empty() ? TAG_PREFIX + std::to_string(++record_seq_) : tag;
+    Recording &rec         = recordings_[record_tag];
+    rec.key                = key;
+    rec.start_ms           = now;
+    rec.audible            = audible;
+
+    if (audible)
+    {
+        stats_.misses++;
+    }
+    return record_tag;
+}
+
+bool TtsCache::onTtsData(const std::string &tag, const char *audio, int len, int dts)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = recordings_.find(tag);
+    if (it == recordings_.end())
+    {
+        return true;
+    }
+
+    Recording &rec = it->second;
+    bool audible   = rec.audible;
+    if (len > 0)
+    {
+        if (rec.first_audio_ms == 0)
+        {
+            // 预热的合成也算一次云端首包延迟的样本
+            rec.first_audio_ms = nowMs();
+            miss_latency_total_ += (double)(rec.first_audio_ms - rec.start_ms);
+            miss_latency_count_++;
+        }
+        rec.pcm.append(audio, len);
+    }
+
+    // 2：最后一块，3：只有一块
+    if (dts == 2 || dts == 3)
+    {
+        if (!rec.pcm.empty())
+        {
+            std::string key = rec.key;
+            std::shared_ptr<const std::string> pcm = std::make_shared<std::string>(std::move(rec.pcm));
+            putMemory(key, pcm);
+            if (fd_ >= 0 && disk_index_.count(key) == 0)
+            {
+                appendRecord(key, *pcm);
+            }
+            LOG_INFO("TTS缓存录入: %zu 字节, %s", pcm->size(), key.c_str() + key.rfind('\n') + 1);
+        }
+        recordings_.erase(it);
+    }
+    return audible;
+}
+
+bool TtsCache::hasSilentRecording()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    long long now = nowMs();
+    for (const auto &item : recordings_)
+    {
+        if (!item.second.audible && now - item.second.start_ms <= kRecordTimeoutMs)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TtsCache::reportHit(double latency_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.hits++;
+    hit_latency_total_ += latency_ms;
+    if (miss_latency_count_ > 0)
+    {
+        double saved = miss_latency_total_ / miss_latency_count_ - latency_ms;
+        stats_.savedMs += saved > 0 ? (long long)saved : 0;
+    }
+}
+
+TtsCache::Stats TtsCache::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats         = stats_;
+    stats.missLatencyMs = miss_latency_count_ > 0 ? miss_latency_total_ / miss_latency_count_ : 0;
+    stats.hitLatencyMs  = stats_.hits > 0 ? hit_latency_total_ / stats_.hits : 0;
+    return stats;
+}
+
+bool TtsCache::mapFile(size_t size)
+{
+    if (base_ != nullptr)
+    {
+        munmap(const_cast<char *>(base_), mapped_size_);
+        base_        = nullptr;
+        mapped_size_ = 0;
+    }
+    if (size == 0)
+    {
+        return true;
+    }
+
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED)
+    {
+        LOG_ERROR("TTS缓存文件映射失败: %s", strerror(errno));
+        return false;
+    }
+    base_        = static_cast<const char *>(addr);
+    mapped_size_ = size;
+    return true;
+}
+
+void TtsCache::scanFile()
+{
+    // 只读记录头和键，PCM所在的页等命中时才会被读入
+    size_t offset = 0;
+    while (offset + sizeof(RecordHeader) <= file_size_)
+    {
+        RecordHeader header;
+        memcpy(&header, base_ + offset, sizeof(header));
+        if (header.magic != kRecordMagic || header.key_len == 0 || header.key_len > kMaxKeyLen
+            || offset + recordSize(header.key_len, header.pcm_len) > file_size_)
+        {
+            break;
+        }
+
+        const char *key = base_ + offset + sizeof(RecordHeader);
+        DiskEntry entry;
+        entry.offset   = offset + sizeof(RecordHeader) + header.key_len;
+        entry.length   = header.pcm_len;
+        entry.checksum = header.checksum;
+        disk_index_[std::string(key, header.key_len)] = entry;
+
+        offset += recordSize(header.key_len, header.pcm_len);
+    }
+
+    if (offset < file_size_)
+    {
+        // 上次写到一半断电等情况，截掉尾部不完整的记录
+        LOG_WARN("TTS缓存文件尾部 %zu 字节无效，已截断", file_size_ - offset);
+        if (ftruncate(fd_, (off_t)offset) == 0)
+        {
+            file_size_ = offset;
+            mapFile(file_size_);
+        }
+    }
+}
+
+void TtsCache::appendRecord(const std::string &key, const std::string &pcm)
+{
+    if (disk_full_ || key.size() > kMaxKeyLen)
+    {
+        return;
+    }
+
+    size_t size = recordSize(key.size(), pcm.size());
+    if (file_size_ + size > disk_max_)
+    {
+        disk_full_ = true;
+        LOG_WARN("TTS缓存文件已达上限 %zu 字节，之后的条目只缓存在内存", disk_max_);
+        return;
+    }
+
+    RecordHeader header;
+    header.magic    = kRecordMagic;
+    header.key_len  = (uint32_t)key.size();
+    header.pcm_len  = (uint32_t)pcm.size();
+    header.checksum = checksum(pcm.data(), pcm.size());
+
+    static const char padding[8] = { 0 };
+    struct iovec iov[4];
+    iov[0].iov_base = &header;
+    iov[0].iov_len  = sizeof(header);
+    iov[1].iov_base = const_cast<char *>(key.data());
+    iov[1].iov_len  = key.size();
+    iov[2].iov_base = const_cast<char *>(pcm.data());
+    iov[2].iov_len  = pcm.size();
+    iov[3].iov_base = const_cast<char *>(padding);
+    iov[3].iov_len  = size - sizeof(header) - key.size() - pcm.size();
+
+    ssize_t written = pwritev(fd_, iov, 4, (off_t)file_size_);
+    if (written != (ssize_t)size)
+    {
+        LOG_ERROR("TTS缓存写入失败: %s", written < 0 ? strerror(errno) : "short write");
+        if (ftruncate(fd_, (off_t)file_size_) != 0)
+        {
+            LOG_ERROR("TTS缓存文件回滚失败: %s", strerror(errno));
+        }
+        return;
+    }
+
+    DiskEntry entry;
+    entry.offset     = file_size_ + sizeof(header) + key.size();
+    entry.length     = header.pcm_len;
+    entry.checksum   = header.checksum;
+    disk_index_[key] = entry;
+
+    file_size_ += size;
+    mapFile(file_size_);
+}
+
+void TtsCache::putMemory(const std::string &key, std::shared_ptr<const std::string> pcm)
+{
+    auto it = lru_index_.find(key);
+    if (it != lru_index_.end())
+    {
+        it->second->second = std::move(pcm);
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.emplace_front(key, std::move(pcm));
+    lru_index_[key] = lru_.begin();
+    while (lru_.size() > memory_entries_)
+    {
+        lru_index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+uint32_t TtsCache::checksum(const char *data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+long long TtsCache::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,151 @@
+/**
+ * @file TtsCache.h
+ * @brief 固定话术的合成音频缓存
+ * @details 以"发音人+合成参数+文本"为键缓存整句PCM。内存中按LRU保留最近用过的条目；
+ *          磁盘上是一个只追加的记录文件，启动时mmap进来只扫描记录头建索引，命中时才读对应的页。
+ *          未命中的句子照常走AIUI合成，合成请求带上beginRecord()给的标签，结果一边播放一边录入缓存。
+ */
+#ifndef ROBOT_TTS_CACHE_H
+#define ROBOT_TTS_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class TtsCache
+{
+public:
+    /**
+     * 录入缓存的合成请求的标签前缀，完整标签为"tts_cache-<序号>"。
+     */
+    static const char TAG_PREFIX[11];
+
+    struct Stats
+    {
+        int hits             = 0;
+        int misses           = 0;
+        double missLatencyMs = 0;    // 云端合成从请求到收到首包音频的平均延迟
+        double hitLatencyMs  = 0;    // 命中时从查缓存到音频写入播放器的平均耗时
+        long long savedMs    = 0;    // 命中累计节省的起播时间
+    };
+
+    static TtsCache &getInstance();
+
+    /**
+     * @brief 打开磁盘缓存
+     * @param dir 缓存目录，不存在时创建
+     * @param memory_entries 内存LRU的条目数
+     * @param disk_max_mb 磁盘记录文件的上限，超过后只缓存在内存
+     * @return 磁盘缓存打开成功返回true；失败时只用内存LRU
+     */
+    bool open(const std::string &dir, int memory_entries, int disk_max_mb);
+
+    void close();
+
+    /**
+     * @brief open()之后可用；磁盘文件打不开时仍可只用内存LRU
+     */
+    bool isEnabled() const { return enabled_; }
+
+    static std::string makeKey(const std::string &voice, const std::string &params, const std::string &text);
+
+    /**
+     * @brief 查缓存，磁盘命中的条目会读进内存LRU
+     * @return 整句PCM，未命中返回nullptr
+     */
+    std::shared_ptr<const std::string> lookup(const std::string &key);
+
+    /**
+     * @brief 内存或磁盘中是否已有该条目，不影响LRU顺序
+     */
+    bool contains(const std::string &key);
+
+    /**
+     * @brief 开始录入一句未命中的合成
+     * @param key 缓存键
+     * @param audible 合成结果是否要播放，预热时为false
+     * @param tag 调用方已有的合成标签，为空时生成"tts_cache-<序号>"
+     * @return 发合成请求要带的标签
+     */
+    std::string beginRecord(const std::string &key, bool audible, const std::string &tag = "");
+
+    /**
+     * @brief 带标签的合成结果，属于录入中的合成时收到最后一块写入缓存
+     * @return 这块音频是否需要播放；不是录入中的合成返回true
+     */
+    bool onTtsData(const std::string &tag, const char *audio, int len, int dts);
+
+    /**
+     * @brief 是否有正在录入的预热合成
+     */
+    bool hasSilentRecording();
+
+    /**
+     * @brief 记一次命中
+     * @param latency_ms 从查缓存到音频写入播放器的耗时
+     */
+    void reportHit(double latency_ms);
+
+    Stats getStats();
+
+private:
+    struct DiskEntry
+    {
+        uint64_t offset;    // PCM在文件中的位置
+        uint32_t length;
+        uint32_t checksum;
+    };
+
+    struct Recording
+    {
+        std::string key;
+        std::string pcm;
+        long long start_ms       = 0;
+        long long first_audio_ms = 0;
+        bool audible             = true;
+    };
+
+    typedef std::list<std::pair<std::string, std::shared_ptr<const std::string>>> LruList;
+
+    TtsCache() = default;
+    ~TtsCache() { close(); }
+
+    bool mapFile(size_t size);
+    void scanFile();
+    void appendRecord(const std::string &key, const std::string &pcm);
+    void putMemory(const std::string &key, std::shared_ptr<const std::string> pcm);
+
+    static uint32_t checksum(const char *data, size_t len);
+    static long long nowMs();
+
+    std::mutex mutex_;
+
+    bool enabled_        = false;
+    int fd_              = -1;
+    const char *base_    = nullptr;    // 记录文件的只读映射
+    size_t mapped_size_  = 0;
+    size_t file_size_    = 0;
+    size_t disk_max_     = 0;
+    bool disk_full_      = false;
+    std::string path_;
+    std::unordered_map<std::string, DiskEntry> disk_index_;
+
+    size_t memory_entries_ = 0;
+    LruList lru_;
+    std::unordered_map<std::string, LruList::iterator> lru_index_;
+
+    std::map<std::string, Recording> recordings_;    // 标签 -> 正在录入的合成
+    int record_seq_ = 0;
+
+    Stats stats_;
+    double miss_latency_total_ = 0;
+    int miss_latency_count_    = 0;
+    double hit_latency_total_  = 0;
+};
+
+#endif    // ROBOT_TTS_CACHE_H
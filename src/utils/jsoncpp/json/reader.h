@@ -237,6 +237,7 @@ private:
     std::string commentsBefore_;
     Features features_;
     bool collectComments_;
+    std::string decoded_; // scratch for string values, reused across parses
 };
 
 /** \brief Read from 'sin' into 'root'.
@@ -87,6 +87,84 @@ private:
   const char* str_;
 };
 
+/** \brief Per-thread bump allocator for Value trees.
+ *
+ * While a ValueArena::Scope is alive on a thread, the string buffers and the
+ * object/array maps (including their nodes) created by Value on that thread
+ * are carved from the thread's arena instead of the global heap. Releasing
+ * them only decrements a counter; the arena rewinds when a scope is entered
+ * or left with nothing outstanding, so the next scope reuses the same chunks.
+ *
+ * Every block remembers its owner, so a Value may safely outlive the scope or
+ * be destroyed on another thread; the arena is then simply not rewound until
+ * that value is gone. Once the arena reaches its size cap further requests
+ * fall back to the heap.
+ *
+ * \code
+ * {
+ *   Json::ValueArena::Scope arena;   // must be declared before the Values
+ *   Json::Value root;
+ *   reader.parse(begin, end, root, false);
+ *   ...
+ * }
+ * \endcode
+ */
+class JSON_API ValueArena {
+public:
+  struct Stats {
+    Stats() : arenaAllocations(0), heapAllocations(0), arenaBytes(0) {}
+    size_t arenaAllocations; ///< blocks served from the arena
+    size_t heapAllocations;  ///< calls that reached malloc (incl. new chunks)
+    size_t arenaBytes;       ///< bytes carved from the arena
+  };
+
+  /// Routes Value allocations of the calling thread to its arena.
+  class JSON_API Scope {
+  public:
+    Scope();
+    ~Scope();
+
+    /// Counters accumulated on this thread since the scope was entered.
+    Stats stats() const;
+
+  private:
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+
+    Stats start_;
+  };
+
+  /// Allocates \c size bytes, from the arena when a Scope is active.
+  static void* allocate(size_t size);
+  /// Releases a block returned by allocate(), from any thread.
+  static void release(void* ptr);
+  /// Counters of the calling thread since it started.
+  static Stats threadStats();
+};
+
+/** \brief STL allocator on top of ValueArena, used for the member maps.
+ */
+template <typename T> class ValueArenaAllocator {
+public:
+  typedef T value_type;
+
+  ValueArenaAllocator() {}
+  template <typename U>
+  ValueArenaAllocator(const ValueArenaAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(ValueArena::allocate(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t) { ValueArena::release(ptr); }
+
+  template <typename U> bool operator==(const ValueArenaAllocator<U>&) const {
+    return true;
+  }
+  template <typename U> bool operator!=(const ValueArenaAllocator<U>&) const {
+    return false;
+  }
+};
+
 /** \brief Represents a <a HREF="http://www.json.org">JSON</a> value.
  *
  * This class is a discriminated union wrapper that can represents a:
@@ -189,7 +267,11 @@ private:
 
 public:
 #ifndef JSON_USE_CPPTL_SMALLMAP
-  typedef std::map<CZString, Value> ObjectValues;
+  typedef std::map<CZString,
+                   Value,
+                   std::less<CZString>,
+                   ValueArenaAllocator<std::pair<const CZString, Value> > >
+  ObjectValues;
 #else
   typedef CppTL::SmallMap<CZString, Value> ObjectValues;
 #endif // ifndef JSON_USE_CPPTL_SMALLMAP
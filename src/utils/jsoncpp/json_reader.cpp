@@ -80,12 +80,12 @@ static bool containsNewLine(Reader::Location begin, Reader::Location end) {
 Reader::Reader()
     : errors_(), document_(), begin_(), end_(), current_(), lastValueEnd_(),
       lastValue_(), commentsBefore_(), features_(Features::all()),
-      collectComments_() {}
+      collectComments_(), decoded_() {}
 
 Reader::Reader(const Features& features)
     : errors_(), document_(), begin_(), end_(), current_(), lastValueEnd_(),
-      lastValue_(), commentsBefore_(), features_(features), collectComments_() {
-}
+      lastValue_(), commentsBefore_(), features_(features), collectComments_(),
+      decoded_() {}
 
 bool
 Reader::parse(const std::string& document, Value& root, bool collectComments) {
@@ -600,10 +600,10 @@ bool Reader::decodeDouble(Token& token, Value& decoded) {
 }
 
 bool Reader::decodeString(Token& token) {
-  std::string decoded;
-  if (!decodeString(token, decoded))
+  decoded_.clear();
+  if (!decodeString(token, decoded_))
     return false;
-  currentValue() = decoded;
+  currentValue() = decoded_;
   currentValue().setOffsetStart(token.start_ - begin_);
   currentValue().setOffsetLimit(token.end_ - begin_);
   return true;
@@ -22,6 +22,10 @@
 #include <cpptl/conststring.h>
 #endif
 #include <cstddef> // size_t
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <vector>
 
 #define JSON_ASSERT_UNREACHABLE assert(false)
 namespace aiui_va {
@@ -95,7 +99,7 @@ static inline char* duplicateStringValue(const char* value,
   if (length >= (unsigned)Value::maxInt)
     length = Value::maxInt - 1;
 
-  char* newString = static_cast<char*>(malloc(length + 1));
+  char* newString = static_cast<char*>(ValueArena::allocate(length + 1));
   JSON_ASSERT_MESSAGE(newString != 0,
                       "in Json::Value::duplicateStringValue(): "
                       "Failed to allocate string value buffer");
@@ -106,7 +110,192 @@ static inline char* duplicateStringValue(const char* value,
 
 /** Free the string duplicated by duplicateStringValue().
  */
-static inline void releaseStringValue(char* value) { free(value); }
+static inline void releaseStringValue(char* value) {
+  ValueArena::release(value);
+}
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class ValueArena
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+namespace {
+
+class ThreadArena;
+
+/// Prefix of every block handed out by ValueArena, keeps the payload aligned.
+union BlockHeader {
+  ThreadArena* owner; ///< 0 when the block came from malloc
+  std::max_align_t align_;
+};
+
+/** The arena of one thread. The owning thread holds one reference for its
+ * lifetime and every outstanding block holds another one, so the object is
+ * deleted by whoever drops the last reference. Only the owning thread bumps
+ * and rewinds; other threads merely release.
+ */
+class ThreadArena {
+public:
+  static const size_t chunkSize = 64 * 1024;
+  static const size_t maxChunks = 16;
+  static const size_t maxBlockSize = chunkSize / 4;
+
+  ThreadArena() : chunk_(0), used_(0), refs_(1), depth_(0) {}
+
+  ~ThreadArena() {
+    for (size_t i = 0; i < chunks_.size(); ++i)
+      free(chunks_[i]);
+  }
+
+  void* allocate(size_t size) {
+    size_t needed = (sizeof(BlockHeader) + size + sizeof(BlockHeader) - 1) &
+                    ~(sizeof(BlockHeader) - 1);
+    if (depth_ == 0 || needed > maxBlockSize || !reserve(needed))
+      return allocateFromHeap(size);
+
+    BlockHeader* header =
+        reinterpret_cast<BlockHeader*>(chunks_[chunk_] + used_);
+    used_ += needed;
+    header->owner = this;
+    refs_.fetch_add(1, std::memory_order_relaxed);
+    ++stats_.arenaAllocations;
+    stats_.arenaBytes += needed;
+    return header + 1;
+  }
+
+  void* allocateFromHeap(size_t size) {
+    BlockHeader* header =
+        static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + size));
+    if (header == 0)
+      return 0;
+    header->owner = 0;
+    ++stats_.heapAllocations;
+    return header + 1;
+  }
+
+  void unref() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  void enter() {
+    if (depth_++ == 0)
+      rewind();
+  }
+
+  void leave() {
+    if (--depth_ == 0)
+      rewind();
+  }
+
+  const ValueArena::Stats& stats() const { return stats_; }
+
+private:
+  /// Makes sure the current chunk has \c needed bytes left.
+  bool reserve(size_t needed) {
+    if (chunk_ < chunks_.size() && used_ + needed <= chunkSize)
+      return true;
+    size_t next = chunks_.empty() ? 0 : chunk_ + 1;
+    if (next == chunks_.size()) {
+      if (chunks_.size() == maxChunks)
+        return false;
+      char* chunk = static_cast<char*>(malloc(chunkSize));
+      if (chunk == 0)
+        return false;
+      chunks_.push_back(chunk);
+      ++stats_.heapAllocations;
+    }
+    chunk_ = next;
+    used_ = 0;
+    return true;
+  }
+
+  /// Starts over from the first chunk if no block is outstanding.
+  void rewind() {
+    if (refs_.load(std::memory_order_acquire) == 1) {
+      chunk_ = 0;
+      used_ = 0;
+    }
+  }
+
+  std::vector<char*> chunks_;
+  size_t chunk_;
+  size_t used_;
+  std::atomic<size_t> refs_;
+  int depth_;
+  ValueArena::Stats stats_;
+};
+
+/// Hands the thread's reference back when the thread exits.
+class ThreadArenaHolder {
+public:
+  ThreadArenaHolder() : arena_(new ThreadArena) {}
+  ~ThreadArenaHolder() { arena_->unref(); }
+  ThreadArena* get() const { return arena_; }
+
+private:
+  ThreadArena* arena_;
+};
+
+inline ThreadArena* threadArena() {
+  static thread_local ThreadArenaHolder holder;
+  return holder.get();
+}
+
+} // namespace
+
+void* ValueArena::allocate(size_t size) {
+  return threadArena()->allocate(size);
+}
+
+void ValueArena::release(void* ptr) {
+  if (ptr == 0)
+    return;
+  BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+  if (header->owner == 0)
+    free(header);
+  else
+    header->owner->unref();
+}
+
+ValueArena::Stats ValueArena::threadStats() {
+  return threadArena()->stats();
+}
+
+ValueArena::Scope::Scope() : start_(ValueArena::threadStats()) {
+  threadArena()->enter();
+}
+
+ValueArena::Scope::~Scope() { threadArena()->leave(); }
+
+ValueArena::Stats ValueArena::Scope::stats() const {
+  Stats now = ValueArena::threadStats();
+  now.arenaAllocations -= start_.arenaAllocations;
+  now.heapAllocations -= start_.heapAllocations;
+  now.arenaBytes -= start_.arenaBytes;
+  return now;
+}
+
+/// Value::ObjectValues live in the arena as well.
+static inline Value::ObjectValues* newObjectValues() {
+  return new (ValueArena::allocate(sizeof(Value::ObjectValues)))
+      Value::ObjectValues();
+}
+
+static inline Value::ObjectValues*
+newObjectValues(const Value::ObjectValues& other) {
+  return new (ValueArena::allocate(sizeof(Value::ObjectValues)))
+      Value::ObjectValues(other);
+}
+
+static inline void deleteObjectValues(Value::ObjectValues* values) {
+  typedef Value::ObjectValues ObjectValues;
+  values->~ObjectValues();
+  ValueArena::release(values);
+}
 
 } // namespace Json
 
@@ -245,7 +434,7 @@ Value::Value(ValueType type) {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
   case arrayValue:
   case objectValue:
-    value_.map_ = new ObjectValues();
+    value_.map_ = newObjectValues();
     break;
 #else
   case arrayValue:
@@ -350,7 +539,7 @@ Value::Value(const Value& other)
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
   case arrayValue:
   case objectValue:
-    value_.map_ = new ObjectValues(*other.value_.map_);
+    value_.map_ = newObjectValues(*other.value_.map_);
     break;
 #else
   case arrayValue:
@@ -388,7 +577,7 @@ Value::~Value() {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
   case arrayValue:
   case objectValue:
-    delete value_.map_;
+    deleteObjectValues(value_.map_);
     break;
 #else
   case arrayValue:
@@ -0,0 +1,178 @@
+/**
+ * @file stream_nlp_tts_helper_test.cpp
+ * @brief StreamNlpTtsHelper乱序重排窗口的单元测试
+ * @details 覆盖片段乱序到达、结尾空片段、回答中途被打断三种情况，
+ *          检查送去合成的分句文本、顺序、标签以及最终拼出的完整回答。
+ */
+#include "utils/StreamNlpTtsHelper.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+
+#define EXPECT_TRUE(cond)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond);                                      \
+            g_failures++;                                                                                              \
+        }                                                                                                              \
+    } while (0)
+
+#define EXPECT_EQ(expected, actual) EXPECT_TRUE((expected) == (actual))
+
+namespace {
+
+/**
+ * @brief 记录所有回调，测试按需回送合成帧
+ */
+class Recorder : public StreamNlpTtsHelper::Listener
+{
+public:
+    void onText(const StreamNlpTtsHelper::OutTextSeg &seg) override { segs.push_back(seg); }
+
+    void onTtsData(const Json::Value &bizParamJson, const char *, int) override
+    {
+        dts.push_back(bizParamJson["data"][0]["content"][0]["dts"].asInt());
+    }
+
+    void onFinish(const std::string &fullText) override
+    {
+        finished++;
+        full_text = fullText;
+    }
+
+    std::vector<std::string> texts() const
+    {
+        std::vector<std::string> result;
+        for (const auto &seg : segs)
+        {
+            result.push_back(seg.mText);
+        }
+        return result;
+    }
+
+    std::vector<StreamNlpTtsHelper::OutTextSeg> segs;
+    std::vector<int> dts;
+    std::string full_text;
+    int finished = 0;
+};
+
+/**
+ * @brief 模拟AIUI回来的一帧合成结果，dts=2表示该分句合成完毕
+ */
+void SendTtsFrame(StreamNlpTtsHelper &helper, const std::string &tag, int dts)
+{
+    Json::Value frame;
+    frame["data"][0]["content"][0]["dts"]          = dts;
+    frame["data"][0]["content"][0]["text_percent"] = 100;
+    helper.onOriginTtsData(tag, frame, "", 0);
+}
+
+void TestShuffledSegments()
+{
+    auto recorder = std::make_shared<Recorder>();
+    StreamNlpTtsHelper helper(recorder);
+    helper.setTextMinLimit(2);
+
+    // 到达顺序 2、3、1、0，前面缺片段时什么都不能送出
+    helper.addText("天气晴，", 2, StreamNlpTtsHelper::STATUS_CONTINUE);
+    helper.addText("适合散步。", 3, StreamNlpTtsHelper::STATUS_END);
+    helper.addText("北京", 1, StreamNlpTtsHelper::STATUS_CONTINUE);
+    EXPECT_TRUE(recorder->segs.empty());
+
+    helper.addText("今天", 0, StreamNlpTtsHelper::STATUS_BEGIN);
+    // 重复片段应被忽略
+    helper.addText("今天", 0, StreamNlpTtsHelper::STATUS_BEGIN);
+    EXPECT_EQ(1u, recorder->segs.size());
+
+    // 同时只有一句在合成，上一句合成完才取下一句
+    for (size_t i = 0; i < recorder->segs.size() && i < 8; i++)
+    {
+        SendTtsFrame(helper, recorder->segs[i].mTag, 2);
+    }
+
+    std::vector<std::string> expected = { "今天北京天气晴，", "适合散步。" };
+    EXPECT_TRUE(expected == recorder->texts());
+    for (size_t i = 0; i < recorder->segs.size(); i++)
+    {
+        EXPECT_EQ((int)i, recorder->segs[i].mIndex);
+    }
+    EXPECT_TRUE(!recorder->segs.empty() && recorder->segs.back().isEnd());
+    EXPECT_EQ(1, recorder->finished);
+    EXPECT_EQ(std::string("今天北京天气晴，适合散步。"), recorder->full_text);
+}
+
+void TestEmptyFinalSegment()
+{
+    auto recorder = std::make_shared<Recorder>();
+    StreamNlpTtsHelper helper(recorder);
+    helper.setTextMinLimit(3);
+
+    helper.addText("第一句话。", 0, StreamNlpTtsHelper::STATUS_BEGIN);
+    EXPECT_EQ(1u, recorder->segs.size());
+    // 最后一个片段没有文字，只带结束状态
+    helper.addText("", 1, StreamNlpTtsHelper::STATUS_END);
+    SendTtsFrame(helper, recorder->segs[0].mTag, 2);
+
+    std::vector<std::string> expected = { "第一句话。" };
+    EXPECT_TRUE(expected == recorder->texts());
+    // 空结尾不再送合成，由助手补一帧全部结束的合成结果
+    EXPECT_TRUE(!recorder->dts.empty() && recorder->dts.back() == StreamNlpTtsHelper::STATUS_ALLONE);
+    EXPECT_EQ(1, recorder->finished);
+    EXPECT_EQ(std::string("第一句话。"), recorder->full_text);
+}
+
+void TestInterruptedSequence()
+{
+    auto recorder = std::make_shared<Recorder>();
+    StreamNlpTtsHelper helper(recorder);
+    helper.setTextMinLimit(2);
+
+    helper.addText("旧的回答，", 0, StreamNlpTtsHelper::STATUS_BEGIN);
+    helper.addText("还没说完", 2, StreamNlpTtsHelper::STATUS_CONTINUE);
+    EXPECT_EQ(1u, recorder->segs.size());
+    std::string stale_tag = recorder->segs[0].mTag;
+
+    // 被新的一轮对话打断
+    helper.clear();
+    helper.addText("新的回答，", 0, StreamNlpTtsHelper::STATUS_BEGIN);
+    helper.addText("到此为止。", 1, StreamNlpTtsHelper::STATUS_END);
+    EXPECT_EQ(2u, recorder->segs.size());
+    EXPECT_TRUE(recorder->segs[1].mTag != stale_tag);
+
+    // 旧一轮的合成结果和不认识的标签都不能转发
+    size_t dts_before = recorder->dts.size();
+    SendTtsFrame(helper, stale_tag, 2);
+    SendTtsFrame(helper, "other_tag", 2);
+    EXPECT_EQ(dts_before, recorder->dts.size());
+
+    for (size_t i = 1; i < recorder->segs.size() && i < 8; i++)
+    {
+        SendTtsFrame(helper, recorder->segs[i].mTag, 2);
+    }
+    std::vector<std::string> expected = { "旧的回答，", "新的回答，", "到此为止。" };
+    EXPECT_TRUE(expected == recorder->texts());
+    EXPECT_EQ(1, recorder->finished);
+    EXPECT_EQ(std::string("新的回答，到此为止。"), recorder->full_text);
+}
+
+}    // namespace
+
+int main()
+{
+    TestShuffledSegments();
+    TestEmptyFinalSegment();
+    TestInterruptedSequence();
+    if (g_failures > 0)
+    {
+        fprintf(stderr, "%d expectation(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("all passed\n");
+    return 0;
+}
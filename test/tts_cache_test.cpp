@@ -0,0 +1,233 @@
+/**
+ * @file tts_cache_test.cpp
+ * @brief TtsCache磁盘记录文件和内存LRU的单元测试
+ * @details 覆盖录入后重新打开、内存LRU淘汰、尾部不完整记录截断、PCM校验失败丢弃、磁盘上限五种情况。
+ *          每个用例在/tmp下新建缓存目录，结束时删除。
+ */
+#include "utils/Logger.hpp"
+#include "utils/TtsCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int g_failures = 0;
+
+#define EXPECT_TRUE(cond)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond);                                      \
+            g_failures++;                                                                                              \
+        }                                                                                                              \
+    } while (0)
+
+#define EXPECT_EQ(expected, actual) EXPECT_TRUE((expected) == (actual))
+
+namespace {
+
+// 与TtsCache.cpp中的记录格式一致：16字节记录头 + 键 + PCM，按8字节对齐
+const size_t kHeaderSize = 16;
+
+size_t RecordSize(const std::string &key, const std::string &pcm)
+{
+    return (kHeaderSize + key.size() + pcm.size() + 7) & ~(size_t)7;
+}
+
+/**
+ * @brief 每个用例一个临时缓存目录
+ */
+class TempDir
+{
+public:
+    TempDir()
+    {
+        char pattern[] = "/tmp/tts_cache_test.XXXXXX";
+        path = mkdtemp(pattern) != nullptr ? pattern : "";
+    }
+
+    ~TempDir()
+    {
+        TtsCache::getInstance().close();
+        unlink(file().c_str());
+        rmdir(path.c_str());
+    }
+
+    std::string file() const { return path + "/tts_cache.bin"; }
+
+    off_t fileSize() const
+    {
+        struct stat st;
+        return stat(file().c_str(), &st) == 0 ? st.st_size : -1;
+    }
+
+    std::string path;
+};
+
+std::string MakePcm(size_t size, char seed)
+{
+    std::string pcm(size, '\0');
+    for (size_t i = 0; i < size; i++)
+    {
+        pcm[i] = (char)(seed + i * 7);
+    }
+    return pcm;
+}
+
+/**
+ * @brief 按云端合成的方式分首块、末块送入一句
+ */
+void Record(const std::string &key, const std::string &pcm)
+{
+    TtsCache &cache = TtsCache::getInstance();
+    std::string tag = cache.beginRecord(key, false);
+    size_t half     = pcm.size() / 2;
+    cache.onTtsData(tag, pcm.data(), (int)half, 0);
+    cache.onTtsData(tag, pcm.data() + half, (int)(pcm.size() - half), 2);
+}
+
+bool HasPcm(const std::string &key, const std::string &pcm)
+{
+    std::shared_ptr<const std::string> found = TtsCache::getInstance().lookup(key);
+    return found && *found == pcm;
+}
+
+void TestRecordAndReopen()
+{
+    TempDir dir;
+    TtsCache &cache       = TtsCache::getInstance();
+    const std::string key = TtsCache::makeKey("x5_lingxiaoyue_flow", "{\"vcn\":\"\"}", "你好");
+    const std::string pcm = MakePcm(20000, 1);
+
+    EXPECT_TRUE(cache.open(dir.path, 4, 8));
+    EXPECT_TRUE(!cache.contains(key));
+    Record(key, pcm);
+    EXPECT_TRUE(HasPcm(key, pcm));
+    cache.close();
+    EXPECT_EQ((off_t)RecordSize(key, pcm), dir.fileSize());
+
+    EXPECT_TRUE(cache.open(dir.path, 4, 8));
+    EXPECT_TRUE(cache.contains(key));
+    EXPECT_TRUE(HasPcm(key, pcm));
+    // 参数不同是不同的条目
+    EXPECT_TRUE(!cache.contains(TtsCache::makeKey("x5_lingxiaoyue_flow", "{\"vcn\":\"x4\"}", "你好")));
+}
+
+void TestMemoryLruEviction()
+{
+    TempDir dir;
+    TtsCache &cache = TtsCache::getInstance();
+    // 磁盘上限为0，条目只在内存LRU中
+    EXPECT_TRUE(cache.open(dir.path, 2, 0));
+    const std::string a = MakePcm(100, 1), b = MakePcm(100, 2), c = MakePcm(100, 3), d = MakePcm(100, 4);
+
+    Record("a", a);
+    Record("b", b);
+    Record("c", c);
+    EXPECT_TRUE(!cache.contains("a"));
+    EXPECT_TRUE(cache.contains("b"));
+    EXPECT_TRUE(cache.contains("c"));
+
+    // 查过的b变成最近使用，再录入d时淘汰c
+    EXPECT_TRUE(HasPcm("b", b));
+    Record("d", d);
+    EXPECT_TRUE(cache.contains("b"));
+    EXPECT_TRUE(!cache.contains("c"));
+    EXPECT_TRUE(HasPcm("d", d));
+    EXPECT_EQ((off_t)0, dir.fileSize());
+}
+
+void TestTornTailTruncated()
+{
+    TempDir dir;
+    TtsCache &cache = TtsCache::getInstance();
+    const std::string first = MakePcm(3000, 1), second = MakePcm(5000, 2);
+    EXPECT_TRUE(cache.open(dir.path, 4, 8));
+    Record("first", first);
+    Record("second", second);
+    cache.close();
+
+    // 模拟写第二条时断电
+    EXPECT_EQ(0, truncate(dir.file().c_str(), dir.fileSize() - 100));
+
+    EXPECT_TRUE(cache.open(dir.path, 4, 8));
+    EXPECT_TRUE(HasPcm("first", first));
+    EXPECT_TRUE(!cache.contains("second"));
+    EXPECT_EQ((off_t)RecordSize("first", first), dir.fileSize());
+
+    // 截断后追加的记录重新打开后仍可读
+    Record("second", second);
+    cache.close();
+    EXPECT_TRUE(cache.open(dir.path, 4, 8));
+    EXPECT_TRUE(HasPcm("first", first));
+    EXPECT_TRUE(HasPcm("second", second));
+}
+
+void TestChecksumRejected()
+{
+    TempDir dir;
+    TtsCache &cache = TtsCache::getInstance();
+    const std::string pcm = MakePcm(4000, 5), other = MakePcm(4000, 6);
+    EXPECT_TRUE(cache.open(dir.path, 4, 8));
+    Record("bad", pcm);
+    Record("good", other);
+    cache.close();
+
+    // 改掉第一条PCM中的一个字节
+    int fd = open(dir.file().c_str(), O_RDWR);
+    EXPECT_TRUE(fd >= 0);
+    char byte = 0;
+    off_t pos = (off_t)(kHeaderSize + 3 + 1000);
+    EXPECT_EQ(1, (int)pread(fd, &byte, 1, pos));
+    byte ^= 0x5a;
+    EXPECT_EQ(1, (int)pwrite(fd, &byte, 1, pos));
+    close(fd);
+
+    EXPECT_TRUE(cache.open(dir.path, 4, 8));
+    EXPECT_TRUE(cache.contains("bad"));
+    EXPECT_TRUE(cache.lookup("bad") == nullptr);
+    EXPECT_TRUE(!cache.contains("bad"));
+    EXPECT_TRUE(HasPcm("good", other));
+}
+
+void TestDiskCap()
+{
+    TempDir dir;
+    TtsCache &cache = TtsCache::getInstance();
+    const std::string first = MakePcm(700 * 1024, 1), second = MakePcm(700 * 1024, 2);
+    EXPECT_TRUE(cache.open(dir.path, 4, 1));
+    Record("first", first);
+    Record("second", second);
+    // 超过上限的条目只在内存中
+    EXPECT_TRUE(HasPcm("second", second));
+    EXPECT_EQ((off_t)RecordSize("first", first), dir.fileSize());
+    cache.close();
+
+    EXPECT_TRUE(cache.open(dir.path, 4, 1));
+    EXPECT_TRUE(HasPcm("first", first));
+    EXPECT_TRUE(!cache.contains("second"));
+}
+
+}    // namespace
+
+int main()
+{
+    Logger::Logger::GetInstance().SetLevel(Logger::LogLevel::LOG_ERROR);
+    TestRecordAndReopen();
+    TestMemoryLruEviction();
+    TestTornTailTruncated();
+    TestChecksumRejected();
+    TestDiskCap();
+    if (g_failures > 0)
+    {
+        fprintf(stderr, "%d expectation(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("all passed\n");
+    return 0;
+}